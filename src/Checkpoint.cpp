@@ -0,0 +1,36 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+#include "Checkpoint.h"
+
+#include "Organ.h"
+#include "Seed.h"
+#include "Root.h"
+#include "RootDelay.h"
+#include "Stem.h"
+#include "Leaf.h"
+
+namespace CPlantBox {
+
+const uint32_t Checkpoint::magic;
+const uint32_t Checkpoint::version;
+
+/**
+ * Creates an empty organ with an empty specific parameter of the right class, its state is then read by Organ::readCheckpoint
+ *
+ * @param organClass    class of the organ (@see Organ::checkpointClass)
+ * @return              the empty organ
+ */
+std::shared_ptr<Organ> Checkpoint::createOrgan(int organClass)
+{
+    switch (organClass) {
+    case oc_organ: return std::make_shared<Organ>(-1, std::make_shared<OrganSpecificParameter>(-1, 0.), true, true, 0., 0., Vector3d(), 0., 0);
+    case oc_seed: return std::make_shared<Seed>(-1, std::make_shared<SeedSpecificParameter>(), true, true, 0., 0.);
+    case oc_root: return std::make_shared<Root>(-1, std::make_shared<RootSpecificParameter>(), true, true, 0., 0., Vector3d(), 0., 0);
+    case oc_rootDelay: return std::make_shared<RootDelay>(-1, std::make_shared<RootSpecificParameter>(), true, true, 0., 0., Vector3d(), 0., 0);
+    case oc_stem: return std::make_shared<Stem>(-1, std::make_shared<StemSpecificParameter>(), true, true, 0., 0., Vector3d(), 0., 0);
+    case oc_leaf: return std::make_shared<Leaf>(-1, std::make_shared<LeafSpecificParameter>(), true, true, 0., 0., Vector3d(), 0., 0);
+    default:
+        throw std::invalid_argument("Checkpoint::createOrgan: unknown organ class " + std::to_string(organClass));
+    }
+}
+
+} // namespace CPlantBox
@@ -0,0 +1,143 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+#ifndef CHECKPOINT_H_
+#define CHECKPOINT_H_
+
+#include "mymath.h"
+#include "SharedVector.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <istream>
+#include <ostream>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+
+namespace CPlantBox {
+
+class Organ;
+
+/**
+ * Checkpoint
+ *
+ * Binary checkpoint of the complete state of an organism (@see Organism::saveCheckpoint, Organism::loadCheckpoint).
+ *
+ * Values are written in the native byte order and size, i.e. a checkpoint is read by the same build of CPlantBox
+ * on the same platform (e.g. to restart a preempted simulation). Vectors and strings are preceded by their size.
+ */
+class Checkpoint
+{
+public:
+
+    enum OrganClasses { oc_organ = 0, oc_seed = 1, oc_root = 2, oc_stem = 3, oc_leaf = 4, oc_rootDelay = 5 };
+    ///< organ classes (@see Organ::checkpointClass), the default class of an organ type has the organ type number
+
+    static const uint32_t magic = 0x58425043; ///< "CPBX"
+    static const uint32_t version = 1; ///< version of the file format
+
+    static std::shared_ptr<Organ> createOrgan(int organClass); ///< creates an empty organ of the class, to read its state
+
+    /* writing */
+    template<class T>
+    static void write(std::ostream& os, const T& v) {
+        static_assert(std::is_arithmetic<T>::value, "Checkpoint::write: unsupported type");
+        os.write(reinterpret_cast<const char*>(&v), sizeof(T));
+    } ///< writes a number
+    static void write(std::ostream& os, const std::string& s) {
+        write(os, uint64_t(s.size()));
+        os.write(s.data(), s.size());
+    } ///< writes a string
+    static void write(std::ostream& os, const Vector3d& v) { write(os, v.x); write(os, v.y); write(os, v.z); } ///< writes a vector
+    static void write(std::ostream& os, const Vector2i& v) { write(os, v.x); write(os, v.y); } ///< writes a pair of ints
+    template<class T>
+    static void write(std::ostream& os, const std::vector<T>& v) {
+        write(os, uint64_t(v.size()));
+        writeData(os, v, std::is_arithmetic<T>());
+    } ///< writes a vector of numbers, strings, or vectors
+    static void write(std::ostream& os, const std::vector<bool>& v) {
+        write(os, uint64_t(v.size()));
+        for (bool b : v) {
+            write(os, b);
+        }
+    } ///< writes a vector of bools
+    template<class T>
+    static void write(std::ostream& os, const SharedVector<T>& v) { write(os, v.get()); } ///< writes a shared vector
+
+    /* reading, throws std::invalid_argument if the stream ends */
+    template<class T>
+    static void read(std::istream& is, T& v) {
+        static_assert(std::is_arithmetic<T>::value, "Checkpoint::read: unsupported type");
+        is.read(reinterpret_cast<char*>(&v), sizeof(T));
+        check(is);
+    } ///< reads a number
+    static void read(std::istream& is, std::string& s) {
+        s.resize(readSize(is));
+        is.read(&s[0], s.size());
+        check(is);
+    } ///< reads a string
+    static void read(std::istream& is, Vector3d& v) { read(is, v.x); read(is, v.y); read(is, v.z); } ///< reads a vector
+    static void read(std::istream& is, Vector2i& v) { read(is, v.x); read(is, v.y); } ///< reads a pair of ints
+    template<class T>
+    static void read(std::istream& is, std::vector<T>& v) {
+        v.resize(readSize(is));
+        readData(is, v, std::is_arithmetic<T>());
+    } ///< reads a vector of numbers, strings, or vectors
+    static void read(std::istream& is, std::vector<bool>& v) {
+        v.resize(readSize(is));
+        for (size_t i=0; i<v.size(); i++) {
+            bool b;
+            read(is, b);
+            v[i] = b;
+        }
+    } ///< reads a vector of bools
+    template<class T>
+    static void read(std::istream& is, SharedVector<T>& v) {
+        std::vector<T> w;
+        read(is, w);
+        v = SharedVector<T>(std::move(w));
+    } ///< reads a shared vector
+
+protected:
+
+    template<class T>
+    static void writeData(std::ostream& os, const std::vector<T>& v, std::true_type) {
+        os.write(reinterpret_cast<const char*>(v.data()), v.size()*sizeof(T));
+    } ///< numbers at once
+    template<class T>
+    static void writeData(std::ostream& os, const std::vector<T>& v, std::false_type) {
+        for (const auto& x : v) {
+            write(os, x);
+        }
+    } ///< other types one by one
+    template<class T>
+    static void readData(std::istream& is, std::vector<T>& v, std::true_type) {
+        is.read(reinterpret_cast<char*>(v.data()), v.size()*sizeof(T));
+        check(is);
+    } ///< numbers at once
+    template<class T>
+    static void readData(std::istream& is, std::vector<T>& v, std::false_type) {
+        for (auto& x : v) {
+            read(is, x);
+        }
+    } ///< other types one by one
+
+    static size_t readSize(std::istream& is) {
+        uint64_t n;
+        read(is, n);
+        if (n>(uint64_t(1)<<40)) {
+            throw std::invalid_argument("Checkpoint::read: corrupted checkpoint");
+        }
+        return n;
+    } ///< size of a vector or string
+    static void check(std::istream& is) {
+        if (!is) {
+            throw std::invalid_argument("Checkpoint::read: unexpected end of checkpoint");
+        }
+    } ///< throws if the stream has ended
+
+};
+
+} // namespace CPlantBox
+
+#endif
@@ -0,0 +1,260 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+#include "Ensemble.h"
+
+#include "Organ.h"
+#include "seedparameter.h"
+
+#include <stdexcept>
+#include <sstream>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <exception>
+
+namespace CPlantBox {
+
+/**
+ * Creates the plants as copies of the prototype (Organism::copy),
+ * the prototype is not changed.
+ *
+ * @param prototype     organism with all parameters set (e.g. by Organism::readParameters), not yet initialized
+ * @param n             number of plants
+ * @param seed          plant i is seeded with seed+i
+ */
+Ensemble::Ensemble(std::shared_ptr<Organism> prototype, int n, unsigned int seed)
+{
+    if (n<0) {
+        throw std::invalid_argument("Ensemble::Ensemble: number of plants must be >= 0");
+    }
+    plants.resize(n);
+    for (int i=0; i<n; i++) {
+        plants[i] = prototype->copy();
+        plants[i]->setSeed(seed+i);
+    }
+}
+
+/**
+ * Sets the seed position of each plant, by changing the plant's seed parameter (call before initialize)
+ *
+ * @param pos       one position [cm] per plant
+ */
+void Ensemble::setSeedPositions(const std::vector<Vector3d>& pos)
+{
+    if (pos.size()!=plants.size()) {
+        throw std::invalid_argument("Ensemble::setSeedPositions: expected one position per plant, got "+std::to_string(pos.size())
+            +" positions for "+std::to_string(plants.size())+" plants");
+    }
+    for (size_t i=0; i<plants.size(); i++) {
+        auto sp = std::dynamic_pointer_cast<SeedRandomParameter>(plants[i]->getOrganRandomParameter(Organism::ot_seed, 0));
+        if (!sp) {
+            throw std::invalid_argument("Ensemble::setSeedPositions: plant "+std::to_string(i)+" has no seed parameter");
+        }
+        sp->seedPos = pos[i];
+    }
+}
+
+/**
+ * Initializes all plants (Organism::initialize)
+ *
+ * @param verbose   chatty with the std::couts
+ */
+void Ensemble::initialize(bool verbose)
+{
+    forEach([&](int i) { plants[i]->initialize(verbose); });
+}
+
+/**
+ * Simulates all plants for a time span (Organism::simulate)
+ *
+ * @param dt        time step [day]
+ * @param verbose   turns console output on or off
+ */
+void Ensemble::simulate(double dt, bool verbose)
+{
+    forEach([&](int i) { plants[i]->simulate(dt, verbose); });
+}
+
+/**
+ * @return the simulation time of the first plant (all plants are simulated equally long)
+ */
+double Ensemble::getSimTime() const
+{
+    if (plants.empty()) {
+        return 0.;
+    }
+    return plants.front()->getSimTime();
+}
+
+/**
+ * Calls @param f for every plant index, the threads take the next plant from a shared counter.
+ *
+ * Plants with stems are processed sequentially, since Stem::phytomerId is shared.
+ * Python derived callbacks (e.g. tropisms) need Ensemble::setNumberOfThreads(1), since the calling thread holds the GIL.
+ * The first exception is rethrown, after all threads are finished.
+ */
+void Ensemble::forEach(const std::function<void(int)>& f)
+{
+    const int n = plants.size();
+    int nt = numberOfThreads>0 ? numberOfThreads : std::max(int(std::thread::hardware_concurrency()), 1);
+    if ((n>0) && (plants.front()->getOrganRandomParameter(Organism::ot_stem).size()>0)) {
+        nt = 1;
+    }
+    std::atomic<int> next(0);
+    std::exception_ptr error = nullptr;
+    std::mutex errorMutex;
+    auto worker = [&]() {
+        int i;
+        while ((i = next++) < n) {
+            try {
+                f(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int t=1; t<std::min(nt, n); t++) {
+        threads.push_back(std::thread(worker));
+    }
+    worker();
+    for (auto& t : threads) {
+        t.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+/**
+ * @return the nodes of all plants, plant by plant
+ */
+std::vector<Vector3d> Ensemble::getNodes() const
+{
+    std::vector<Vector3d> nodes;
+    for (const auto& p : plants) {
+        auto n = p->getNodes();
+        nodes.insert(nodes.end(), n.begin(), n.end());
+    }
+    return nodes;
+}
+
+/**
+ * @return the node creation times of all plants, corresponding to Ensemble::getNodes
+ */
+std::vector<double> Ensemble::getNodeCTs() const
+{
+    std::vector<double> cts;
+    for (const auto& p : plants) {
+        auto ct = p->getNodeCTs();
+        cts.insert(cts.end(), ct.begin(), ct.end());
+    }
+    return cts;
+}
+
+/**
+ * @return the plant id of each node, corresponding to Ensemble::getNodes
+ */
+std::vector<int> Ensemble::getNodePlantIds() const
+{
+    std::vector<int> ids;
+    for (size_t i=0; i<plants.size(); i++) {
+        ids.insert(ids.end(), plants[i]->getNumberOfNodes(), i);
+    }
+    return ids;
+}
+
+/**
+ * The segments of all plants, the node indices are shifted to refer to Ensemble::getNodes
+ *
+ * @param ot        the expected organ type, where -1 denotes all organ types (default)
+ * @return          line segments
+ */
+std::vector<Vector2i> Ensemble::getSegments(int ot) const
+{
+    std::vector<Vector2i> segs;
+    int offset = 0;
+    for (const auto& p : plants) {
+        auto s = p->getSegments(ot);
+        for (auto& si : s) {
+            si.x += offset;
+            si.y += offset;
+        }
+        segs.insert(segs.end(), s.begin(), s.end());
+        offset += p->getNumberOfNodes();
+    }
+    return segs;
+}
+
+/**
+ * @param ot        the expected organ type, where -1 denotes all organ types (default)
+ * @return          the segment creation times of all plants, corresponding to Ensemble::getSegments
+ */
+std::vector<double> Ensemble::getSegmentCTs(int ot) const
+{
+    std::vector<double> cts;
+    for (const auto& p : plants) {
+        auto ct = p->getSegmentCTs(ot);
+        cts.insert(cts.end(), ct.begin(), ct.end());
+    }
+    return cts;
+}
+
+/**
+ * @param ot        the expected organ type, where -1 denotes all organ types (default)
+ * @return          the plant id of each segment, corresponding to Ensemble::getSegments
+ */
+std::vector<int> Ensemble::getSegmentPlantIds(int ot) const
+{
+    std::vector<int> ids;
+    for (size_t i=0; i<plants.size(); i++) {
+        ids.insert(ids.end(), plants[i]->getSegments(ot).size(), i);
+    }
+    return ids;
+}
+
+/**
+ * @param name      name of the parameter (@see Organism::getSummed)
+ * @param ot        the expected organ type, where -1 denotes all organ types (default)
+ * @return          the summed parameter of each plant
+ */
+std::vector<double> Ensemble::getSummed(std::string name, int ot) const
+{
+    std::vector<double> v(plants.size());
+    for (size_t i=0; i<plants.size(); i++) {
+        v[i] = plants[i]->getSummed(name, ot);
+    }
+    return v;
+}
+
+/**
+ * @return a segment analyser containing the segments of all plants, with the additional data "plantId"
+ */
+SegmentAnalyser Ensemble::getSegmentAnalyser() const
+{
+    SegmentAnalyser a;
+    for (size_t i=0; i<plants.size(); i++) {
+        SegmentAnalyser ai(*plants[i]);
+        ai.addData("plantId", std::vector<double>(ai.segments.size(), double(i)));
+        if (i==0) {
+            a = ai;
+        } else {
+            a.addSegments(ai);
+        }
+    }
+    return a;
+}
+
+/**
+ * @return quick info about the ensemble for debugging
+ */
+std::string Ensemble::toString() const
+{
+    std::stringstream str;
+    str << "Ensemble with " << plants.size() << " plants, after " << getSimTime() << " days";
+    return str.str();
+}
+
+} // namespace CPlantBox
@@ -0,0 +1,63 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+#ifndef ENSEMBLE_H_
+#define ENSEMBLE_H_
+
+#include "Organism.h"
+#include "SegmentAnalyser.h"
+
+#include <functional>
+
+namespace CPlantBox {
+
+/**
+ * Ensemble
+ *
+ * Manages many organisms of the same parameterisation (e.g. a field plot, or the plants of one objective evaluation),
+ * which are copied from a prototype, so parameter files are only parsed once.
+ *
+ * Initialization and simulation of the plants runs in parallel (each plant on one thread),
+ * the results are stacked, with a plant id per node and segment.
+ */
+class Ensemble
+{
+public:
+
+    Ensemble(std::shared_ptr<Organism> prototype, int n, unsigned int seed = 0); ///< n copies of the prototype, plant i is seeded with seed+i
+    virtual ~Ensemble() { }
+
+    /* plants */
+    int getNumberOfPlants() const { return plants.size(); } ///< number of plants
+    std::shared_ptr<Organism> getPlant(int i) const { return plants.at(i); } ///< the i-th plant (e.g. for individual modifications before initialize)
+    void setSeedPositions(const std::vector<Vector3d>& pos); ///< sets the seed position of each plant (call before initialize)
+    void setNumberOfThreads(int n) { numberOfThreads = n; } ///< number of threads, 0 uses all hardware threads (default)
+    int getNumberOfThreads() const { return numberOfThreads; } ///< number of threads, 0 uses all hardware threads (default)
+
+    /* simulation */
+    void initialize(bool verbose = false); ///< initializes all plants
+    void simulate(double dt, bool verbose = false); ///< simulates all plants for a time span dt
+    double getSimTime() const; ///< current simulation time
+
+    /* stacked results */
+    std::vector<Vector3d> getNodes() const; ///< nodes of all plants
+    std::vector<double> getNodeCTs() const; ///< node creation times of all plants
+    std::vector<int> getNodePlantIds() const; ///< plant id per node, corresponding to Ensemble::getNodes
+    std::vector<Vector2i> getSegments(int ot = -1) const; ///< segments of all plants, indices refer to Ensemble::getNodes
+    std::vector<double> getSegmentCTs(int ot = -1) const; ///< segment creation times of all plants
+    std::vector<int> getSegmentPlantIds(int ot = -1) const; ///< plant id per segment, corresponding to Ensemble::getSegments
+    std::vector<double> getSummed(std::string name, int ot = -1) const; ///< summed parameter per plant (@see Organism::getSummed)
+    SegmentAnalyser getSegmentAnalyser() const; ///< all segments in one analyser, with the additional data "plantId"
+
+    std::string toString() const; ///< quick info for debugging
+
+protected:
+
+    void forEach(const std::function<void(int)>& f); ///< calls f(i) for every plant i in parallel
+
+    std::vector<std::shared_ptr<Organism>> plants;
+    int numberOfThreads = 0;
+
+};
+
+} // namespace CPlantBox
+
+#endif
@@ -7,6 +7,11 @@
 #include "RootSystem.h"
 
 #include <functional>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <exception>
 
 
 namespace CPlantBox {
@@ -18,6 +23,7 @@ class ExudationModel {
 public:
 
     enum IntegrationType { mps_straight = 0, mps = 1, mls = 2 };
+    enum Integration13Type { direct13 = 0, separable13 = 1 }; // numerical evaluation of Eqn 13
 
     /*
      * Model parameters (same for all roots)
@@ -37,7 +43,11 @@ public:
     int n0 = 5; // integration points per [cm]
     double thresh13 = 1.e-15; // threshold for Eqn 13
     bool calc13 = true; // turns Eqn 13 on and off
+    int type13 = separable13; // direct13 integrates per grid point, separable13 convolves the Gaussian kernel dimension by dimension
     double observationRadius = 5; //  limits computational domain around roots [cm]
+    int numberOfThreads = int(std::thread::hardware_concurrency()); // threads of calculate(), 0 for the sequential evaluation (as Organism), all hardware threads by default
+    int tileSize = 8; // tiles of tileSize^3 grid points are processed in parallel
+    bool incremental = false; // keeps the contribution of Eqn 11 per root between calls of calculate(), for time series
 
     /**
      * Constructors
@@ -48,10 +58,10 @@ public:
     ExudationModel(double length, double width, double depth, int nx, int ny, int nz, std::shared_ptr<RootSystem> rs) :grid(EquidistantGrid3D(length, width, depth, nx, ny, nz)) {
 
         dx3 = (length/nx)*(width/ny)*(depth/nz); // for integration of eqn 13
-        roots = rs->getRoots();
 
-        for (const auto& r : roots) {
+        for (const auto& r : rs->getRoots()) {
             if (r->getNumberOfNodes()>1) { // started growing
+                roots.push_back(r);
                 // time when the root stopped growing
                 double sTime = r->getNodeCT(r->getNumberOfNodes()-1);
                 if (r->isActive()) {
@@ -66,138 +76,396 @@ public:
                 Vector3d base = r->getNode(0);
                 double a = r->getNodeCT(r->getNumberOfNodes()-1) - r->getNodeCT(0);
                 v.push_back(base.minus(t).times(1./a));
+                sdfs.push_back(SDF_RootSystem(*r, observationRadius));
             }
-
-            sdfs.push_back(SDF_RootSystem(*r, observationRadius));
-
         }
 
     }
 
     /**
-     * For each root for each grid point
+     * Point sources of one root, i.e. the quadrature points of Eqn (11), and the grid points affected by the root.
+     *
+     * The quadrature points do not depend on the grid point, so they are computed once per root,
+     * and Eqn (11) becomes a sum over the point sources for each grid point (@see ExudationModel::eqn11).
+     */
+    struct Sources {
+        std::vector<double> x, y, z; // positions of the point sources [cm]
+        std::vector<double> a; // quadrature weight times prefactor
+        std::vector<double> c; // factor of the squared distance in the exponent
+        std::vector<double> e; // decay term in the exponent
+        size_t i0 = 0, i1 = 0, j0 = 0, j1 = 0, k0 = 0, k1 = 0; // grid index box [i0,i1)x[j0,j1)x[k0,k1) of the observation domain
+        double st = 0; // stop time for Eqn (13), 0 if Eqn (13) is not applied
+        std::vector<double> g; // contribution of Eqn (11) within the index box (for Eqn 13, and the cache of the incremental mode)
+        std::vector<double> h; // Eqn (13) within the index box (for type13 = separable13)
+
+        size_t boxSize() const { return (i1-i0)*(j1-j0)*(k1-k0); } ///< number of grid points in the index box
+        void clearPoints() { release(x); release(y); release(z); release(a); release(c); release(e); } ///< frees the point sources
+        static void release(std::vector<double>& v) { std::vector<double>().swap(v); } ///< frees the memory of v
+    };
+
+    /**
+     * Calculates the concentration at all grid points at time tend.
+     *
+     * The point sources are computed per root (ExudationModel::sources). The grid is partitioned into tiles of tileSize^3 grid points,
+     * which are processed in parallel (numberOfThreads). Each tile only considers the roots whose observation domain
+     * (bounding box of the root enlarged by the observationRadius) intersects the tile, and accumulates their contributions
+     * into its own grid points. Eqn (13) is evaluated in a second parallel pass over the tiles, either directly per grid point (direct13),
+     * or from the convolutions of the roots, which are computed in parallel beforehand (separable13, @see ExudationModel::convolve13).
+     *
+     * In incremental mode, the contributions of Eqn (11) are kept per root. A later call only recomputes the roots whose age changed,
+     * i.e. roots that grew in between (by their node creation times), and Eqn (13) of the roots that stopped growing.
+     * The cache is dropped, if a model parameter was changed.
+     *
+     * Per root buffers only live as long as they are needed: the point sources are freed after Eqn (11), the contribution g
+     * is only allocated for Eqn (13) and for roots that are complete at tend (in incremental mode), and Eqn (13) is evaluated
+     * for numberOfThreads roots at a time, which are accumulated into the grid and freed before the next ones.
      */
     std::vector<double> calculate(double tend) {
 
         limitDomain = observationRadius>0;
 
         std::fill(grid.data.begin(), grid.data.end(), 0); // set data to zero
-        g_.resize(grid.data.size()); // saves last root contribution
 
+        std::vector<double> p = cacheKey();
+        if ((!incremental) || (p!=cacheKey_) || (src_.size()!=roots.size())) {
+            src_.assign(roots.size(), Sources());
+            age_.assign(roots.size(), -1.);
+            cacheKey_ = p;
+        }
+        std::vector<Sources>& src = src_;
+        std::vector<size_t> active; // roots with age>0
+        std::vector<bool> cached(roots.size(), false); // Eqn 11 of the root is taken from the previous call
         for (size_t ri = 0; ri< roots.size(); ri++) {
+            double lastCT = roots[ri]->getNodeCT(roots[ri]->getNumberOfNodes()-1);
+            double age = std::min(lastCT,tend) - roots[ri]->getNodeCT(0); // eq 11
+            if (age>0) {
+                if (age==age_[ri]) {
+                    cached[ri] = true;
+                } else {
+                    Sources& s = src[ri];
+                    s = sources(ri, age);
+                    bool keep = incremental && (lastCT<=tend); // the age does not change for a later tend
+                    if (((s.st>0) && (s.st<tend)) || keep) {
+                        s.g.resize(s.boxSize(), 0.);
+                    }
+                    age_[ri] = keep ? age : -1.;
+                }
+                active.push_back(ri);
+            }
+        }
 
-            //
-            // per root (passed to integrands)
-            r_ = roots[ri]; // eq 11
-            age_ = std::min(r_->getNodeCT(r_->getNumberOfNodes()-1),tend) - r_->getNodeCT(0);
-
-            if (age_>0) {
-
-                // per root (passed to integrands)
-                n_ = int(n0*r_->getLength()); // number of integration points eq 11
-                v_ = v[ri]; // for mps_straight, eq 11
-                tip_ = tip[ri]; // for mps_straight, eq 11
-                st_ = stopTime[ri]; // eq 13
-                st_ *= calc13;
-
-                std::cout << "Root #" << ri << "/" << roots.size() << ", age "<< age_ << ", stopped "<< st_ <<
-                    ", res "<< n_ << " \n"; // for debugging
-
-                // EQN 11
-                for (size_t i = 0; i<grid.nx; i++) {
-                    for(size_t j = 0; j<grid.ny; j++) {
-                        for (size_t k = 0; k<grid.nz; k++) {
-
-                            x_ = grid.getGridPoint(i,j,k); // integration point
-
-                            if ((!limitDomain) || (-sdfs[ri].getDist(x_)<observationRadius)) {
-
-                                size_t lind = i*(grid.ny*grid.nz)+j*grid.nz+k;
-
-                                // different flavors of Eqn (11)
-                                double c = eqn11(0, age_, 0, l);
-                                grid.data[lind] += c;
-                                g_[lind] = c;
-
-                            } else {
-                                size_t lind = i*(grid.ny*grid.nz)+j*grid.nz+k;
-                                g_[lind] = 0.;
+        size_t ts = std::max(tileSize, 1);
+        size_t tx = (grid.nx+ts-1)/ts, ty = (grid.ny+ts-1)/ts, tz = (grid.nz+ts-1)/ts;
+        auto tile = [&](int ti, size_t& i0, size_t& i1, size_t& j0, size_t& j1, size_t& k0, size_t& k1) {
+            size_t a = ti/(ty*tz), b = (ti/tz)%ty, c = ti%tz;
+            i0 = a*ts; i1 = std::min(i0+ts, grid.nx);
+            j0 = b*ts; j1 = std::min(j0+ts, grid.ny);
+            k0 = c*ts; k1 = std::min(k0+ts, grid.nz);
+        };
+
+        // EQN 11
+        forEach(tx*ty*tz, [&](int ti) {
+            size_t i0, i1, j0, j1, k0, k1;
+            tile(ti, i0, i1, j0, j1, k0, k1);
+            std::vector<double> xyz, dist;
+            for (size_t ri : active) {
+                Sources& s = src[ri];
+                size_t a0 = std::max(i0, s.i0), a1 = std::min(i1, s.i1);
+                size_t b0 = std::max(j0, s.j0), b1 = std::min(j1, s.j1);
+                size_t c0 = std::max(k0, s.k0), c1 = std::min(k1, s.k1);
+                if ((a0>=a1) || (b0>=b1) || (c0>=c1)) { // tile is outside of the observation domain
+                    continue;
+                }
+                if (cached[ri]) {
+                    for (size_t i = a0; i<a1; i++) {
+                        for(size_t j = b0; j<b1; j++) {
+                            for (size_t k = c0; k<c1; k++) {
+                                grid.data[i*(grid.ny*grid.nz)+j*grid.nz+k] += s.g[((i-s.i0)*(s.j1-s.j0)+(j-s.j0))*(s.k1-s.k0)+(k-s.k0)];
                             }
-
                         }
                     }
+                    continue;
                 }
-
-                // EQN 13
-                if ((st_>0) && (st_<tend)) { // has stopped growing
-                    std::cout << "13!";
-                    for (size_t i = 0; i<grid.nx; i++) {
-                        std::cout << "*";
-                        for(size_t j = 0; j<grid.ny; j++) {
-                            for (size_t k = 0; k<grid.nz; k++) {
-
+                size_t n = (a1-a0)*(b1-b0)*(c1-c0);
+                if (limitDomain) { // distances of the tile points
+                    xyz.resize(3*n);
+                    dist.resize(n);
+                    size_t c = 0;
+                    for (size_t i = a0; i<a1; i++) {
+                        for(size_t j = b0; j<b1; j++) {
+                            for (size_t k = c0; k<c1; k++) {
+                                Vector3d p = grid.getGridPoint(i,j,k);
+                                xyz[c] = p.x;
+                                xyz[n+c] = p.y;
+                                xyz[2*n+c] = p.z;
+                                c++;
+                            }
+                        }
+                    }
+                    sdfs[ri].getDists(xyz.data(), n, dist.data());
+                }
+                size_t c = 0;
+                for (size_t i = a0; i<a1; i++) {
+                    for(size_t j = b0; j<b1; j++) {
+                        for (size_t k = c0; k<c1; k++) {
+                            if ((!limitDomain) || (-dist[c]<observationRadius)) {
                                 size_t lind = i*(grid.ny*grid.nz)+j*grid.nz+k;
-                                if (g_[lind] > thresh13) {
-
-                                    x_ = grid.getGridPoint(i,j,k);
-                                    if ((!limitDomain) || (-sdfs[ri].getDist(x_)<observationRadius)) {
+                                double c11 = eqn11(s, grid.getGridPoint(i,j,k));
+                                grid.data[lind] += c11;
+                                if (!s.g.empty()) {
+                                    s.g[((i-s.i0)*(s.j1-s.j0)+(j-s.j0))*(s.k1-s.k0)+(k-s.k0)] = c11;
+                                }
+                            }
+                            c++;
+                        }
+                    }
+                }
+            }
+        });
 
-                                        // Eqn (13)
-                                        grid.data[lind] += integrate13(tend);
+        for (size_t ri : active) {
+            src[ri].clearPoints(); // Eqn 13 and the cache only need g
+        }
 
+        // EQN 13
+        std::vector<size_t> stopped; // roots that stopped growing before tend
+        for (size_t ri : active) {
+            if ((src[ri].st>0) && (src[ri].st<tend)) {
+                stopped.push_back(ri);
+            }
+        }
+        size_t nb = std::max(numberOfThreads, 1); // roots per batch
+        for (size_t b = 0; b<stopped.size(); b += nb) {
+            std::vector<size_t> batch(stopped.begin()+b, stopped.begin()+std::min(b+nb, stopped.size()));
+            if (type13==separable13) {
+                forEach(batch.size(), [&](int i) { convolve13(src[batch[i]], tend); });
+            }
+            forEach(tx*ty*tz, [&](int ti) {
+                size_t i0, i1, j0, j1, k0, k1;
+                tile(ti, i0, i1, j0, j1, k0, k1);
+                for (size_t ri : batch) {
+                    const Sources& s = src[ri];
+                    size_t a0 = std::max(i0, s.i0), a1 = std::min(i1, s.i1);
+                    size_t b0 = std::max(j0, s.j0), b1 = std::min(j1, s.j1);
+                    size_t c0 = std::max(k0, s.k0), c1 = std::min(k1, s.k1);
+                    for (size_t i = a0; i<a1; i++) {
+                        for(size_t j = b0; j<b1; j++) {
+                            for (size_t k = c0; k<c1; k++) {
+                                size_t bind = ((i-s.i0)*(s.j1-s.j0)+(j-s.j0))*(s.k1-s.k0)+(k-s.k0);
+                                if (s.g[bind] > thresh13) {
+                                    size_t lind = i*(grid.ny*grid.nz)+j*grid.nz+k;
+                                    if (type13==separable13) {
+                                        grid.data[lind] += s.h[bind];
+                                    } else {
+                                        grid.data[lind] += integrate13(s, grid.getGridPoint(i,j,k), tend);
                                     }
-
                                 }
                             }
                         }
                     }
-                    std::cout << "13\n";
                 }
-
-
-            } // if ages.at(i)>0
-
+            });
+            for (size_t ri : batch) { // accumulated, the buffers of the batch are freed
+                Sources::release(src[ri].h);
+                if (!incremental) {
+                    Sources::release(src[ri].g);
+                }
+            }
         }
 
+        if (!incremental) {
+            src_.clear();
+            age_.clear();
+        }
         return grid.data;
     }
 
-    double eqn11(double x0, double xend, double y0, double yend) {
+    /**
+     * Point sources of root ri, by the Gauss-Legendre quadrature of Eqn (11) (order n0 per cm root length),
+     * and the grid index box of its observation domain
+     *
+     * @param ri        root index
+     * @param age       age of the root at the final time [day]
+     */
+    Sources sources(size_t ri, double age) {
+        Sources s;
+        const auto& r = roots[ri];
+        int n = int(n0*r->getLength()); // number of integration points eq 11
+        std::vector<double> t, w; // quadrature points in [0,age], and weights
+        quadrature(n, 0., age, t, w);
+        auto add = [&](const Vector3d& p, double t, double w) {
+            s.x.push_back(p.x);
+            s.y.push_back(p.y);
+            s.z.push_back(p.z);
+            s.a.push_back(w*Q*sqrt(R)/(8*theta*to32(M_PI*Dl*t)));
+            s.c.push_back(-R / ( 4*Dl*t ));
+            s.e.push_back(-k/R * t);
+        };
         switch (type) {
-        case mps_straight: {
-            return gauss_legendre(n_, integrandMPS_straight, this, x0, xend);
+        case mps_straight: { // point source, root is represented by a single straight line (substituted)
+            for (size_t q = 0; q<t.size(); q++) {
+                add(tip[ri].plus(v[ri].times(t[q])), t[q], w[q]); // for t=0 at tip, at t=age at base
+            }
+            break;
+        }
+        case mps: { // moving point source, root is represented by a straight segments
+            for (size_t q = 0; q<t.size(); q++) {
+                add(pointAtAge(r, age-t[q]), t[q], w[q]);
+            }
+            break;
         }
-        case mps: {
-            return gauss_legendre(n_, integrandMPS, this, x0, xend);
+        case mls: { // moving line source, root is represented by a straight segments
+            std::vector<double> ll, wl; // quadrature points in [0,l], and weights
+            quadrature(n, 0., l, ll, wl);
+            for (size_t q = 0; q<t.size(); q++) {
+                double tl = r->calcLength(age-t[q]); // tip
+                for (size_t p = 0; p<ll.size(); p++) {
+                    if (tl>=ll[p]) { // otherwise the root is smaller than l
+                        add(pointAtAge(r, r->calcAge(tl-ll[p])), t[q], w[q]*wl[p]);
+                    }
+                }
+            }
+            break;
         }
-        case mls: {
-            return gauss_legendre_2D_cube(n_, integrandMLS, this, x0, xend, y0, yend);
+        default:
+            std::cout << "Unknown integration type \n";
         }
+        // observation domain
+        const auto& nodes = sdfs[ri].nodes_;
+        Vector3d mi = nodes[0], ma = nodes[0];
+        for (const auto& p : nodes) {
+            mi = Vector3d(std::min(mi.x, p.x), std::min(mi.y, p.y), std::min(mi.z, p.z));
+            ma = Vector3d(std::max(ma.x, p.x), std::max(ma.y, p.y), std::max(ma.z, p.z));
         }
-        std::cout << "Unknown integration type \n";
-        return 0.;
+        double d = observationRadius + *std::max_element(sdfs[ri].radii_.begin(), sdfs[ri].radii_.end());
+        indexRange(xgrid(), mi.x-d, ma.x+d, s.i0, s.i1);
+        indexRange(ygrid(), mi.y-d, ma.y+d, s.j0, s.j1);
+        indexRange(zgrid(), mi.z-d, ma.z+d, s.k0, s.k1);
+        if (!limitDomain) {
+            s.i0 = 0; s.i1 = grid.nx;
+            s.j0 = 0; s.j1 = grid.ny;
+            s.k0 = 0; s.k1 = grid.nz;
+        }
+        s.st = calc13 ? stopTime[ri] : 0.;
+        return s;
+    }
+
+    /**
+     * Eqn (11) at grid point x, i.e. the sum over the point sources of the root
+     */
+    static double eqn11(const Sources& s, const Vector3d& x) {
+        double c = 0.;
+        for (size_t q = 0; q<s.a.size(); q++) {
+            double dx = x.x-s.x[q], dy = x.y-s.y[q], dz = x.z-s.z[q];
+            c += s.a[q]*exp(s.c[q]*(dx*dx+dy*dy+dz*dz) + s.e[q]); // Eqn (11)
+        }
+        return c;
     }
 
-    // simplistic integration in 3d
-    double integrate13(double t) {
+    /**
+     * Gauss-Legendre quadrature points and weights of order n in [a,b] (same abscissas as gauss_legendre)
+     */
+    static void quadrature(int n, double a, double b, std::vector<double>& t, std::vector<double>& w) {
+        t.clear();
+        w.clear();
+        if (n<1) {
+            return;
+        }
+        int m = (n+1)>>1;
+        std::vector<double> x(m), wx(m);
+        gauss_legendre_tbl(n, x.data(), wx.data(), 1e-10);
+        double A = 0.5*(b-a);
+        double B = 0.5*(b+a);
+        for (int i = 0; i<m; i++) {
+            if ((n&1) && (i==0)) { // n odd: center point
+                t.push_back(B);
+                w.push_back(A*wx[i]);
+            } else {
+                t.push_back(B+A*x[i]);
+                w.push_back(A*wx[i]);
+                t.push_back(B-A*x[i]);
+                w.push_back(A*wx[i]);
+            }
+        }
+    }
+
+    // simplistic integration in 3d (over the observation domain of the root, where its contribution is not zero)
+    double integrate13(const Sources& s, const Vector3d& x, double t) const {
         double c = 0;
-        for (size_t i = 0; i<grid.nx; i++) {
-            for(size_t j = 0; j<grid.ny; j++) {
-                for (size_t k = 0; k<grid.nz; k++) {
-                    Vector3d y = grid.getGridPoint(i,j,k);
-                    size_t lind = i*(grid.ny*grid.nz)+j*grid.nz+k;
-                    c += integrand13(y,lind, t)*dx3;
+        for (size_t i = s.i0; i<s.i1; i++) {
+            for(size_t j = s.j0; j<s.j1; j++) {
+                for (size_t k = s.k0; k<s.k1; k++) {
+                    Vector3d y(xgrid()[i], ygrid()[j], zgrid()[k]);
+                    double g = s.g[((i-s.i0)*(s.j1-s.j0)+(j-s.j0))*(s.k1-s.k0)+(k-s.k0)];
+                    c += integrand13(s, x, y, g, t)*dx3;
                 }
             }
         }
         return c;
     }
 
+    /**
+     * Eqn (13) at all grid points of the index box of the root, as discrete convolution of g with the Gaussian kernel.
+     *
+     * The kernel is a product of one dimensional kernels, so the convolution is done in x, y, and z direction one after the other,
+     * which costs O(N*(nx+ny+nz)) instead of O(N^2) for the N grid points of the index box. The result equals integrate13 (up to rounding).
+     *
+     * @param s         point sources of a root that stopped growing, the result is stored in s.h
+     * @param t         final time [day]
+     */
+    void convolve13(Sources& s, double t) const {
+        size_t nx = s.i1-s.i0, ny = s.j1-s.j0, nz = s.k1-s.k0;
+        double dt = t-s.st;
+        double a = R/(4*Dl*dt);
+        auto kernel = [&](const std::vector<double>& g, size_t i0, size_t n) { // one dimensional kernel, n x n
+            std::vector<double> kn(n*n);
+            for (size_t i = 0; i<n; i++) {
+                for (size_t j = 0; j<n; j++) {
+                    double d = g[i0+i]-g[i0+j];
+                    kn[i*n+j] = exp(-a*d*d);
+                }
+            }
+            return kn;
+        };
+        std::vector<double> kx = kernel(xgrid(), s.i0, nx), ky = kernel(ygrid(), s.j0, ny), kz = kernel(zgrid(), s.k0, nz);
+        std::vector<double> u(s.g.size(), 0.), w(s.g.size(), 0.);
+        for (size_t ij = 0; ij<nx*ny; ij++) { // z direction
+            for (size_t k = 0; k<nz; k++) {
+                double c = 0.;
+                for (size_t l = 0; l<nz; l++) {
+                    c += kz[k*nz+l]*s.g[ij*nz+l];
+                }
+                u[ij*nz+k] = c;
+            }
+        }
+        for (size_t i = 0; i<nx; i++) { // y direction
+            for (size_t j = 0; j<ny; j++) {
+                for (size_t l = 0; l<ny; l++) {
+                    double c = ky[j*ny+l];
+                    for (size_t k = 0; k<nz; k++) {
+                        w[(i*ny+j)*nz+k] += c*u[(i*ny+l)*nz+k];
+                    }
+                }
+            }
+        }
+        std::fill(u.begin(), u.end(), 0.); // u is reused for the result
+        double f = to32(R) / to32(4*Dl*M_PI*dt)*exp(-k*dt/R)*dx3;
+        for (size_t i = 0; i<nx; i++) { // x direction
+            for (size_t l = 0; l<nx; l++) {
+                double c = f*kx[i*nx+l];
+                for (size_t jk = 0; jk<ny*nz; jk++) {
+                    u[i*ny*nz+jk] += c*w[l*ny*nz+jk];
+                }
+            }
+        }
+        s.h.swap(u);
+    }
+
     // integrand Eqn 13
-    double integrand13(Vector3d& y, size_t lind, double t) {
-        double dt = t-st_;
-        double c = to32(R)*g_[lind] / to32(4*Dl*M_PI*dt);
-        Vector3d z = x_.minus(y);
+    double integrand13(const Sources& s, const Vector3d& x, const Vector3d& y, double g, double t) const {
+        double dt = t-s.st;
+        double c = to32(R)*g / to32(4*Dl*M_PI*dt);
+        Vector3d z = x.minus(y);
         return c*exp(-R/(4*Dl*dt) * z.times(z) - k*dt/R);
     }
 
@@ -226,66 +494,71 @@ public:
 
     static double to3(double x) { return x*x*x; }
 
-    // point source, root is represented by a single straight line (substituted)
-    static double integrandMPS_straight(double t, void* param) {
-        ExudationModel* p = (ExudationModel*) param;
-        double c = -p->R / ( 4*p->Dl*t );
-        double d = 8*(p->theta)*ExudationModel::to32(M_PI*p->Dl*t);
-
-        Vector3d xtip = p->tip_.plus(p->v_.times(t)); // for t=0 at tip, at t=age at base, as above
-        Vector3d z = p->x_.minus(xtip);
-
-        return ((p->Q)*sqrt(p->R))/d *exp(c*z.times(z) - p->k/p->R * t); // Eqn (11)
-    }
+    // Root system
+    std::vector<std::shared_ptr<Root>> roots; // roots that started growing
+    std::vector<double> stopTime; // time when root stopped growing, 0 if it has not
+    std::vector<Vector3d> tip;
+    std::vector<Vector3d> v; // direction from tip towards root base
+    double dx3 = 1;
+    std::vector<SDF_RootSystem> sdfs; // distance to each root
+    bool limitDomain = (observationRadius>0);
 
-    // moving line source, root is represented by a straight segments
-    static double integrandMLS(double t, double l, void* param) {
-        ExudationModel* p = (ExudationModel*) param;
-        double c = -(p->R) / ( 4*(p->Dl)*t );
-        double d = 8*(p->theta)*ExudationModel::to32(M_PI*p->Dl*t);
+protected:
 
+    const std::vector<double>& xgrid() const { return grid.xgrid->grid; } ///< grid point coordinates in x
+    const std::vector<double>& ygrid() const { return grid.ygrid->grid; } ///< grid point coordinates in y
+    const std::vector<double>& zgrid() const { return grid.zgrid->grid; } ///< grid point coordinates in z
 
-        double tl = p->r_->calcLength( p->age_-t ); // tip
-        if (tl<l) { // if root smaller l
-            return 0.;
-        }
-        double agel = p->r_->calcAge(tl-l);
-        Vector3d tipLS = p->ExudationModel::pointAtAge(p->r_, agel);
-        Vector3d z = p->x_.minus(tipLS);
+    std::vector<Sources> src_; // point sources per root, and their contribution of Eqn (11) in incremental mode
+    std::vector<double> age_; // age of the root, for which src_ was computed, -1 if it was not
+    std::vector<double> cacheKey_; // model parameters, for which src_ was computed
 
-        return ((p->Q)*sqrt(p->R))/d *exp(c*z.times(z) - p->k/p->R * t); // Eqn (11)
+    // model parameters that src_ depends on
+    std::vector<double> cacheKey() const {
+        return { Q, Dl, theta, R, k, l, double(type), double(n0), double(calc13), observationRadius };
     }
 
-    // moving point source, root is represented by a straight segments
-    static double integrandMPS(double t, void* param) {
-        ExudationModel* p = (ExudationModel*) param;
-        double c = -p->R / ( 4*p->Dl*t );
-        double d = 8*(p->theta)*ExudationModel::to32(M_PI*p->Dl*t);
-
-        Vector3d xtip = ExudationModel::pointAtAge(p->r_, p->age_-t);
-        Vector3d z = p->x_.minus(xtip);
-
-        return ((p->Q)*sqrt(p->R))/d *exp(c*z.times(z) - p->k/p->R * t); // Eqn (11)
+    // indices [i0,i1) of the grid points within [a,b]
+    static void indexRange(const std::vector<double>& g, double a, double b, size_t& i0, size_t& i1) {
+        i0 = std::lower_bound(g.begin(), g.end(), a) - g.begin();
+        i1 = std::upper_bound(g.begin(), g.end(), b) - g.begin();
+        i1 = std::max(i0, i1);
     }
 
-    // Root system
-    std::vector<std::shared_ptr<Root>> roots;
-    std::vector<double> stopTime; // time when root stopped growing, 0 if it has not
-    std::vector<Vector3d> tip;
-    std::vector<Vector3d> v; // direction from tip towards root base
-    double dx3 = 1;
-    std::vector<SDF_RootSystem> sdfs; // direction from tip towards root base
-    bool limitDomain = (observationRadius>0);
-
-    // Set before integrating
-    Vector3d x_ = Vector3d(); // integration point
-    int n_ = 0;
-    std::shared_ptr<Root> r_ = nullptr; // current root
-    double age_ = 0;
-    Vector3d tip_ = Vector3d();
-    Vector3d v_ = Vector3d();
-    double st_ = 0; // stop time (eqn 13)
-    std::vector<double> g_;  // eqn 13
+    /**
+     * Calls @param f for every index in [0,n), the threads take the next index from a shared counter
+     * (as Ensemble::forEach), sequentially for numberOfThreads<=1. The first exception is rethrown, after all threads are finished.
+     */
+    void forEach(int n, const std::function<void(int)>& f) const {
+        int nt = std::max(numberOfThreads, 1);
+        std::atomic<int> next(0);
+        std::exception_ptr error = nullptr;
+        std::mutex errorMutex;
+        auto worker = [&]() {
+            int i;
+            while ((i = next++) < n) {
+                try {
+                    f(i);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                }
+            }
+        };
+        std::vector<std::thread> threads;
+        for (int t=1; t<std::min(nt, n); t++) {
+            threads.push_back(std::thread(worker));
+        }
+        worker();
+        for (auto& t : threads) {
+            t.join();
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
 
 };
 
@@ -53,6 +53,7 @@ Leaf::Leaf(std::shared_ptr<Organism> plant, int type, Vector3d iheading, double
 	// std::cout <<"subtype ="<<param()->subType <<"getleafphytomerID =" <<getleafphytomerID(param()->subType)<< "\n";
 	auto leaf_p = this->param();
 	addleafphytomerID(leaf_p->subType);
+	Organism::RandomScope scope(randomKey, 0, Organism::rp_rotation);
 	double beta = getleafphytomerID(leaf_p->subType)*M_PI*getLeafRandomParameter()->rotBeta
 			+ M_PI*plant->rand()*getLeafRandomParameter()->betaDev ;  //+ ; //2 * M_PI*plant->rand(); // initial rotation
 	Matrix3d ons = Matrix3d::ons(iheading);
@@ -100,6 +101,23 @@ std::shared_ptr<Organ> Leaf::copy(std::shared_ptr<Organism> p)
 	return l;
 }
 
+/**
+ * Copies the leaf into the new plant @param p, sharing the specific parameters and the node data (@see Organ::fork).
+ *
+ * @param p     the plant the copied organ will be part of
+ */
+std::shared_ptr<Organ> Leaf::fork(std::shared_ptr<Organism> p)
+{
+	auto l = std::make_shared<Leaf>(*this); // shallow copy, shares parameters and node data
+	l->parent = std::weak_ptr<Organ>();
+	l->plant = p;
+	for (size_t i=0; i< children.size(); i++) {
+		l->children[i] = children[i]->fork(p); // fork laterals
+		l->children[i]->setParent(l);
+	}
+	return l;
+}
+
 /**
  * Simulates f_gf of this leaf for a time span dt
  *
@@ -128,6 +146,7 @@ void Leaf::simulate(double dt, bool verbose)
 			double P = getLeafRandomParameter()->f_sbp->getValue(nodes.back(),shared_from_this());
 			if (P<1.) { // P==1 means the lateral emerges with probability 1 (default case)
 				double p = 1.-std::pow((1.-P), dt); //probability of emergence in this time step
+				Organism::RandomScope scope(randomKey, Organism::hashIndex(age), Organism::rp_emergence);
 				if (plant.lock()->rand()>p) { // not rand()<p
 					age -= dt; // the leaf does not emerge in this time step
 				}
@@ -334,6 +353,7 @@ void Leaf::addleafphytomerID(int subtype)
 void Leaf::createLateral(bool silence)
 {
 
+	Organism::RandomScope scope(randomKey, nodes.size()-1, Organism::rp_lateral);
 	int lt = getLeafRandomParameter()->getLateralType(getNode(nodes.size()-1));
 
 	if (lt>0) {
@@ -484,11 +504,11 @@ void Leaf::createSegments(double l, bool verbose)
 			if (olddx<dx()*0.99) { // shift node instead of creating a new node
 				shiftl = std::min(dx()-olddx, l);
 				double sdx = olddx + shiftl; // length of new segment
+				Organism::RandomScope scope(randomKey, Organism::hashIndex(length+shiftl), Organism::rp_tropism); // draws for the moved node
 				Vector3d newdxv = getIncrement(n2, sdx);
-				nodes[nn-1] = Vector3d(n2.plus(newdxv));
 				double et = this->calcCreationTime(length+shiftl);
-				nodeCTs[nn-1] = et; // in case of impeded growth the node emergence time is not exact anymore, but might break down to temporal resolution
-				moved = true;
+				// in case of impeded growth the node emergence time is not exact anymore, but might break down to temporal resolution
+				moveNode(nn-1, Vector3d(n2.plus(newdxv)), et);
 				l -= shiftl;
 				if (l<=0) { // ==0 should be enough
 					return;
@@ -518,6 +538,7 @@ void Leaf::createSegments(double l, bool verbose)
 			}
 		}
 		sl += sdx;
+		Organism::RandomScope scope(randomKey, nodes.size(), Organism::rp_tropism); // draws for the new node
 		Vector3d newdx = getIncrement(nodes.back(), sdx);
 		Vector3d newnode = Vector3d(nodes.back().plus(newdx));
 		double et = this->calcCreationTime(length+shiftl+sl);
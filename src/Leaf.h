@@ -29,6 +29,7 @@ public:
 	virtual ~Leaf() { };
 
 	std::shared_ptr<Organ> copy(std::shared_ptr<Organism> plant) override;   ///< deep copies the root tree
+	std::shared_ptr<Organ> fork(std::shared_ptr<Organism> plant) override;   ///< copies the leaf tree, sharing parameters and node data
 
 	int organType() const override { return Organism::ot_leaf; } ///< returns the organs type
 
@@ -1,10 +1,12 @@
 // -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
 #include "MappedOrganism.h"
 
-#include "SegmentAnalyser.h"
+#include "Checkpoint.h"
 
 #include <algorithm>
 #include <functional>
+#include <numeric>
+#include <array>
 #include <cmath>
 
 namespace CPlantBox {
@@ -81,8 +83,20 @@ void MappedSegments::setSoilGrid(const std::function<int(double,double,double)>&
  */
 void MappedSegments::setSoilGrid(const std::function<int(double,double,double)>& s) {
     soil_index = s;
-    seg2cell.clear(); // re-map all segments
-    cell2seg.clear();
+    soil_indices = nullptr;
+    clearMappers(); // re-map all segments
+    mapSegments(segments);
+}
+
+/**
+ * Sets the batch soil cell index call back function. Resets and updates the mappers.
+ *
+ * The callback function takes the points (x0,y0,z0,x1,y1,z1,...) [cm] and returns the indices of their cells.
+ * In this way, all segments of a time step are mapped by a single call (e.g. from Python).
+ */
+void MappedSegments::setSoilIndices(const std::function<void(const std::vector<double>&, std::vector<int>&)>& s) {
+    soil_indices = s;
+    clearMappers(); // re-map all segments
     mapSegments(segments);
 }
 
@@ -97,8 +111,7 @@ void MappedSegments::setRectangularGrid(Vector3d min, Vector3d max, Vector3d res
     rectangularGrid = cut;
     cutSegments(); // re-add (for cutting)
     sort(); // todo only necessary
-    seg2cell.clear(); // re-map all segments
-    cell2seg.clear();
+    clearMappers(); // re-map all segments
     mapSegments(segments);
 }
 
@@ -110,125 +123,323 @@ void MappedSegments::setRectangularGrid(Vector3d min, Vector3d max, Vector3d res
  * @param segs      the (new) segments that need to be mapped
  */
 void MappedSegments::mapSegments(const std::vector<Vector2i>& segs) {
-    for (auto& ns : segs) {
-        Vector3d mid = (nodes[ns.x].plus(nodes[ns.y])).times(0.5);
-        int cellIdx = soil_index(mid.x,mid.y,mid.z);
+    std::vector<double> mids(3*segs.size()); // mid points (x0,y0,z0,x1,...)
+    for (size_t i=0; i<segs.size(); i++) {
+        Vector3d mid = (nodes[segs[i].x].plus(nodes[segs[i].y])).times(0.5);
+        mids[3*i] = mid.x;
+        mids[3*i+1] = mid.y;
+        mids[3*i+2] = mid.z;
+    }
+    std::vector<int> cells;
+    soilIndices(mids, cells);
+    mapSegments(segs, cells);
+}
+
+/**
+ * Updates the mappers with known cells
+ *
+ * @param segs      the (new) segments that need to be mapped
+ * @param cells     cell index of each segment, -1 if out of domain
+ */
+void MappedSegments::mapSegments(const std::vector<Vector2i>& segs, const std::vector<int>& cells) {
+    for (size_t i=0; i<segs.size(); i++) {
+        const Vector2i& ns = segs[i];
+        int cellIdx = cells[i];
+        int segIdx = ns.y-1; // this is unique in a tree like structured
+        if (segIdx>=int(seg2cell.size())) {
+            seg2cell.resize(segIdx+1, -1);
+        }
         if (cellIdx>=0) {
-            int segIdx = ns.y-1; // this is unique in a tree like structured
             seg2cell[segIdx] = cellIdx;
-            if (cell2seg.count(cellIdx)>0) {
-                cell2seg[cellIdx].push_back(segIdx);
-            } else {
-                cell2seg[cellIdx] = std::vector<int>({segIdx});
-            }
         } else {
+            seg2cell[segIdx] = -1;
+            Vector3d mid = (nodes[ns.x].plus(nodes[ns.y])).times(0.5);
             std::cout << "MappedSegments::mapSegments: warning segment with mid " << mid.toString() << " exceeds domain, skipped segment \n";
         }
     }
+    cell2segValid = false;
+}
+
+/**
+ * Soil cell indices of multiple points, by the batch call back soil_indices if it is set,
+ * directly (without call back) if soil_index is the default mapper (@see MappedSegments::soil_index_),
+ * or point by point by soil_index otherwise
+ *
+ * @param xyz       points (x0,y0,z0,x1,y1,z1,...) [cm]
+ * @param cells     (out) cell index per point, -1 if out of domain
+ */
+void MappedSegments::soilIndices(const std::vector<double>& xyz, std::vector<int>& cells) const {
+    size_t n = xyz.size()/3;
+    if (n==0) { // no call back for empty batches
+        cells.clear();
+        return;
+    }
+    if (soil_indices) {
+        soil_indices(xyz, cells);
+        if (cells.size()!=n) {
+            throw std::invalid_argument("MappedSegments::soilIndices: soil_indices returned "+std::to_string(cells.size())+" cells for "+
+                std::to_string(n)+" points");
+        }
+    } else if (isDefaultIndex()) {
+        soil_indices_(xyz, cells);
+    } else {
+        cells.resize(n);
+        for (size_t i=0; i<n; i++) {
+            cells[i] = soil_index(xyz[3*i], xyz[3*i+1], xyz[3*i+2]);
+        }
+    }
+}
+
+/**
+ * Rebuilds the soil cell to root segment mapper (cell2segStart, cell2segs) from seg2cell,
+ * if segments were mapped or removed since the last call (counting sort, linear in the number of segments and cells)
+ */
+void MappedSegments::updateCell2Seg() {
+    if (cell2segValid) {
+        return;
+    }
+    int nc = 0; // number of cells
+    for (int c : seg2cell) {
+        nc = std::max(nc, c+1);
+    }
+    cell2segStart.assign(nc+1, 0);
+    for (int c : seg2cell) {
+        if (c>=0) {
+            cell2segStart[c+1]++;
+        }
+    }
+    for (int c = 0; c<nc; c++) {
+        cell2segStart[c+1] += cell2segStart[c];
+    }
+    cell2segs.resize(cell2segStart[nc]);
+    std::vector<int> fill = std::vector<int>(cell2segStart.begin(), cell2segStart.end()-1);
+    for (int si = 0; si<int(seg2cell.size()); si++) {
+        int c = seg2cell[si];
+        if (c>=0) {
+            cell2segs[fill[c]++] = si;
+        }
+    }
+    cell2segValid = true;
+    cell2segMapValid = false;
+}
+
+/**
+ * Segment indices within the soil cell @param cellIdx
+ */
+std::vector<int> MappedSegments::getCellSegments(int cellIdx) {
+    updateCell2Seg();
+    if ((cellIdx<0) || (cellIdx>=int(cell2segStart.size())-1)) {
+        return std::vector<int>(0);
+    }
+    return std::vector<int>(cell2segs.begin()+cell2segStart[cellIdx], cell2segs.begin()+cell2segStart[cellIdx+1]);
+}
+
+/**
+ * Soil cell to root segment mapper as hash map, only cells containing segments are keys.
+ * The map is kept until the mapping changes.
+ */
+const std::map<int, std::vector<int>>& MappedSegments::getCell2Seg() {
+    updateCell2Seg();
+    if (!cell2segMapValid) {
+        cell2segMap.clear();
+        for (int c = 0; c<int(cell2segStart.size())-1; c++) {
+            if (cell2segStart[c+1]>cell2segStart[c]) {
+                cell2segMap[c] = std::vector<int>(cell2segs.begin()+cell2segStart[c], cell2segs.begin()+cell2segStart[c+1]);
+            }
+        }
+        cell2segMapValid = true;
+    }
+    return cell2segMap;
+}
+
+/**
+ * Root segment to soil cell mapper as hash map, segments that are not mapped (i.e. out of the domain) are no keys
+ */
+std::map<int, int> MappedSegments::getSeg2Cell() const {
+    std::map<int, int> map;
+    for (int si = 0; si<int(seg2cell.size()); si++) {
+        if (seg2cell[si]>=0) {
+            map.emplace_hint(map.end(), si, seg2cell[si]);
+        }
+    }
+    return map;
+}
+
+/**
+ * Sets the root segment to soil cell mapper, segments that are no keys are not mapped
+ */
+void MappedSegments::setSeg2Cell(const std::map<int, int>& map) {
+    int n = map.empty() ? 0 : map.rbegin()->first+1;
+    if (!map.empty() && (map.begin()->first<0)) {
+        throw std::invalid_argument("MappedSegments::setSeg2Cell: negative segment index");
+    }
+    seg2cell.assign(std::max(n, int(segments.size())), -1);
+    for (const auto& sc : map) {
+        seg2cell[sc.first] = sc.second;
+    }
+    cell2segValid = false;
 }
 
 /**
  * Adds the segments to the list.
  * Optionally, cut segments @param segs at a rectangular grid (@see MappedSegments::setSoilGrid)
+ *
+ * Segments are sorted first (@see MappedSegments::sort), segments that were cut before are cut again from their original segment.
  */
 void MappedSegments::cutSegments() {
     assert(segments.size()==radii.size() && "MappedSegments::addSegments: number of segments and radii disagree!");
     assert(segments.size()==types.size() && "MappedSegments::addSegments: number of segments and types disagree!");
     if (rectangularGrid) {
-        int n = segments.size(); // segs.size() will change within the loop (recursive implementation)
+        sort(); // segment index == second node index - 1
+        int n = segments.size(); // segments.size() will change within the loop
+        std::vector<int> cells; // mapped afterwards (@see MappedSegments::setRectangularGrid)
         for (int i=0; i<n; i++ ) {
-            addSegment(segments[i], radii[i], types[i], i);
+            if (!isCutNode(segments[i].y)) { // the pieces of a segment are cut together
+                cutSegment(segments[i].y, cells);
+            }
         }
     }
 }
 
 /**
- * Adds a single segment at index i, appends the remaining segments, if segment is cut
+ * Cuts the segment ending at node m at the faces of the rectangular grid (@see MappedSegments::cutGrid).
  *
- * This approach may run into problems if a segment is located exactly along a face.
+ * If the segment was cut before (e.g. because its end node moved), its pieces are cut again from the original segment,
+ * and the previous cut nodes are reused, so that node and segment indices stay stable. New cut nodes are appended,
+ * with their segment at index node-1. Creation times of the cut nodes are linearly interpolated.
+ *
+ * @param m     index of the segments end node (not a cut node), the segment has index m-1
+ * @param cells (out) cell index of each resulting segment (@see MappedSegments::cutGrid)
+ * @return      the indices of the resulting segments
  */
-void MappedSegments::addSegment(Vector2i ns, double r,  int t, int ii) {
-    Vector3d n1 = nodes[ns.x];
-    Vector3d n2 = nodes[ns.y];
-    Vector3d mid = (n1.plus(n2)).times(0.5);
-    int im = soil_index(mid.x,mid.y,mid.z); // cell indices
-    int in1 = soil_index(n1.x,n1.y,n1.z);
-    int in2 = soil_index(n2.x,n2.y,n2.z);
-    if ((im!=in1) or (im!=in2)) { // cut
-        // build SDF
-        auto width = maxBound.minus(minBound); // construct sdf
-        Vector3d dx(width.x/resolution.x, width.y/resolution.y, width.z/resolution.z);
-        auto mid0 = mid.minus(minBound);
-        int x = std::floor(mid0.x/dx.x);
-        int y = std::floor(mid0.y/dx.y);
-        int z = std::floor(mid0.z/dx.z);
-        SDF_Cuboid sdf; // create a signed distance function for cutting
-        Vector3d minB(x*dx.x, y*dx.y, z*dx.z);
-        minB = minB.plus(minBound);
-        Vector3d maxB((x+1)*dx.x, (y+1)*dx.y, (z+1)*dx.z);
-        maxB = maxB.plus(minBound);
-        sdf.min = minB;
-        sdf.max = maxB;
-        // std::cout << minB.toString() << ", " << maxB.toString() << ", width " << width.toString() << ", " << sdf.min.toString() << ", " << sdf.max.toString() << "\n";
-
-        im = sdf.getDist(mid)>0; // redo indices, since accuracy of pickking may differ
-        in1 = sdf.getDist(n1)>0;
-        in2 = sdf.getDist(n2)>0;
-        if ((im!=in1) or (im!=in2)) {
-            Vector3d cPoint;
-            if (im==in1) { // is one node at mid (sort accordingly)
-                // std::cout << "n1 " << sdf.getDist(n1) << " mid " << sdf.getDist(mid) << " n2 " << sdf.getDist(n2) << ",indices "<< in1 << ", " << im << ", " << in2 << "\n";
-                if (sdf.getDist(n2)<0) {
-                    cPoint = SegmentAnalyser::cut(n2, mid, std::make_shared<SDF_Cuboid>(sdf), eps);
-                } else {
-                    cPoint = SegmentAnalyser::cut(mid, n2, std::make_shared<SDF_Cuboid>(sdf), eps);
-                }
-                nodeCTs.push_back(nodeCTs[ns.y]); // todo: we might linearly interpolate
-            } else if (im==in2) {
-                // std::cout << "n2 " << sdf.getDist(n2) << " mid " << sdf.getDist(mid) << " n1 " << sdf.getDist(n1) << ", " << in2 << ", " << im << ", " << in1 << "\n";
-                if (sdf.getDist(n1)<0) {
-                    cPoint = SegmentAnalyser::cut(n1, mid, std::make_shared<SDF_Cuboid>(sdf), eps);
-                } else {
-                    cPoint = SegmentAnalyser::cut(mid, n1, std::make_shared<SDF_Cuboid>(sdf), eps);
-                }
-                nodeCTs.push_back(nodeCTs[ns.x]); // todo: we might linearly interpolate
-            } else { // otherwise split in mid, use cutSegments on those
-                cPoint = mid;
-                nodeCTs.push_back(0.5*(nodeCTs[ns.x]+nodeCTs[ns.y]));
-            }
-            // std::cout << "[" << n1.toString() << n2.toString() << "] -> [" << nodes[ns.x].toString() << ", " << nodes.back().toString() << "], ["<< nodes.back().toString() << ", " << n2.toString() << "], " << "\n";
-            nodes.push_back(cPoint);
-            Vector2i s1(ns.x, nodes.size()-1);
-            Vector2i s2(nodes.size()-1, ns.y);
-            if ((length(s1)<eps) ||  (length(s2)<eps)) { // if the cut segments are too small, just give up
-                add(ns, r, t, ii);
-                nodes.pop_back(); // remove cPoint
-            } else {
-                addSegment(s1, r, t , ii); // first segment replaces at index ii
-                addSegment(s2, r, t , -1); // append second segment
+std::vector<int> MappedSegments::cutSegment(int m, std::vector<int>& cells) {
+    std::vector<int> chain; // cut nodes of previous cuts, from the original first node towards m
+    int a = segments.at(m-1).x;
+    while (isCutNode(a)) {
+        chain.push_back(a);
+        a = segments.at(a-1).x;
+    }
+    std::reverse(chain.begin(), chain.end());
+    std::vector<double> t;
+    cutGrid(nodes.at(a), nodes.at(m), t, cells);
+    while (t.size()<chain.size()) { // keep all previous cut nodes, by splitting the longest piece
+        size_t k = 0;
+        double t0 = 0., t1 = 1.;
+        for (size_t i=0; i<=t.size(); i++) {
+            double a_ = (i>0) ? t[i-1] : 0.;
+            double b_ = (i<t.size()) ? t[i] : 1.;
+            if (b_-a_>t1-t0) {
+                k = i;
+                t0 = a_;
+                t1 = b_;
             }
-        } else { // im==in1==in2, dont't cut
-            // std::cout << "ok " << ii <<": (" << ns.x <<", " << ns.y << ") [" << n1.toString() <<", "<< n2.toString() <<"\n";
-            add(ns, r, t, ii);
         }
-    } else { // im==in1==in2, dont't cut
-        // std::cout << "ok " << ii <<": (" << ns.x <<", " << ns.y << ") [" << n1.toString() <<", "<< n2.toString() <<"\n";
-        add(ns, r, t, ii);
+        t.insert(t.begin()+k, 0.5*(t0+t1));
+        cells.insert(cells.begin()+k, cells[k]);
+    }
+    double r = radii.at(m-1);
+    int type = types.at(m-1);
+    Vector3d pa = nodes[a];
+    Vector3d d = nodes[m].minus(pa);
+    double cta = nodeCTs.at(a);
+    double dct = nodeCTs.at(m)-cta;
+    std::vector<int> segs;
+    int prev = a;
+    for (size_t i=0; i<t.size(); i++) {
+        Vector3d p = pa.plus(d.times(t[i]));
+        double ct = cta+dct*t[i];
+        int c;
+        if (i<chain.size()) { // reuse
+            c = chain[i];
+            nodes[c] = p;
+            nodeCTs[c] = ct;
+            segments[c-1] = Vector2i(prev, c);
+            radii[c-1] = r;
+            types[c-1] = type;
+        } else { // append
+            assert(segments.size()+1==nodes.size() && "MappedSegments::cutSegment: segments are not sorted");
+            c = nodes.size();
+            nodes.push_back(p);
+            nodeCTs.push_back(ct);
+            cutNodes.resize(c+1, false);
+            cutNodes[c] = true;
+            segments.push_back(Vector2i(prev, c));
+            radii.push_back(r);
+            types.push_back(type);
+        }
+        segs.push_back(c-1);
+        prev = c;
     }
+    segments[m-1] = Vector2i(prev, m);
+    segs.push_back(m-1);
+    return segs;
 }
 
 /**
- * Adds the segment at index i, or appends it, if i = -1
+ * Computes where the segment from p to q crosses the faces of the rectangular grid (minBound, maxBound, resolution),
+ * by a grid traversal (3d DDA): per direction the crossed faces follow in closed form from the cells of p and q.
+ * The traversal is clipped to the domain, parts of the segment outside of the domain are not cut.
+ * Crossings that would create pieces shorter than eps (e.g. at the edges and corners of cells) are skipped.
+ *
+ * @param p         first node of the segment
+ * @param q         second node of the segment
+ * @param t         (out) ascending parameters in (0,1) of the cutting points p+t*(q-p)
+ * @param cells     (out) cell index of each of the t.size()+1 pieces (@see MappedSegments::soil_index_, -1 if out of domain)
  */
-void MappedSegments::add(Vector2i s, double r,  int t, int i) {
-    if (i>=0) {
-        segments[i] = s;
-        radii[i] = r;
-        types[i] = t;
-    } else {
-        segments.push_back(s);
-        radii.push_back(r);
-        types.push_back(t);
+void MappedSegments::cutGrid(const Vector3d& p, const Vector3d& q, std::vector<double>& t, std::vector<int>& cells) const {
+    t.clear();
+    cells.clear();
+    Vector3d d = q.minus(p);
+    double l = d.length();
+    if (l>0) {
+        std::array<double,3> p_ = { p.x, p.y, p.z };
+        std::array<double,3> q_ = { q.x, q.y, q.z };
+        std::array<double,3> min_ = { minBound.x, minBound.y, minBound.z };
+        std::array<double,3> max_ = { maxBound.x, maxBound.y, maxBound.z };
+        std::array<int,3> r = { int(resolution.x), int(resolution.y), int(resolution.z) };
+        std::array<double,3> h = { (maxBound.x-minBound.x)/resolution.x, (maxBound.y-minBound.y)/resolution.y,
+            (maxBound.z-minBound.z)/resolution.z }; // cell widths
+        double ta = 0., tb = 1.; // the segment is within the domain for t in [ta,tb] (slab method)
+        for (int k=0; k<3; k++) {
+            if (p_[k]!=q_[k]) {
+                double t0 = (min_[k]-p_[k])/(q_[k]-p_[k]);
+                double t1 = (max_[k]-p_[k])/(q_[k]-p_[k]);
+                ta = std::max(ta, std::min(t0, t1));
+                tb = std::min(tb, std::max(t0, t1));
+            } else if ((p_[k]<min_[k]) || (p_[k]>max_[k])) {
+                tb = -1.; // parallel and outside
+            }
+        }
+        for (int k=0; (k<3) && (ta<=tb); k++) {
+            if (p_[k]!=q_[k]) {
+                int i0 = std::floor((p_[k]-min_[k])/h[k]); // cell of p
+                int i1 = std::floor((q_[k]-min_[k])/h[k]); // cell of q
+                int g0 = std::max(std::min(i0, i1)+1, 0); // crossed faces g0, ..., g1 of the domain, face g is between cell g-1 and g
+                int g1 = std::min(std::max(i0, i1), r[k]);
+                for (int g = g0; g<=g1; g++) {
+                    double ti = (min_[k]+g*h[k]-p_[k])/(q_[k]-p_[k]);
+                    if (((ti-ta)*l>-eps) && ((tb-ti)*l>-eps)) { // within the domain
+                        t.push_back(ti);
+                    }
+                }
+            }
+        }
+        std::sort(t.begin(), t.end());
+        size_t j = 0;
+        double last = 0.;
+        for (double ti : t) {
+            if (((ti-last)*l>=eps) && ((1.-ti)*l>=eps)) {
+                t[j++] = ti;
+                last = ti;
+            }
+        }
+        t.resize(j);
+    }
+    for (size_t i=0; i<=t.size(); i++) { // cell of each piece, by its mid point
+        double t0 = (i>0) ? t[i-1] : 0.;
+        double t1 = (i<t.size()) ? t[i] : 1.;
+        Vector3d mid = p.plus(d.times(0.5*(t0+t1)));
+        cells.push_back(soil_index_(mid.x, mid.y, mid.z));
     }
 }
 
@@ -244,35 +455,20 @@ double MappedSegments::length(const Vector2i& s) const {
  */
 void MappedSegments::removeSegments(const std::vector<Vector2i>& segs) {
     for (auto& ns : segs) {
-        int cellIdx = -1;
         int segIdx = ns.y-1;
-        if (seg2cell.count(segIdx)>0) { // remove from seg2cell
-            cellIdx = seg2cell[segIdx];
-            auto it = seg2cell.find(segIdx);
-            seg2cell.erase(it);
+        if ((segIdx<int(seg2cell.size())) && (seg2cell[segIdx]>=0)) { // remove from seg2cell
+            seg2cell[segIdx] = -1;
         } else {
             throw std::invalid_argument("MappedSegments::removeSegments: warning segment index "+ std::to_string(segIdx)+ " was not found in the seg2cell mapper");
         }
-        if (cell2seg.count(cellIdx)>0) {
-            auto& csegs= cell2seg[cellIdx];
-            int c = 0;
-            for (int i=0; i<csegs.size(); i++) {
-                if (csegs[i] == segIdx) {
-                    csegs.erase(csegs.begin() + c, csegs.begin() + c);
-                    break; // inner for
-                }
-                c++;
-            }
-        } else {
-            throw std::invalid_argument("MappedSegments::removeSegments: warning cell index "+ std::to_string(cellIdx)+ " was not found in the cell2seg mapper");
-        }
     }
+    cell2segValid = false;
 }
 
 /**
  * Maps a point into a cell and return the cells linear index (for a equidistant rectangular domain)
  */
-int MappedSegments::soil_index_(double x, double y, double z) { // np.array([1, 3, 5])
+int MappedSegments::soil_index_(double x, double y, double z) const { // np.array([1, 3, 5])
     Vector3d p(x,y,z);
     std::array<double,3>  r = { resolution.x, resolution.y, resolution.z};
     auto w = maxBound.minus(minBound);
@@ -286,6 +482,23 @@ int MappedSegments::soil_index_(double x, double y, double z) { // np.array([1,
     return std::floor(i[2]) * r[0] * r[1] + std::floor(i[1]) * r[0] + std::floor(i[0]); // a linear index not periodic
 }
 
+/**
+ * Maps multiple points (x0,y0,z0,x1,...) into cells, with the same results as MappedSegments::soil_index_ per point
+ */
+void MappedSegments::soil_indices_(const std::vector<double>& xyz, std::vector<int>& cells) const {
+    size_t n = xyz.size()/3;
+    cells.resize(n);
+    std::array<double,3>  r = { resolution.x, resolution.y, resolution.z};
+    auto w = maxBound.minus(minBound);
+    for (size_t j=0; j<n; j++) {
+        double ix = (xyz[3*j]-minBound.x)/w.x*r[0];
+        double iy = (xyz[3*j+1]-minBound.y)/w.y*r[1];
+        double iz = (xyz[3*j+2]-minBound.z)/w.z*r[2];
+        bool out = (ix<0) || (ix>=r[0]) || (iy<0) || (iy>=r[1]) || (iz<0) || (iz>=r[2]); // point is out of domain
+        cells[j] = out ? -1 : int(std::floor(iz) * r[0] * r[1] + std::floor(iy) * r[0] + std::floor(ix)); // a linear index not periodic
+    }
+}
+
 /**
  * Sorts the segments, so that the segment index == second node index -1 (unique mapping in a tree)
  */
@@ -322,6 +535,11 @@ void MappedRootSystem::initializeLB(int basaltype, int shootbornetype, bool verb
     std::fill(radii.begin(), radii.end(), 0.1);
     types.resize(segments.size());
     std::fill(types.begin(), types.end(), 0);
+    nodeMap.resize(nodes.size());
+    std::iota(nodeMap.begin(), nodeMap.end(), 0);
+    cutNodes.clear();
+    firstNewNode = 0;
+    changedSegments.clear();
     mapSegments(segments);
 }
 
@@ -349,80 +567,163 @@ void MappedRootSystem::simulate(double dt, bool verbose)
 
     RootSystem::simulate(dt,verbose);
 
-    auto uni = this->getUpdatedNodeIndices(); // move nodes
-    auto unodes = this->getUpdatedNodes();
-    assert(uni.size()==unodes.size() && "updated node indices and number of nodes must be equal");
-    int c = 0;
+    const auto& ns = this->getNodeStore(); // all data is taken from the node store, no organ tree traversal
+    const auto& uni = updatedNodes; // move nodes
     for (int i : uni) {
-        nodes.at(i) = unodes[c];
-        c++;
+        int m = nodeMap.at(i);
+        nodes.at(m) = Vector3d(ns.x[i], ns.y[i], ns.z[i]);
+        nodeCTs.at(m) = ns.cts[i];
     }
     if (verbose) {
         std::cout << "nodes moved "<< uni.size() << "\n" << std::flush;
     }
-    auto newnodes = this->getNewNodes(); // add nodes
-    nodes.reserve(nodes.size()+newnodes.size());
-    for (auto& nn : newnodes) {
-        nodes.push_back(nn);
-    }
-    auto newnode_cts = this->getNewNodeCTs(); // add node cts
-    nodeCTs.reserve(nodeCTs.size()+newnode_cts.size());
-    for (auto& nct : newnode_cts) {
-        nodeCTs.push_back(nct);
+    int nn = this->getNumberOfNewNodes(); // add nodes and node cts
+    firstNewNode = nodes.size();
+    changedSegments.clear();
+    nodes.reserve(nodes.size()+nn);
+    nodeCTs.reserve(nodeCTs.size()+nn);
+    nodeMap.reserve(nodeMap.size()+nn);
+    for (int j = oldNumberOfNodes; j<oldNumberOfNodes+nn; j++) {
+        nodeMap.push_back(nodes.size());
+        nodes.push_back(Vector3d(ns.x[j], ns.y[j], ns.z[j]));
+        nodeCTs.push_back(ns.cts[j]);
     }
     if (verbose) {
-        std::cout << "new nodes added " << newnodes.size() << "\n" << std::flush;
+        std::cout << "new nodes added " << nn << "\n" << std::flush;
+    }
+    std::vector<Vector2i> newsegs; // add segments, radius and type
+    newsegs.reserve(nn);
+    for (int j = oldNumberOfNodes; j<oldNumberOfNodes+nn; j++) {
+        if (ns.prev[j]>=0) {
+            newsegs.push_back(Vector2i(nodeMap[ns.prev[j]], nodeMap[j]));
+        }
     }
-    auto newsegs = this->getNewSegments(); // add segments (TODO cutting)
     segments.resize(segments.size()+newsegs.size());
-    for (auto& ns : newsegs) {
-        segments[ns.y-1] = ns;
+    radii.resize(radii.size()+newsegs.size());
+    types.resize(types.size()+newsegs.size());
+    for (int j = oldNumberOfNodes; j<oldNumberOfNodes+nn; j++) {
+        if (ns.prev[j]>=0) {
+            int segIdx = nodeMap[j]-1;
+            segments[segIdx] = Vector2i(nodeMap[ns.prev[j]], nodeMap[j]);
+            radii[segIdx] = ns.radius[j];
+            types[segIdx] = ns.subType[j];
+        }
     }
-    if (verbose) {
-        std::cout << "segments added "<< newsegs.size() << "\n" << std::flush;
+    bool cutCells = rectangularGrid && isDefaultIndex(); // the cells of the pieces are known from cutting
+    std::vector<int> newCells, cells;
+    if (rectangularGrid) { // cut new segments
+        std::vector<Vector2i> pieces;
+        for (auto& s : newsegs) {
+            for (int si : cutSegment(s.y, cells)) {
+                pieces.push_back(segments[si]);
+            }
+            newCells.insert(newCells.end(), cells.begin(), cells.end());
+        }
+        newsegs = pieces;
     }
-    auto newsegO = this->getNewSegmentOrigins(); // to add radius and type (TODO cutting)
-    radii.resize(radii.size()+newsegO.size());
-    types.resize(types.size()+newsegO.size());
-    c = 0;
     if (verbose) {
-        std::cout << "Number of segments " << radii.size() << ", including " << newsegO.size() << " new \n"<< std::flush;
-    }
-    for (auto& so : newsegO) {
-        int segIdx = newsegs[c].y-1;
-        c++;
-        radii[segIdx] = so->getParam()->a;
-        types[segIdx] = so->getParam()->subType;
+        std::cout << "segments added "<< newsegs.size() << "\n" << std::flush;
+        std::cout << "Number of segments " << radii.size() << ", including " << newsegs.size() << " new \n"<< std::flush;
     }
     // map new segments
-    this->mapSegments(newsegs);
+    if (cutCells) {
+        this->mapSegments(newsegs, newCells);
+    } else {
+        this->mapSegments(newsegs);
+    }
 
     // update segments of moved nodes
-    std::vector<Vector2i> rSegs;
-    for (int i : uni) {
-        int segIdx = i -1;
-        int cellIdx = seg2cell[segIdx];
-        auto s = segments[segIdx];
-        Vector3d mid = (nodes[s.x].plus(nodes[s.y])).times(0.5);
-        int newCellIdx = soil_index(mid.x,mid.y,mid.z);
-        // 1. check if mid is still in same cell (otherwise, remove, and add again)
-        // 2. if cut is on, check if end point is in same cell than mid point (otherwise remove and add again)
-        bool remove = false;
-        if (cellIdx==newCellIdx) {
-            if (rectangularGrid) {
-                auto endPoint = nodes[s.y];
-                newCellIdx = soil_index(endPoint.x,endPoint.y,endPoint.z);
-                remove = (newCellIdx!=cellIdx);
+    std::vector<Vector2i> rSegs; // mapped segments to remove
+    std::vector<Vector2i> mSegs; // segments to map again
+    std::vector<int> mCells; // their cells, if known (cutCells, or not cut)
+    if (rectangularGrid) { // cut again, the pieces are mapped again
+        for (int i : uni) {
+            for (int si : cutSegment(nodeMap[i], cells)) {
+                mSegs.push_back(segments[si]);
+                if (si<firstNewNode-1) {
+                    changedSegments.push_back(si);
+                }
             }
-        } else {
-            remove = true;
+            mCells.insert(mCells.end(), cells.begin(), cells.end());
+        }
+    } else { // check if mid is still in same cell (otherwise, remove, and add again)
+        std::vector<double> mids; // all mids at once (@see MappedSegments::soilIndices)
+        mids.reserve(3*uni.size());
+        for (int i : uni) {
+            int segIdx = nodeMap[i]-1;
+            changedSegments.push_back(segIdx);
+            auto s = segments[segIdx];
+            Vector3d mid = (nodes[s.x].plus(nodes[s.y])).times(0.5);
+            mids.insert(mids.end(), { mid.x, mid.y, mid.z });
         }
-        if (remove) {
-            rSegs.push_back(s);
+        std::vector<int> movedCells;
+        soilIndices(mids, movedCells);
+        for (size_t k=0; k<uni.size(); k++) {
+            int segIdx = nodeMap[uni[k]]-1;
+            int cellIdx = (segIdx<int(seg2cell.size())) ? seg2cell[segIdx] : -1;
+            if (cellIdx!=movedCells[k]) {
+                auto s = segments[segIdx];
+                if (cellIdx>=0) {
+                    rSegs.push_back(s);
+                }
+                mSegs.push_back(s);
+                mCells.push_back(movedCells[k]);
+            }
         }
     }
     MappedSegments::removeSegments(rSegs);
-    MappedSegments::mapSegments(rSegs);
+    if (cutCells || !rectangularGrid) {
+        MappedSegments::mapSegments(mSegs, mCells);
+    } else {
+        MappedSegments::mapSegments(mSegs);
+    }
+}
+
+/**
+ * @copydoc Organism::writeCheckpoint
+ *
+ * The soil cell index call backs are not written, set them again after loading.
+ */
+void MappedRootSystem::writeCheckpoint(std::ostream& os) const
+{
+    RootSystem::writeCheckpoint(os);
+    Checkpoint::write(os, nodes);
+    Checkpoint::write(os, nodeCTs);
+    Checkpoint::write(os, segments);
+    Checkpoint::write(os, radii);
+    Checkpoint::write(os, types);
+    Checkpoint::write(os, seg2cell);
+    Checkpoint::write(os, minBound);
+    Checkpoint::write(os, maxBound);
+    Checkpoint::write(os, resolution);
+    Checkpoint::write(os, rectangularGrid);
+    Checkpoint::write(os, cutNodes);
+    Checkpoint::write(os, nodeMap);
+    Checkpoint::write(os, firstNewNode);
+    Checkpoint::write(os, changedSegments);
+}
+
+/**
+ * @copydoc Organism::readCheckpoint
+ */
+void MappedRootSystem::readCheckpoint(std::istream& is)
+{
+    RootSystem::readCheckpoint(is);
+    Checkpoint::read(is, nodes);
+    Checkpoint::read(is, nodeCTs);
+    Checkpoint::read(is, segments);
+    Checkpoint::read(is, radii);
+    Checkpoint::read(is, types);
+    Checkpoint::read(is, seg2cell);
+    Checkpoint::read(is, minBound);
+    Checkpoint::read(is, maxBound);
+    Checkpoint::read(is, resolution);
+    Checkpoint::read(is, rectangularGrid);
+    Checkpoint::read(is, cutNodes);
+    Checkpoint::read(is, nodeMap);
+    Checkpoint::read(is, firstNewNode);
+    Checkpoint::read(is, changedSegments);
+    cell2segValid = false;
 }
 
 } // namespace
@@ -32,17 +32,30 @@ public:
 
     void setSoilGrid(const std::function<int(double,double,double)>& s); ///< sets the soil, resets the mappers and maps all segments
     void setSoilGrid(const std::function<int(double,double,double)>& s, Vector3d min, Vector3d max, Vector3d res); ///< sets the soil, resets the mappers and maps all segments
+    void setSoilIndices(const std::function<void(const std::vector<double>&, std::vector<int>&)>& s); ///< sets a batch soil cell index call back, resets the mappers and maps all segments
     void setRectangularGrid(Vector3d min, Vector3d max, Vector3d res, bool cut = true); ///< sets an underlying rectangular grid, and cuts all segments accordingly
 
-    void mapSegments(const std::vector<Vector2i>& segs);
+    void mapSegments(const std::vector<Vector2i>& segs); ///< maps the segments by their mid points
+    void mapSegments(const std::vector<Vector2i>& segs, const std::vector<int>& cells); ///< maps the segments to known cells
     void cutSegments(); // cut and add segments
+    void cutGrid(const Vector3d& p, const Vector3d& q, std::vector<double>& t, std::vector<int>& cells) const; ///< cutting points of a segment at the rectangular grid
 
 
-    std::map<int, int> seg2cell; // root segment to soil cell mapper
-    std::map<int, std::vector<int>> cell2seg; // soil cell to root segment mapper
+    std::vector<int> seg2cell; // root segment to soil cell mapper, -1 if the segment is not mapped
+    std::vector<int> cell2segStart; // soil cell to root segment mapper in compressed row storage, see updateCell2Seg()
+    std::vector<int> cell2segs; // segments of cell c are cell2segs[cell2segStart[c]], ..., cell2segs[cell2segStart[c+1]-1]
+
+    void updateCell2Seg(); ///< rebuilds cell2segStart and cell2segs, if the mapping has changed
+    int getNumberOfCells() { updateCell2Seg(); return cell2segStart.size()-1; } ///< largest mapped cell index + 1
+    std::vector<int> getCellSegments(int cellIdx); ///< segment indices within the soil cell
+    const std::map<int, std::vector<int>>& getCell2Seg(); ///< soil cell to root segment mapper as hash map, rebuilt if the mapping has changed (for Python)
+    std::map<int, int> getSeg2Cell() const; ///< root segment to soil cell mapper as hash map, only mapped segments are keys (for Python)
+    void setSeg2Cell(const std::map<int, int>& map); ///< sets the root segment to soil cell mapper from a hash map (for Python)
 
     std::function<int(double,double,double)> soil_index =
         std::bind(&MappedSegments::soil_index_, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3); ///< soil cell index call back function, (care need all MPI ranks in case of dumux)
+    std::function<void(const std::vector<double>&, std::vector<int>&)> soil_indices = nullptr; ///< batch soil cell index call back, points (x0,y0,z0,x1,...) -> cells, used instead of soil_index if set
+    void soilIndices(const std::vector<double>& xyz, std::vector<int>& cells) const; ///< soil cell indices of multiple points (x0,y0,z0,x1,...)
 
     void sort(); ///< sorts segments, each segment belongs to position s.y-1
 
@@ -61,12 +74,22 @@ public:
 
 protected:
 
-    void addSegment(Vector2i ns, double radius,  int type, int i); // adds a single segment at index i, appends the rest if cutted
-    void add(Vector2i ns, double radius,  int type, int i); // adds without cutting, at index i, or appends if i = -1
+    std::vector<int> cutSegment(int m, std::vector<int>& cells); // cuts the segment ending at node m at the rectangular grid, returns the indices of the resulting segments and their cells
+    bool isCutNode(int i) const { return (i<int(cutNodes.size())) && cutNodes[i]; } // node was created by cutting
     double length(const Vector2i& s) const;
 
-    int soil_index_(double x, double y, double z); // default mapper to a equidistant rectangular grid
+    int soil_index_(double x, double y, double z) const; // default mapper to a equidistant rectangular grid
+    using DefaultIndex = decltype(std::bind(&MappedSegments::soil_index_, std::declval<MappedSegments*>(),
+        std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)); // type of the default soil_index
+    bool isDefaultIndex() const { return (!soil_indices) && (soil_index.target<DefaultIndex>()!=nullptr); } // soil_index is soil_index_, and there is no soil_indices
+    void soil_indices_(const std::vector<double>& xyz, std::vector<int>& cells) const; // default mapper for multiple points, without call back
     void removeSegments(const std::vector<Vector2i>& segs); ///< remove segments from the mappers
+    void clearMappers() { seg2cell.clear(); cell2segValid = false; } ///< unmaps all segments
+
+    bool cell2segValid = false; // cell2segStart and cell2segs agree with seg2cell
+    std::map<int, std::vector<int>> cell2segMap; // cache of getCell2Seg()
+    bool cell2segMapValid = false; // cell2segMap agrees with cell2segStart and cell2segs
+    std::vector<bool> cutNodes; // nodes created by cutting (@see isCutNode)
 
 };
 
@@ -88,10 +111,19 @@ public:
 
     /* segments are shoot and root segments */
 
+    std::vector<int> nodeMap; ///< node index of the organism -> node index of the mapped segments (they differ, if segments are cut)
+    int firstNewNode = 0; ///< nodes with index >= firstNewNode, and their segments (s.y-1) were added in the last time step
+    std::vector<int> changedSegments; ///< indices of the segments that existed before the last time step, and were moved or cut in it
+
 
     std::shared_ptr<MappedSegments> mappedSegments() { return std::make_shared<MappedSegments>(*this); }  // up-cast for Python binding
     std::shared_ptr<RootSystem> rootSystem() { return std::make_shared<RootSystem>(*this); }; // up-cast for Python binding
 
+protected:
+
+    void writeCheckpoint(std::ostream& os) const override; ///< additionally writes the mapped segments
+    void readCheckpoint(std::istream& is) override; ///< additionally reads the mapped segments
+
 };
 
 }
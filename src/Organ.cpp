@@ -5,6 +5,7 @@
 #include <iostream>
 
 #include "organparameter.h"
+#include "Checkpoint.h"
 
 namespace CPlantBox {
 
@@ -24,7 +25,7 @@ namespace CPlantBox {
  */
 Organ::Organ(int id, std::shared_ptr<const OrganSpecificParameter> param, bool alive, bool active,
 		double age, double length, Vector3d iheading, double pbl, int pni, bool moved, int oldNON)
-:iHeading(iheading), parentBaseLength(pbl), parentNI(pni), plant(), parent(), id(id), param_(param), alive(alive), active(active), age(age),
+:iHeading(iheading), parentBaseLength(pbl), parentNI(pni), plant(), parent(), id(id), randomKey(Philox::mix(0, id)), param_(param), alive(alive), active(active), age(age),
  length(length), moved(moved), oldNumberOfNodes(oldNON)
 { }
 
@@ -33,6 +34,8 @@ Organ::Organ(int id, std::shared_ptr<const OrganSpecificParameter> param, bool a
  * The organ parameters are chosen from random distributions within the the OrganTypeParameter class.
  * The next organ id is retrieved from the plant,
  * and the organ starts growing after a delay (starts with age = -delay).
+ * The random key is derived from the parent's key and the child index,
+ * i.e. it does not depend on the order of creation.
  *
  * @param plant     the plant the new organ will be part of
  * @param parent    the parent organ, equals nullptr if there is no parent
@@ -43,8 +46,11 @@ Organ::Organ(int id, std::shared_ptr<const OrganSpecificParameter> param, bool a
 Organ::Organ(std::shared_ptr<Organism> plant, std::shared_ptr<Organ>  parent, int ot, int st, double delay,
 		Vector3d iheading, double pbl, int pni)
 :iHeading(iheading), parentBaseLength(pbl), parentNI(pni), plant(plant), parent(parent), id(plant->getOrganIndex()),
-  param_(plant->getOrganRandomParameter(ot, st)->realize()), age(-delay)
-{ }
+  randomKey(parent ? Philox::mix(parent->randomKey, parent->children.size()) : Philox::mix(0, id)), age(-delay)
+{
+	Organism::RandomScope scope(randomKey, 0, Organism::rp_parameter);
+	param_ = plant->getOrganRandomParameter(ot, st)->realize();
+}
 
 /*
  * Deep copies this organ into the new plant @param plant.
@@ -66,6 +72,26 @@ std::shared_ptr<Organ> Organ::copy(std::shared_ptr<Organism>  p)
 	return o;
 }
 
+/*
+ * Copies this organ into the new plant @param plant, for scenario branching (@see Organism::fork).
+ * In contrast to Organ::copy the specific parameters are shared, and the node data is shared
+ * until the organ changes in one of the plants.
+ *
+ * @param plant     the plant the copied organ will be part of
+ * @return          the newly created copy (ownership is passed)
+ */
+std::shared_ptr<Organ> Organ::fork(std::shared_ptr<Organism>  p)
+{
+	auto o = std::make_shared<Organ>(*this); // shallow copy, shares parameters and node data
+	o->parent = std::weak_ptr<Organ>();
+	o->plant = p;
+	for (size_t i=0; i< children.size(); i++) {
+		o->children[i] = children[i]->fork(p); // fork lateral
+		o->children[i]->setParent(o);
+	}
+	return o;
+}
+
 /**
  * @return The organ type, which is a coarse classification of the organs.
  * Currently there are: ot_organ (for unspecified organs) = 0, ot_seed = 1, ot_root = 2, ot_stem = 3, and ot_leaf = 4.
@@ -115,6 +141,28 @@ void Organ::addChild(std::shared_ptr<Organ> c)
 {
 	c->setParent(shared_from_this());
 	children.push_back(c);
+	auto p = plant.lock();
+	if (p) {
+		p->organsChanged();
+	}
+}
+
+/**
+ * Renumbers the organ id and the global node indices of this organ and its subtree
+ * (used by Organism::simulate to replace temporary ids after a parallel simulation)
+ *
+ * @param organMap      maps an old to a new organ id
+ * @param nodeMap       maps an old to a new node index
+ */
+void Organ::remapIds(const std::function<int(int)>& organMap, const std::function<int(int)>& nodeMap)
+{
+	id = organMap(id);
+	for (auto& ni : nodeIds.modify()) {
+		ni = nodeMap(ni);
+	}
+	for (auto& c : children) {
+		c->remapIds(organMap, nodeMap);
+	}
 }
 
 /**
@@ -143,7 +191,24 @@ void Organ::addNode(Vector3d n, int id, double t)
  */
 void Organ::addNode(Vector3d n, double t)
 {
-	addNode(n,plant.lock()->getNodeIndex(),t);
+	auto p = plant.lock();
+	addNode(n,p->getNodeIndex(),t);
+	p->storeNode(*this, nodes.size()-1);
+}
+
+/**
+ * Moves an existing node, and marks the organ as moved (@see Organism::getUpdatedNodeIndices)
+ *
+ * @param i        local node index
+ * @param n        new coordinates of the node
+ * @param t        new creation time of the node
+ */
+void Organ::moveNode(int i, Vector3d n, double t)
+{
+	nodes.modify().at(i) = n;
+	nodeCTs.modify().at(i) = t;
+	moved = true;
+	plant.lock()->updateNode(*this, i);
 }
 
 /**
@@ -321,6 +386,77 @@ void Organ::writeRSML(tinyxml2::XMLDocument& doc, tinyxml2::XMLElement* parent)
 	}
 }
 
+/**
+ * Writes the state of the organ, and recursively of its children into a binary checkpoint (@see Organism::saveCheckpoint).
+ * Each child is preceded by its class (@see Organ::checkpointClass).
+ *
+ * Overwrite, if a derived class has additional state.
+ *
+ * @param os        binary output stream
+ */
+void Organ::writeCheckpoint(std::ostream& os) const
+{
+	Checkpoint::write(os, id);
+	Checkpoint::write(os, randomKey);
+	param_->writeCheckpoint(os);
+	Checkpoint::write(os, alive);
+	Checkpoint::write(os, active);
+	Checkpoint::write(os, age);
+	Checkpoint::write(os, length);
+	Checkpoint::write(os, iHeading);
+	Checkpoint::write(os, parentBaseLength);
+	Checkpoint::write(os, parentNI);
+	Checkpoint::write(os, insertionAngle);
+	Checkpoint::write(os, nodes);
+	Checkpoint::write(os, nodeIds);
+	Checkpoint::write(os, nodeCTs);
+	Checkpoint::write(os, moved);
+	Checkpoint::write(os, oldNumberOfNodes);
+	Checkpoint::write(os, uint64_t(children.size()));
+	for (const auto& c : children) {
+		Checkpoint::write(os, c->checkpointClass());
+		c->writeCheckpoint(os);
+	}
+}
+
+/**
+ * Reads the state of the organ, and creates its children from a binary checkpoint (@see Organism::loadCheckpoint).
+ * The organ must be created with a specific parameter of the right class (@see Checkpoint::createOrgan).
+ *
+ * @param is        binary input stream
+ * @param plant     the plant the organ is part of
+ */
+void Organ::readCheckpoint(std::istream& is, std::shared_ptr<Organism> plant)
+{
+	this->plant = plant;
+	Checkpoint::read(is, id);
+	Checkpoint::read(is, randomKey);
+	std::const_pointer_cast<OrganSpecificParameter>(param_)->readCheckpoint(is);
+	Checkpoint::read(is, alive);
+	Checkpoint::read(is, active);
+	Checkpoint::read(is, age);
+	Checkpoint::read(is, length);
+	Checkpoint::read(is, iHeading);
+	Checkpoint::read(is, parentBaseLength);
+	Checkpoint::read(is, parentNI);
+	Checkpoint::read(is, insertionAngle);
+	Checkpoint::read(is, nodes);
+	Checkpoint::read(is, nodeIds);
+	Checkpoint::read(is, nodeCTs);
+	Checkpoint::read(is, moved);
+	Checkpoint::read(is, oldNumberOfNodes);
+	uint64_t n;
+	Checkpoint::read(is, n);
+	children.clear();
+	for (uint64_t i=0; i<n; i++) {
+		int oc;
+		Checkpoint::read(is, oc);
+		auto c = Checkpoint::createOrgan(oc);
+		c->readCheckpoint(is, plant);
+		addChild(c);
+	}
+}
+
 /**
  * @return Quick info about the object for debugging,
  * additionally, use getParam()->toString() and getOrganRandomParameter()->toString() to obtain all information.
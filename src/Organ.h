@@ -3,13 +3,17 @@
 #define ORGAN_H_
 
 #include "mymath.h"
+#include "SharedVector.h"
 
 #include "external/tinyxml2/tinyxml2.h"
 
 #include <vector>
 #include <memory>
+#include <istream>
+#include <ostream>
 #include <functional>
 #include <map>
+#include <cstdint>
 
 namespace CPlantBox {
 
@@ -41,8 +45,10 @@ public:
     virtual ~Organ() { }
 
     virtual std::shared_ptr<Organ> copy(std::shared_ptr<Organism> plant); ///< deep copies the organ tree
+    virtual std::shared_ptr<Organ> fork(std::shared_ptr<Organism> plant); ///< copies the organ tree, sharing parameters and node data (@see Organism::fork)
 
     virtual int organType() const; ///< returns the organs type, overwrite for each organ
+    virtual int checkpointClass() const { return organType(); } ///< class of the organ in a checkpoint (@see Checkpoint::OrganClasses)
 
     /* development */
     virtual void simulate(double dt, bool verbose = false); ///< grow for a time span of @param dt
@@ -55,9 +61,11 @@ public:
     void addChild(std::shared_ptr<Organ> c); ///< adds an subsequent organ
     int getNumberOfChildren() { return children.size(); } ///< number of children
     std::shared_ptr<Organ> getChild(int i) { return children.at(i); } /// child with index @param i
+    void remapIds(const std::function<int(int)>& organMap, const std::function<int(int)>& nodeMap); ///< renumbers organ and node ids of the organ tree
 
     /* parameters */
     int getId() const { return id; } ///< unique organ id
+    uint64_t getRandomKey() const { return randomKey; } ///< key of the organ's counter based random numbers, derived from its position in the organ tree
     std::shared_ptr<const OrganSpecificParameter> getParam() const { return param_; } ///< organ parameters
     std::shared_ptr<OrganRandomParameter> getOrganRandomParameter() const;  ///< organ type parameter
     bool isAlive() const { return alive; } ///< checks if alive
@@ -73,6 +81,7 @@ public:
     double getNodeCT(int i) const { return nodeCTs.at(i); } ///< creation time of the i-th node
     void addNode(Vector3d n, double t); //< adds a node to the root
     void addNode(Vector3d n, int id, double t); //< adds a node to the root
+    void moveNode(int i, Vector3d n, double t); ///< moves the i-th node (e.g. to axial resolution)
     std::vector<Vector2i> getSegments() const; ///< per default, the organ is represented by a polyline
 
     /* last time step */
@@ -87,6 +96,8 @@ public:
     /* IO */
     virtual std::string toString() const; ///< info for debugging
     void writeRSML(tinyxml2::XMLDocument& doc, tinyxml2::XMLElement* parent) const; ///< writes this organs RSML tag
+    virtual void writeCheckpoint(std::ostream& os) const; ///< writes the organ tree into a binary checkpoint
+    virtual void readCheckpoint(std::istream& is, std::shared_ptr<Organism> plant); ///< reads the organ tree from a binary checkpoint
 
     /* Parameters that are constant over the organ life time*/
     Vector3d iHeading; ///< the initial heading of the root, when it was created
@@ -102,7 +113,8 @@ protected:
     std::vector<std::shared_ptr<Organ>> children; ///< the successive organs
 
     /* Parameters that are constant over the organ life time */
-    const int id; ///< unique organ id
+    int id; ///< unique organ id (only changed by Organ::remapIds)
+    uint64_t randomKey; ///< key of the organ's counter based random numbers (@see Organism::RandomScope)
     std::shared_ptr<const OrganSpecificParameter> param_; ///< the parameter set of this organ (@see getParam())
 
     /* Parameters are changing over time */
@@ -111,10 +123,10 @@ protected:
     double age = 0; ///< current age [days]
     double length = 0; ///< length of the organ [cm]
 
-    /* node data */
-    std::vector<Vector3d> nodes; ///< nodes of the organ [cm]
-    std::vector<int> nodeIds; ///< global node indices
-    std::vector<double> nodeCTs; ///< node creation times [days]
+    /* node data, copied on write (@see Organism::fork) */
+    SharedVector<Vector3d> nodes; ///< nodes of the organ [cm]
+    SharedVector<int> nodeIds; ///< global node indices
+    SharedVector<double> nodeCTs; ///< node creation times [days]
 
     /* last time step */
     bool moved = false; ///< nodes moved during last time step
@@ -3,16 +3,42 @@
 
 #include "Organ.h"
 #include "organparameter.h"
+#include "Checkpoint.h"
 
 #include <stdexcept>
 #include <iostream>
 #include <ctime>
 #include <numeric>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <exception>
+#include <cstring>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <typeinfo>
 
 namespace CPlantBox {
 
 std::vector<std::string> Organism::organTypeNames = { "organ", "seed", "root", "stem", "leaf" };
 int Organism::instances = 0; // number of instances
+thread_local Organism::SimulationTask* Organism::task = nullptr;
+thread_local Organism::RandomScope* Organism::scope = nullptr;
+
+/**
+ * A base organ subtree that is simulated by one worker thread (@see Organism::simulateParallel).
+ * Organ and node ids are handed out as temporary (negative) ids, local to the task,
+ * that are renumbered after all tasks are finished.
+ */
+struct Organism::SimulationTask {
+    int index = 0; ///< index of the base organ
+    int numberOfTasks = 1; ///< number of base organs
+    int organs = 0; ///< number of organ ids handed out by this task
+    int nodes = 0; ///< number of node ids handed out by this task
+    int tempId(int local) const { return -2-(local*numberOfTasks+index); } ///< temporary id (< -1) of the local index
+};
 
 /**
  * Constructs organism, initializes random number generator
@@ -21,7 +47,8 @@ Organism::Organism()
 {
     instances++;
     auto seed = std::chrono::system_clock::now().time_since_epoch().count()+instances;
-    gen = std::mt19937(seed);
+    seed_ = (unsigned int)seed;
+    gen = std::mt19937(seed_);
 };
 
 
@@ -68,6 +95,30 @@ std::shared_ptr<Organism> Organism::copy()
     return no;
 }
 
+/**
+ * Copies the organism for scenario branching, e.g. to continue a simulation with different soils, tropisms, or carbon limits.
+ *
+ * In contrast to Organism::copy, the organs share their (immutable) specific parameters with the original organs,
+ * and the node data of the organs and of the node store is shared until it changes in one of the organisms,
+ * i.e. memory and time of many forks are close to a single organism plus the organs that grow after forking.
+ * The organ random parameters are copied, and can be changed independently.
+ *
+ * @return the forked organism
+ */
+std::shared_ptr<Organism> Organism::fork()
+{
+    auto no = std::make_shared<Organism>(*this); // copy constructor, shares the node store
+    for (size_t i = 0; i < baseOrgans.size(); i++) {
+        no->baseOrgans[i] = baseOrgans[i]->fork(no);
+    }
+    for (int ot = 0; ot < numberOfOrganTypes; ot++) { // copy organ type parameters
+        for (auto& otp : no->organParam[ot]) {
+            otp.second = otp.second->copy(no);
+        }
+    }
+    return no;
+}
+
 /**
  * Copies the organ random parameters of all sub types of one specific organ type into a vector
  *
@@ -157,14 +208,122 @@ void Organism::simulate(double dt, bool verbose)
     }
     oldNumberOfNodes = getNumberOfNodes();
     oldNumberOfOrgans = getNumberOfOrgans();
-    for (const auto& r : baseOrgans) {
-        r->simulate(dt, verbose);
+    updatedNodes.clear();
+    if (numberOfThreads>0) {
+        simulateParallel(dt, verbose);
+    } else {
+        for (const auto& r : baseOrgans) {
+            r->simulate(dt, verbose);
+        }
     }
     simtime+=dt;
 }
 
+/**
+ * Sets the number of threads used by Organism::simulate.
+ *
+ * For n>0 all organ random numbers are counter based, i.e. a function of (seed, organ key, index, purpose)
+ * (@see Organism::RandomScope), the base organs are simulated in parallel, and new organ and node ids are renumbered
+ * in the order of the base organs. Therefore, the results are identical for a fixed seed,
+ * regardless of the number of threads. They differ from the sequential simulation (n=0),
+ * where all organs share a single random generator.
+ *
+ * Python derived tropisms or soil look ups need n<=1, since the calling thread holds the GIL.
+ *
+ * @param n         number of threads, 0 for the sequential simulation (default)
+ */
+void Organism::setNumberOfThreads(int n)
+{
+    if (n<0) {
+        throw std::invalid_argument("Organism::setNumberOfThreads: number of threads must be >= 0");
+    }
+    numberOfThreads = n;
+}
+
+/**
+ * Simulates the base organs in parallel, called by Organism::simulate if Organism::numberOfThreads > 0.
+ * The threads take the next base organ from a shared counter, the calling thread takes part.
+ * Afterwards the temporary ids are renumbered deterministically, i.e. in the order of the base organs,
+ * and within a base organ in the order of creation.
+ *
+ * @param dt        time step [day]
+ * @param verbose   turns console output on or off
+ */
+void Organism::simulateParallel(double dt, bool verbose)
+{
+    const int n = baseOrgans.size();
+    std::vector<SimulationTask> tasks(n);
+    for (int i=0; i<n; i++) {
+        tasks[i].index = i;
+        tasks[i].numberOfTasks = n;
+    }
+
+    std::atomic<int> next(0);
+    std::exception_ptr error = nullptr;
+    std::mutex errorMutex;
+    auto worker = [&]() {
+        int i;
+        while ((i = next++) < n) {
+            task = &tasks[i];
+            try {
+                RandomScope rs(baseOrgans[i]->getRandomKey(), hashIndex(simtime), rp_default); // for draws outside of organ scopes
+                baseOrgans[i]->simulate(dt, verbose);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+            task = nullptr;
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int t=1; t<std::min(numberOfThreads, n); t++) {
+        threads.push_back(std::thread(worker));
+    }
+    worker();
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    // deterministic renumbering
+    std::vector<int> organOffset(n), nodeOffset(n);
+    int no = organId+1, nn = nodeId+1;
+    for (int i=0; i<n; i++) {
+        organOffset[i] = no;
+        nodeOffset[i] = nn;
+        no += tasks[i].organs;
+        nn += tasks[i].nodes;
+    }
+    auto organMap = [&](int id) {
+        if (id>=-1) {
+            return id;
+        }
+        int v = -2-id;
+        return organOffset[v%n]+v/n;
+    };
+    auto nodeMap = [&](int id) {
+        if (id>=-1) {
+            return id;
+        }
+        int v = -2-id;
+        return nodeOffset[v%n]+v/n;
+    };
+    for (const auto& o : baseOrgans) {
+        o->remapIds(organMap, nodeMap);
+    }
+    organId = no-1;
+    nodeId = nn-1;
+    storeNodes(oldNumberOfNodes); // the tasks do not write into the node store
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
 /**
  * Creates a sequential list of organs. Considers only organs with more than 1 node.
+ * The list is taken from a cache, that is only rebuilt if the organ tree has changed (@see OrganRegistry).
  *
  * @param ot        the expected organ type, where -1 denotes all organ types (default).
  * @return Sequential list of organs. If there is less than one node,
@@ -172,15 +331,70 @@ void Organism::simulate(double dt, bool verbose)
  */
 std::vector<std::shared_ptr<Organ>> Organism::getOrgans(int ot) const
 {
+    const auto& r = organRegistry();
     auto organs = std::vector<std::shared_ptr<Organ>>(0);
-    // std::cout << "Organism::getOrgans: getNumberOfOrgans() " << getNumberOfOrgans() << "\n" << std::flush;
-    organs.reserve(getNumberOfOrgans()); // just for speed up
-    for (const auto& o : this->baseOrgans) {
-        o->getOrgans(ot, organs);
+    if (ot<0) {
+        organs.reserve(r.organs.size());
+        for (const auto& o : r.organs) {
+            if (o->getNumberOfNodes()>1) {
+                organs.push_back(o);
+            }
+        }
+    } else if (ot<int(r.byType.size())) {
+        organs.reserve(r.byType[ot].size());
+        for (int i : r.byType[ot]) {
+            if (r.organs[i]->getNumberOfNodes()>1) {
+                organs.push_back(r.organs[i]);
+            }
+        }
     }
     return organs;
 }
 
+/**
+ * Marks the cached organ list as outdated, must be called after changes of the organ tree
+ * that do not create new organs (e.g. adding or removing existing organs).
+ * Within a parallel simulation nothing happens, since the ids of new organs are counted afterwards.
+ */
+void Organism::organsChanged()
+{
+    if (task==nullptr) {
+        registry.valid = false;
+    }
+}
+
+/**
+ * Returns the cached organ list, it is rebuilt by a depth first traversal of the organ tree,
+ * if organs were created since the last build, or Organism::organsChanged was called.
+ *
+ * The cache is not thread safe, i.e. do not call getters of the same organism from multiple threads.
+ */
+const OrganRegistry& Organism::organRegistry() const
+{
+    if (registry.valid && (registry.organId==organId)) {
+        return registry;
+    }
+    registry.clear();
+    registry.organs.reserve(getNumberOfOrgans());
+    registry.byType.resize(numberOfOrganTypes);
+    std::vector<std::shared_ptr<Organ>> stack(baseOrgans.rbegin(), baseOrgans.rend());
+    while (!stack.empty()) { // pre order, children in order of creation
+        auto o = stack.back();
+        stack.pop_back();
+        int ot = o->organType();
+        if ((ot>=0) && (ot<numberOfOrganTypes)) {
+            registry.byType[ot].push_back(registry.organs.size());
+        }
+        registry.organs.push_back(o);
+        for (int i = o->getNumberOfChildren()-1; i>=0; i--) {
+            stack.push_back(o->getChild(i));
+        }
+    }
+    registry.organId = organId;
+    registry.valid = true;
+    return registry;
+}
+
 /**
  * Returns a single scalar parameter for each organ as sequential list,
  * corresponding to the sequential organ list, see Organism::getOrgans.
@@ -226,9 +440,10 @@ double Organism::getSummed(std::string name, int ot) const
 int Organism::getNumberOfSegments(int ot) const
 {
     int s=0;
-    auto organs = getOrgans(ot);
-    for (const auto& o : organs) {
-        s += o->getNumberOfSegments();
+    for (size_t j=0; j<nodeStore.size(); j++) {
+        if ((nodeStore.prev[j]>=0) && ((ot<0) || (nodeStore.organType[j]==ot))) {
+            s++;
+        }
     }
     return s;
 }
@@ -274,28 +489,22 @@ std::vector<std::vector<double>> Organism::getPolylineCTs(int ot) const
 }
 
 /**
- * All nodes of emerged organs are ordered by their node index,
- * initial nodes of base organs are copied, even if not emerged.
+ * All nodes ordered by their node index, copied from the node store (@see Organism::getNodeStore),
+ * initial nodes of base organs are included, even if not emerged.
  *
  * @return          a vector of nodes
  */
 std::vector<Vector3d> Organism::getNodes() const
 {
-    auto organs = getOrgans();
-    std::vector<Vector3d> nv = std::vector<Vector3d>(getNumberOfNodes()); // reserve big enough vector
-    for (const auto& o : baseOrgans) { // copy initial nodes (even if organs have not developed)
-        nv.at(o->getNodeId(0)) = o->getNode(0);
-    }
-    for (const auto& o : organs) { // copy all organ nodes
-        for (size_t i = 1; i<o->getNumberOfNodes(); i++) { // since all base nodes are stored twice as base and along root
-            nv.at(o->getNodeId(i)) = o->getNode(i);
-        }
+    std::vector<Vector3d> nv(nodeStore.size());
+    for (size_t j=0; j<nv.size(); j++) {
+        nv[j] = Vector3d(nodeStore.x[j], nodeStore.y[j], nodeStore.z[j]);
     }
     return nv;
 }
 
 /**
- * The organim's node creation times of a specific organ type corresponding to Organism::getNodes.
+ * The organim's node creation times corresponding to Organism::getNodes.
  *
  * At a branching point, there are two creation times attached to one node,
  * the creation time of the base node, and the emergence time of the lateral root.
@@ -305,36 +514,25 @@ std::vector<Vector3d> Organism::getNodes() const
  */
 std::vector<double> Organism::getNodeCTs() const
 {
-    auto organs = getOrgans();
-    std::vector<double> cts = std::vector<double>(getNumberOfNodes()); // reserve big enough vector
-    for (const auto& o : baseOrgans) { // copy initial nodes (even if organs have not developed)
-        cts.at(o->getNodeId(0)) = o->getNodeCT(0);
-    }
-    for (const auto& o : organs) { // copy all organ creation times
-        for (size_t i=1; i<o->getNumberOfNodes(); i++) {
-            // we start at 1 because we don't copy the emergence time of the lateral root
-            cts.at(o->getNodeId(i)) = o->getNodeCT(i);
-        }
-    }
-    return cts;
+    return nodeStore.cts;
 }
 
 /**
  * The line segments of the organism, each segment consisting of two node indices,
- * corresponding to the node list Organism::getNode(-1),
- * or the node indices from Organism::getNodeId(ot).
+ * corresponding to the node list Organism::getNodes().
+ * The segments are ordered by the index of their second node, i.e. by their creation.
  *
  * @param ot        the expected organ type, where -1 denotes all organ types (default)
  * @return          line segments
  */
 std::vector<Vector2i> Organism::getSegments(int ot) const
 {
-    auto organs = getOrgans(ot);
-    std::vector<Vector2i> segs = std::vector<Vector2i>(0);
-    segs.reserve(this->getNumberOfSegments(ot)); // for speed up
-    for (const auto& o : organs) {
-        auto s = o->getSegments();
-        segs.insert(segs.end(), s.begin(), s.end()); // append s; todo check if it works..
+    std::vector<Vector2i> segs;
+    segs.reserve(nodeStore.size());
+    for (size_t j=0; j<nodeStore.size(); j++) {
+        if ((nodeStore.prev[j]>=0) && ((ot<0) || (nodeStore.organType[j]==ot))) {
+            segs.push_back(Vector2i(nodeStore.prev[j], j));
+        }
     }
     return segs;
 }
@@ -348,11 +546,12 @@ std::vector<Vector2i> Organism::getSegments(int ot) const
  */
 std::vector<double> Organism::getSegmentCTs(int ot) const
 {
-    auto nodeCT = getNodeCTs(); // of all nodes (otherwise indices are tricky)
-    auto segs = getSegments(ot);
-    std::vector<double> cts = std::vector<double>(segs.size());
-    for (int i=0; i<cts.size(); i++) {
-        cts[i] = nodeCT[segs[i].y]; // segment creation time is the node creation time of the second node
+    std::vector<double> cts;
+    cts.reserve(nodeStore.size());
+    for (size_t j=0; j<nodeStore.size(); j++) {
+        if ((nodeStore.prev[j]>=0) && ((ot<0) || (nodeStore.organType[j]==ot))) {
+            cts.push_back(nodeStore.cts[j]); // segment creation time is the node creation time of the second node
+        }
     }
     return cts;
 }
@@ -361,20 +560,19 @@ std::vector<double> Organism::getSegmentCTs(int ot) const
  * A vector of pointers to the organs containing each segment, corresponding to Organism::getSegments.
  *
  * @param ot        the expected organ type, where -1 denotes all organ types (default)
- * @return          creation times of each segment
+ * @return          the organ of each segment
  */
 std::vector<std::shared_ptr<Organ>> Organism::getSegmentOrigins(int ot) const
 {
-    auto organs = getOrgans(ot);
-    auto segs = std::vector<std::shared_ptr<Organ>>(0);
-    segs.reserve(this->getNumberOfSegments(ot)); // for speed up
-    for (const auto& o : organs) {
-        auto s = o->getSegments();
-        for (int i=0; i<s.size(); i++) {
-            segs.push_back(o);
+    auto organs = organsById();
+    std::vector<std::shared_ptr<Organ>> so;
+    so.reserve(nodeStore.size());
+    for (size_t j=0; j<nodeStore.size(); j++) {
+        if ((nodeStore.prev[j]>=0) && ((ot<0) || (nodeStore.organType[j]==ot))) {
+            so.push_back(organs.at(nodeStore.organId[j]));
         }
     }
-    return segs;
+    return so;
 }
 
 /**
@@ -384,14 +582,7 @@ std::vector<std::shared_ptr<Organ>> Organism::getSegmentOrigins(int ot) const
  */
 std::vector<int> Organism::getUpdatedNodeIndices() const
 {
-    auto organs = this->getOrgans();
-    std::vector<int> ni = std::vector<int>(0);
-    for (const auto& o : organs) {
-        if (o->hasMoved()) {
-            ni.push_back(o->getNodeId(o->getOldNumberOfNodes()-1));
-        }
-    }
-    return ni;
+    return updatedNodes;
 }
 
 /**
@@ -400,12 +591,10 @@ std::vector<int> Organism::getUpdatedNodeIndices() const
  */
 std::vector<Vector3d> Organism::getUpdatedNodes() const
 {
-    auto organs = this->getOrgans();
-    std::vector<Vector3d> nv = std::vector<Vector3d>(0);
-    for (const auto& o : organs) {
-        if (o->hasMoved()) {
-            nv.push_back(o->getNode(o->getOldNumberOfNodes()-1));
-        }
+    std::vector<Vector3d> nv(updatedNodes.size());
+    for (size_t i=0; i<nv.size(); i++) {
+        int j = updatedNodes[i];
+        nv[i] = Vector3d(nodeStore.x[j], nodeStore.y[j], nodeStore.z[j]);
     }
     return nv;
 }
@@ -416,12 +605,9 @@ std::vector<Vector3d> Organism::getUpdatedNodes() const
  */
 std::vector<double> Organism::getUpdatedNodeCTs() const
 {
-    auto organs = this->getOrgans();
-    std::vector<double> nv = std::vector<double>(0);
-    for (const auto& o : organs) {
-        if (o->hasMoved()) {
-            nv.push_back(o->getNodeCT(o->getOldNumberOfNodes()-1));
-        }
+    std::vector<double> nv(updatedNodes.size());
+    for (size_t i=0; i<nv.size(); i++) {
+        nv[i] = nodeStore.cts[updatedNodes[i]];
     }
     return nv;
 }
@@ -432,13 +618,10 @@ std::vector<double> Organism::getUpdatedNodeCTs() const
  */
 std::vector<Vector3d> Organism::getNewNodes() const
 {
-    auto organs = this->getOrgans();
     std::vector<Vector3d> nv(this->getNumberOfNewNodes());
-    for (const auto& o : organs) {
-        int onon = o->getOldNumberOfNodes();
-        for (size_t i=onon; i<o->getNumberOfNodes(); i++) { // loop over all new nodes
-            nv.at(o->getNodeId(i)-this->oldNumberOfNodes) = o->getNode(i);
-        }
+    for (size_t i=0; i<nv.size(); i++) {
+        int j = oldNumberOfNodes+i;
+        nv[i] = Vector3d(nodeStore.x[j], nodeStore.y[j], nodeStore.z[j]);
     }
     return nv;
 }
@@ -451,18 +634,7 @@ std::vector<Vector3d> Organism::getNewNodes() const
  */
 std::vector<double> Organism::getNewNodeCTs() const
 {
-    auto organs = this->getOrgans();
-    std::vector<double> nv(this->getNumberOfNewNodes());
-    for (const auto& o : organs) {
-        int onon = o->getOldNumberOfNodes();
-        if (onon==0) { // make sure to never copy the root emergence time
-            onon = 1;
-        }
-        for (size_t i=onon; i<o->getNumberOfNodes(); i++) { // loop over all new nodes
-            nv.at(o->getNodeId(i)-this->oldNumberOfNodes) = o->getNodeCT(i);
-        }
-    }
-    return nv;
+    return std::vector<double>(nodeStore.cts.begin()+oldNumberOfNodes, nodeStore.cts.end());
 }
 
 /**
@@ -473,14 +645,11 @@ std::vector<double> Organism::getNewNodeCTs() const
  */
 std::vector<Vector2i> Organism::getNewSegments(int ot) const
 {
-    auto organs = this->getOrgans(ot);
-    std::vector<Vector2i> si = std::vector<Vector2i>(0);
+    std::vector<Vector2i> si;
     si.reserve(this->getNumberOfNewNodes());
-    for (const auto& o :organs) {
-        int onon = o->getOldNumberOfNodes();
-        for (size_t i=onon-1; i<o->getNumberOfNodes()-1; i++) { // loop over new segments
-            Vector2i v(o->getNodeId(i),o->getNodeId(i+1));
-            si.push_back(v);
+    for (size_t j=oldNumberOfNodes; j<nodeStore.size(); j++) {
+        if ((nodeStore.prev[j]>=0) && ((ot<0) || (nodeStore.organType[j]==ot))) {
+            si.push_back(Vector2i(nodeStore.prev[j], j));
         }
     }
     return si;
@@ -496,17 +665,100 @@ std::vector<Vector2i> Organism::getNewSegments(int ot) const
  */
 std::vector<std::shared_ptr<Organ>> Organism::getNewSegmentOrigins(int ot) const
 {
-    auto organs = this->getOrgans(ot);
+    auto organs = organsById();
     std::vector<std::shared_ptr<Organ>> so;
-    for (auto& o :organs) {
-        int onon = o->getOldNumberOfNodes();
-        for (size_t i=onon-1; i<o->getNumberOfNodes()-1; i++) { // loop over new segments
-            so.push_back(o);
+    so.reserve(this->getNumberOfNewNodes());
+    for (size_t j=oldNumberOfNodes; j<nodeStore.size(); j++) {
+        if ((nodeStore.prev[j]>=0) && ((ot<0) || (nodeStore.organType[j]==ot))) {
+            so.push_back(organs.at(nodeStore.organId[j]));
         }
     }
     return so;
 }
 
+/**
+ * Writes the i-th node of organ @param o into the node store, together with its segment [o->getNodeId(i-1), o->getNodeId(i)].
+ * Within a parallel simulation nothing is written, the nodes are stored after the renumbering (@see Organism::storeNodes).
+ *
+ * @param o         the organ containing the node
+ * @param i         local node index
+ */
+void Organism::storeNode(const Organ& o, int i)
+{
+    if (task!=nullptr) {
+        return;
+    }
+    int j = o.getNodeId(i);
+    if (j>=int(nodeStore.size())) {
+        nodeStore.resize(j+1);
+    }
+    Vector3d n = o.getNode(i);
+    nodeStore.x.modify()[j] = n.x;
+    nodeStore.y.modify()[j] = n.y;
+    nodeStore.z.modify()[j] = n.z;
+    nodeStore.cts.modify()[j] = o.getNodeCT(i);
+    nodeStore.prev.modify()[j] = (i>0) ? o.getNodeId(i-1) : -1;
+    nodeStore.organId.modify()[j] = o.getId();
+    nodeStore.organType.modify()[j] = o.organType();
+    auto p = o.getParam();
+    nodeStore.subType.modify()[j] = p ? p->subType : -1;
+    nodeStore.radius.modify()[j] = p ? p->a : 0.;
+}
+
+/**
+ * Writes the moved i-th node of organ @param o into the node store, and remembers its index (@see Organism::getUpdatedNodeIndices)
+ *
+ * @param o         the organ containing the node
+ * @param i         local node index
+ */
+void Organism::updateNode(const Organ& o, int i)
+{
+    if (task!=nullptr) {
+        return;
+    }
+    storeNode(o, i);
+    updatedNodes.push_back(o.getNodeId(i));
+}
+
+/**
+ * Writes all nodes (except the first node) of all organs with node index >= @param from into the node store,
+ * and the nodes that were moved in the last time step (with index < @param from).
+ * Used after a parallel simulation, or to rebuild the store after a state was restored.
+ *
+ * @param from      first node index that is written
+ */
+void Organism::storeNodes(int from)
+{
+    nodeStore.resize(nodeId+1);
+    updatedNodes.clear();
+    for (const auto& o : getOrgans()) {
+        if (o->hasMoved()) {
+            int i = o->getOldNumberOfNodes()-1;
+            if (o->getNodeId(i)<from) {
+                storeNode(*o, i);
+                updatedNodes.push_back(o->getNodeId(i));
+            }
+        }
+        for (int i=1; i<o->getNumberOfNodes(); i++) {
+            if (o->getNodeId(i)>=from) {
+                storeNode(*o, i);
+            }
+        }
+    }
+}
+
+/**
+ * @return the organs, indexed by their organ id (nullptr for organs with less than two nodes)
+ */
+std::vector<std::shared_ptr<Organ>> Organism::organsById() const
+{
+    std::vector<std::shared_ptr<Organ>> organs(getNumberOfOrgans());
+    for (const auto& o : getOrgans()) {
+        organs.at(o->getId()) = o;
+    }
+    return organs;
+}
+
 /**
  * @return Quick info about the object for debugging
  */
@@ -608,6 +860,168 @@ void Organism::writeParameters(std::string name, std::string basetag, bool comme
     xmlDoc.SaveFile(name.c_str());
 }
 
+/**
+ * Writes the complete state of the organism into a binary file, to restart the simulation later (@see Organism::loadCheckpoint),
+ * i.e. the organ tree with nodes and specific parameters, the organ random parameters, the random number generator, and the counters.
+ *
+ * Call back functions (e.g. soil look ups, confining geometries) are not written, they must be set again after loading.
+ * The file is written to name.tmp first, and then renamed, so an interrupted write does not destroy a previous checkpoint.
+ *
+ * @param name      file name
+ */
+void Organism::saveCheckpoint(std::string name) const
+{
+    std::string tmp = name+".tmp";
+    {
+        std::ofstream os(tmp, std::ios::binary);
+        if (!os) {
+            throw std::invalid_argument("Organism::saveCheckpoint: could not open file " + tmp);
+        }
+        Checkpoint::write(os, Checkpoint::magic);
+        Checkpoint::write(os, Checkpoint::version);
+        Checkpoint::write(os, std::string(typeid(*this).name()));
+        writeCheckpoint(os);
+        if (!os) {
+            throw std::invalid_argument("Organism::saveCheckpoint: could not write file " + tmp);
+        }
+    }
+    if (std::rename(tmp.c_str(), name.c_str())!=0) {
+        throw std::invalid_argument("Organism::saveCheckpoint: could not rename " + tmp + " to " + name);
+    }
+}
+
+/**
+ * Restores the complete state of the organism from a binary file written by Organism::saveCheckpoint,
+ * the organism must be of the same class. The organ random parameters are replaced,
+ * call back functions (e.g. tropisms, and growth functions) are set up like in Organism::initialize.
+ *
+ * @param name      file name
+ */
+void Organism::loadCheckpoint(std::string name)
+{
+    std::ifstream is(name, std::ios::binary);
+    if (!is) {
+        throw std::invalid_argument("Organism::loadCheckpoint: could not open file " + name);
+    }
+    uint32_t magic, version;
+    std::string className;
+    Checkpoint::read(is, magic);
+    Checkpoint::read(is, version);
+    if ((magic!=Checkpoint::magic) || (version!=Checkpoint::version)) {
+        throw std::invalid_argument("Organism::loadCheckpoint: " + name + " is not a checkpoint of this version");
+    }
+    Checkpoint::read(is, className);
+    if (className!=typeid(*this).name()) {
+        throw std::invalid_argument("Organism::loadCheckpoint: " + name + " is a checkpoint of another class");
+    }
+    readCheckpoint(is);
+}
+
+/**
+ * Writes the state of the organism into a binary checkpoint (@see Organism::saveCheckpoint)
+ *
+ * @param os        binary output stream
+ */
+void Organism::writeCheckpoint(std::ostream& os) const
+{
+    Checkpoint::write(os, simtime);
+    Checkpoint::write(os, organId);
+    Checkpoint::write(os, nodeId);
+    Checkpoint::write(os, oldNumberOfNodes);
+    Checkpoint::write(os, oldNumberOfOrgans);
+    Checkpoint::write(os, rsmlProperties);
+    Checkpoint::write(os, rsmlSkip);
+    Checkpoint::write(os, minDx);
+    Checkpoint::write(os, numberOfThreads);
+    Checkpoint::write(os, seed_);
+    std::stringstream rng; // text representation is the only portable access to the generator state
+    rng << gen << " " << UD << " " << ND;
+    Checkpoint::write(os, rng.str());
+    for (int ot = 0; ot < numberOfOrganTypes; ot++) { // organ random parameters
+        Checkpoint::write(os, uint64_t(organParam[ot].size()));
+        for (auto& otp : organParam[ot]) {
+            otp.second->writeCheckpoint(os);
+        }
+    }
+    Checkpoint::write(os, uint64_t(baseOrgans.size())); // organ tree
+    for (const auto& o : baseOrgans) {
+        Checkpoint::write(os, o->checkpointClass());
+        o->writeCheckpoint(os);
+    }
+    Checkpoint::write(os, nodeStore.x); // node store
+    Checkpoint::write(os, nodeStore.y);
+    Checkpoint::write(os, nodeStore.z);
+    Checkpoint::write(os, nodeStore.cts);
+    Checkpoint::write(os, nodeStore.prev);
+    Checkpoint::write(os, nodeStore.organId);
+    Checkpoint::write(os, nodeStore.organType);
+    Checkpoint::write(os, nodeStore.subType);
+    Checkpoint::write(os, nodeStore.radius);
+    Checkpoint::write(os, updatedNodes);
+}
+
+/**
+ * Reads the state of the organism from a binary checkpoint (@see Organism::loadCheckpoint).
+ * The organ random parameters are created like in Organism::readParameters, from the prototypes of Organism::initializeReader.
+ *
+ * @param is        binary input stream
+ */
+void Organism::readCheckpoint(std::istream& is)
+{
+    Checkpoint::read(is, simtime);
+    Checkpoint::read(is, organId);
+    Checkpoint::read(is, nodeId);
+    Checkpoint::read(is, oldNumberOfNodes);
+    Checkpoint::read(is, oldNumberOfOrgans);
+    Checkpoint::read(is, rsmlProperties);
+    Checkpoint::read(is, rsmlSkip);
+    Checkpoint::read(is, minDx);
+    Checkpoint::read(is, numberOfThreads);
+    Checkpoint::read(is, seed_);
+    std::string rng;
+    Checkpoint::read(is, rng);
+    std::stringstream(rng) >> gen >> UD >> ND;
+    for (auto& op : organParam) {
+        op.clear();
+    }
+    initializeReader(); // prototypes
+    for (int ot = 0; ot < numberOfOrganTypes; ot++) {
+        uint64_t n;
+        Checkpoint::read(is, n);
+        for (uint64_t i=0; i<n; i++) {
+            std::shared_ptr<OrganRandomParameter> otp;
+            if (organParam[ot].count(0)) {
+                otp = organParam[ot][0]->copy(shared_from_this());
+            } else {
+                otp = std::make_shared<OrganRandomParameter>(shared_from_this());
+            }
+            otp->readCheckpoint(is);
+            setOrganRandomParameter(otp);
+        }
+    }
+    uint64_t n;
+    Checkpoint::read(is, n);
+    baseOrgans.clear();
+    for (uint64_t i=0; i<n; i++) {
+        int oc;
+        Checkpoint::read(is, oc);
+        auto o = Checkpoint::createOrgan(oc);
+        o->readCheckpoint(is, shared_from_this());
+        baseOrgans.push_back(o);
+    }
+    organsChanged();
+    Checkpoint::read(is, nodeStore.x);
+    Checkpoint::read(is, nodeStore.y);
+    Checkpoint::read(is, nodeStore.z);
+    Checkpoint::read(is, nodeStore.cts);
+    Checkpoint::read(is, nodeStore.prev);
+    Checkpoint::read(is, nodeStore.organId);
+    Checkpoint::read(is, nodeStore.organType);
+    Checkpoint::read(is, nodeStore.subType);
+    Checkpoint::read(is, nodeStore.radius);
+    Checkpoint::read(is, updatedNodes);
+}
+
 /**
  * Creates a rsml file with filename @param name.
  *
@@ -680,6 +1094,95 @@ tinyxml2:: XMLElement* Organism::getRSMLScene(tinyxml2::XMLDocument& xmlDoc) con
 void Organism::setSeed(unsigned int seed)
 {
     this->gen = std::mt19937(seed);
+    this->seed_ = seed;
+}
+
+/**
+ * @return the next unique organ id, within a parallel simulation a temporary id of the current task
+ */
+int Organism::getOrganIndex()
+{
+    if (task!=nullptr) {
+        return task->tempId(task->organs++);
+    }
+    organId++;
+    return organId;
+}
+
+/**
+ * @return the next unique node id, within a parallel simulation a temporary id of the current task
+ */
+int Organism::getNodeIndex()
+{
+    if (task!=nullptr) {
+        return task->tempId(task->nodes++);
+    }
+    nodeId++;
+    nodeStore.resize(nodeId+1);
+    return nodeId;
+}
+
+/**
+ * @return a uniformly distributed random number (0,1), if Organism::numberOfThreads > 0
+ * and there is a RandomScope, it is counter based on the innermost scope of this thread
+ */
+double Organism::rand()
+{
+    if ((numberOfThreads>0) && (scope!=nullptr)) {
+        return rand(scope->key, scope->index, scope->purpose, scope->draws++);
+    }
+    return UD(gen);
+}
+
+/**
+ * @return a normally distributed random number (0,1), if Organism::numberOfThreads > 0
+ * and there is a RandomScope, it is counter based on the innermost scope of this thread
+ */
+double Organism::randn()
+{
+    if ((numberOfThreads>0) && (scope!=nullptr)) {
+        return randn(scope->key, scope->index, scope->purpose, scope->draws++);
+    }
+    return ND(gen);
+}
+
+/**
+ * Counter based uniformly distributed random number, the same arguments always give the same number,
+ * independent of the order of calls, or the thread.
+ *
+ * @param key       organ key (@see Organ::getRandomKey)
+ * @param index     local node index, or another index of the draw
+ * @param purpose   purpose of the draw (@see RandomPurposes)
+ * @param draw      number of the draw for equal key, index, and purpose
+ * @return          random number in (0,1)
+ */
+double Organism::rand(uint64_t key, int index, int purpose, int draw) const
+{
+    auto b = Philox::block({ uint32_t(key), uint32_t(key>>32), uint32_t(index), (uint32_t(purpose)<<24) | (uint32_t(draw) & 0x7FFFFF) },
+        { seed_, 0x5DEECE66 });
+    return ((uint64_t(b[0]>>5)<<26) + (b[1]>>6) + 0.5) / 9007199254740992.; // 53 bits
+}
+
+/**
+ * Counter based normally distributed random number (Box-Muller transform), @see Organism::rand(key, index, purpose, draw)
+ */
+double Organism::randn(uint64_t key, int index, int purpose, int draw) const
+{
+    auto b = Philox::block({ uint32_t(key), uint32_t(key>>32), uint32_t(index), (uint32_t(purpose)<<24) | (uint32_t(draw) & 0x7FFFFF) | 0x800000 },
+        { seed_, 0x5DEECE66 });
+    double u1 = ((uint64_t(b[0]>>5)<<26) + (b[1]>>6) + 0.5) / 9007199254740992.;
+    double u2 = ((uint64_t(b[2]>>5)<<26) + (b[3]>>6) + 0.5) / 9007199254740992.;
+    return std::sqrt(-2.*std::log(u1))*std::cos(2.*M_PI*u2);
+}
+
+/**
+ * Folds the bits of a double value into an index, e.g. to draw a new random number per organ age
+ */
+int Organism::hashIndex(double t)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &t, sizeof(bits));
+    return int(Philox::mix(bits, 0) & 0x7FFFFFFF);
 }
 
 
@@ -3,6 +3,7 @@
 #define ORGANISM_H_
 
 #include "mymath.h"
+#include "SharedVector.h"
 
 #include "external/tinyxml2/tinyxml2.h"
 
@@ -11,12 +12,89 @@
 #include <map>
 #include <array>
 #include <memory>
+#include <cstdint>
 
 namespace CPlantBox {
 
 class Organ;
 class OrganRandomParameter;
 
+/**
+ * Counter based random numbers (Philox4x32-10, Salmon et al. 2011):
+ * each block of four 32 bit random numbers is a function of a counter and a key, there is no generator state.
+ */
+class Philox
+{
+public:
+
+    static std::array<uint32_t, 4> block(std::array<uint32_t, 4> ctr, std::array<uint32_t, 2> key) {
+        for (int r = 0; r<10; r++) {
+            uint64_t p0 = uint64_t(0xD2511F53)*ctr[0];
+            uint64_t p1 = uint64_t(0xCD9E8D57)*ctr[2];
+            ctr = {{ uint32_t(p1>>32)^ctr[1]^key[0], uint32_t(p1), uint32_t(p0>>32)^ctr[3]^key[1], uint32_t(p0) }};
+            key[0] += 0x9E3779B9;
+            key[1] += 0xBB67AE85;
+        }
+        return ctr;
+    } ///< ten Philox rounds
+
+    static uint64_t mix(uint64_t a, uint64_t b) {
+        uint64_t z = a*0x9E3779B97F4A7C15ull + b + 0x632BE59BD9B4E019ull;
+        z = (z^(z>>30))*0xBF58476D1CE4E5B9ull;
+        z = (z^(z>>27))*0x94D049BB133111EBull;
+        return z^(z>>31);
+    } ///< hashes two 64 bit values into one (splitmix64 finalizer), used to derive organ keys
+
+};
+
+/**
+ * Struct of arrays holding all nodes of an organism, indexed by the global node index,
+ * which is maintained during growth (@see Organ::addNode, Organ::moveNode).
+ *
+ * Each node j with prev[j] >= 0 is the end node of the line segment [prev[j], j],
+ * the segment data (organId, organType, subType, radius) refers to this segment.
+ * The arrays are copied on write, i.e. shared with copies of the organism until they grow (@see Organism::fork).
+ */
+struct NodeStore {
+
+    SharedVector<double> x, y, z; ///< node coordinates [cm]
+    SharedVector<double> cts; ///< node creation times [day]
+    SharedVector<int> prev; ///< first node index of the segment ending in the node, -1 if there is no segment (e.g. seed node)
+    SharedVector<int> organId; ///< id of the organ containing the segment
+    SharedVector<int> organType; ///< organ type of the segment
+    SharedVector<int> subType; ///< sub type of the segment
+    SharedVector<double> radius; ///< radius of the segment [cm]
+
+    size_t size() const { return x.size(); } ///< number of nodes
+    void resize(size_t n) {
+        x.resize(n, 0.); y.resize(n, 0.); z.resize(n, 0.); cts.resize(n, 0.);
+        prev.resize(n, -1); organId.resize(n, -1); organType.resize(n, -1); subType.resize(n, -1); radius.resize(n, 0.);
+    } ///< new nodes are at the origin, without segment
+    void clear() { resize(0); } ///< removes all nodes
+
+};
+
+/**
+ * Cache of all organs of an organism in depth first order, with an index per organ type (@see Organism::getOrgans).
+ * It is rebuilt, when the organ tree has changed, i.e. when new organs were created, or by Organism::organsChanged.
+ *
+ * A copy is empty, since it would point to the organs of another organism.
+ */
+struct OrganRegistry {
+
+    OrganRegistry() { }
+    OrganRegistry(const OrganRegistry&) { } ///< empty, needs rebuild
+    OrganRegistry& operator=(const OrganRegistry&) { clear(); return *this; } ///< empty, needs rebuild
+
+    std::vector<std::shared_ptr<Organ>> organs; ///< all organs (including organs with less than two nodes)
+    std::vector<std::vector<int>> byType; ///< indices into organs per organ type
+    int organId = -1; ///< organ counter of the organism when the registry was built
+    bool valid = false; ///< false, if the registry must be rebuilt
+
+    void clear() { organs.clear(); byType.clear(); valid = false; } ///< empties the registry
+
+};
+
 /**
  * Organism
  *
@@ -35,6 +113,7 @@ class Organism : public std::enable_shared_from_this<Organism> {
 public:
 
     enum OrganTypes { ot_organ = 0, ot_seed = 1, ot_root = 2, ot_stem = 3, ot_leaf = 4 }; ///< coarse organ classification
+    enum RandomPurposes { rp_default = 0, rp_parameter = 1, rp_rotation = 2, rp_emergence = 3, rp_lateral = 4, rp_tropism = 5 }; ///< purpose of a random draw (@see RandomScope)
     static std::vector<std::string> organTypeNames; ///< names of the organ types
     static int instances; ///< the number of instances of this or derived classes
 
@@ -45,6 +124,7 @@ public:
     virtual ~Organism() { }; ///< destructor
 
     virtual std::shared_ptr<Organism> copy(); ///< deep copies the organism
+    virtual std::shared_ptr<Organism> fork(); ///< copies the organism for scenario branching, node data is copied on write
 
     /* organ parameter management */
     std::shared_ptr<OrganRandomParameter> getOrganRandomParameter(int otype, int subType) const; ///< returns the respective the type parameter
@@ -53,13 +133,16 @@ public:
     int getParameterSubType(int organtype, std::string str) const; ///< returns the parameter sub type index of name @param str
 
     /* initialization and simulation */
-    void addOrgan(std::shared_ptr<Organ> o) { baseOrgans.push_back(o); } ///< adds an organ, takes ownership
+    void addOrgan(std::shared_ptr<Organ> o) { baseOrgans.push_back(o); organsChanged(); } ///< adds an organ, takes ownership
     virtual void initialize(bool verbose = true); ///< overwrite for initialization jobs
     virtual void simulate(double dt, bool verbose = false); ///< calls the base organs simulate methods
     double getSimTime() const { return simtime; } ///< returns the current simulation time
+    void setNumberOfThreads(int n); ///< 0: sequential simulation with a single random generator (default), >0: counter based random numbers, parallel simulation of the base organs
+    int getNumberOfThreads() const { return numberOfThreads; } ///< number of threads used by Organism::simulate
 
     /* as sequential list */
     std::vector<std::shared_ptr<Organ>> getOrgans(int ot=-1) const; ///< sequential list of organs
+    void organsChanged(); ///< marks the cached organ list as outdated (@see OrganRegistry), called by Organ::addChild
     virtual std::vector<double> getParameter(std::string name, int ot = -1, std::vector<std::shared_ptr<Organ>> organs = std::vector<std::shared_ptr<Organ>>(0)) const; ///< parameter value per organ
     double getSummed(std::string name, int ot = -1) const; ///< summed up parameters
     // std::shared_ptr<Organ> pickOrgan(int nodeId); // TODO
@@ -87,19 +170,26 @@ public:
     std::vector<Vector2i> getNewSegments(int ot=-1) const; ///< Segments created in the previous time step
     std::vector<std::shared_ptr<Organ>> getNewSegmentOrigins(int ot=-1) const; ///< Copies a pointer to the root containing the new segments
 
+    /* node store */
+    const NodeStore& getNodeStore() const { return nodeStore; } ///< all nodes and segments as struct of arrays, indexed by the node index
+    void storeNode(const Organ& o, int i); ///< writes the i-th node of organ o into the node store, only organs should call this
+    void updateNode(const Organ& o, int i); ///< writes the moved i-th node of organ o into the node store, only organs should call this
+
     /* io */
     virtual std::string toString() const; ///< quick info for debugging
     virtual void initializeReader() { } ///< initializes parameter reader
     virtual void readParameters(std::string name, std::string  basetag = "plant"); ///< reads all organ type parameters from a xml file
     virtual void writeParameters(std::string name, std::string basetag = "plant", bool comments = true) const; ///< write all organ type parameters into a xml file
     virtual void writeRSML(std::string name) const; ///< writes a RSML file
+    void saveCheckpoint(std::string name) const; ///< writes the complete state of the organism into a binary file
+    void loadCheckpoint(std::string name); ///< restores the complete state of the organism from a binary file
     int getRSMLSkip() const { return rsmlSkip; } ///< skips points in the RSML output (default = 0)
     void setRSMLSkip(int skip) { assert(rsmlSkip>=0 && "rsmlSkip must be >= 0" ); rsmlSkip = skip;  } ///< skips points in the RSML output (default = 0)
     std::vector<std::string>& getRSMLProperties() { return rsmlProperties; } ///< reference to the vector<string> of RSML property names, default is { "organType", "subType","length", "age"  }
 
     /* id management */
-    int getOrganIndex() { organId++; return organId; } ///< returns next unique organ id, only organ constructors should call this
-    int getNodeIndex() { nodeId++; return nodeId; } ///< returns next unique node id, only organ constructors should call this
+    int getOrganIndex(); ///< returns next unique organ id, only organ constructors should call this
+    int getNodeIndex(); ///< returns next unique node id, only organ constructors should call this
 
     /* discretisation*/
     void setMinDx(double dx) { minDx = dx; } ///< Minimum segment size, smaller segments will be skipped
@@ -107,11 +197,43 @@ public:
 
     /* random number generator */
     virtual void setSeed(unsigned int seed); ///< sets the seed of the organisms random number generator
-    virtual double rand() { return UD(gen); } ///< uniformly distributed random number (0,1)
-    virtual double randn() { return ND(gen); } ///< normally distributed random number (0,1)
+    virtual double rand(); ///< uniformly distributed random number (0,1)
+    virtual double randn(); ///< normally distributed random number (0,1)
+    double rand(uint64_t key, int index, int purpose, int draw) const; ///< counter based uniformly distributed random number (0,1)
+    double randn(uint64_t key, int index, int purpose, int draw) const; ///< counter based normally distributed random number (0,1)
+
+    /**
+     * Sets the key, index, and purpose of the subsequent Organism::rand() and Organism::randn() calls of this thread,
+     * as long as the scope object lives (only used if Organism::getNumberOfThreads() > 0)
+     */
+    class RandomScope {
+    public:
+        RandomScope(uint64_t key, int index, int purpose): key(key), index(index), purpose(purpose), previous(scope) { scope = this; }
+        ~RandomScope() { scope = previous; }
+        const uint64_t key; ///< organ key (@see Organ::getRandomKey)
+        const int index; ///< local node index, or another index of the draw
+        const int purpose; ///< purpose of the draw (@see RandomPurposes)
+        int draws = 0; ///< number of draws within this scope
+    private:
+        RandomScope* previous;
+    };
+
+    static int hashIndex(double t); ///< an index from the bits of a double value (e.g. the age of an organ)
 
 protected:
 
+    struct SimulationTask; ///< state of a base organ that is simulated by a worker thread
+    static thread_local SimulationTask* task; ///< task of the current thread (nullptr if not within a parallel simulation)
+    static thread_local RandomScope* scope; ///< innermost random scope of the current thread (nullptr if none)
+
+    void simulateParallel(double dt, bool verbose); ///< simulates the base organs with Organism::numberOfThreads threads
+    void storeNodes(int from); ///< writes the organ nodes with index >= from, and the moved nodes into the node store
+    std::vector<std::shared_ptr<Organ>> organsById() const; ///< organs indexed by their id
+    const OrganRegistry& organRegistry() const; ///< the cached organ list, rebuilt if necessary
+
+    virtual void writeCheckpoint(std::ostream& os) const; ///< writes the state, overwrite to add the state of derived classes
+    virtual void readCheckpoint(std::istream& is); ///< reads the state, overwrite to add the state of derived classes
+
     virtual tinyxml2:: XMLElement* getRSMLMetadata(tinyxml2::XMLDocument& doc) const;
     virtual tinyxml2:: XMLElement* getRSMLScene(tinyxml2::XMLDocument& doc) const;
 
@@ -126,6 +248,10 @@ protected:
     int oldNumberOfNodes = 0;
     int oldNumberOfOrgans = 0;
 
+    NodeStore nodeStore; ///< all nodes and segments (@see Organism::getNodeStore)
+    std::vector<int> updatedNodes; ///< indices of the nodes moved in the last time step
+    mutable OrganRegistry registry; ///< cached organ list (@see Organism::getOrgans)
+
     std::vector<std::string> rsmlProperties = { "organType", "subType","length", "age"  };
     int rsmlSkip = 0; // skips points
     double minDx = 1.e-6; ///< threshold value, smaller segments will be skipped, otherwise root tip direction can become NaN
@@ -134,6 +260,9 @@ protected:
     std::uniform_real_distribution<double> UD;
     std::normal_distribution<double> ND;
 
+    int numberOfThreads = 0; ///< 0 for the sequential simulation
+    unsigned int seed_ = 0; ///< seed of the random generators
+
 };
 
 } // namespace
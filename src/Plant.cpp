@@ -1,11 +1,15 @@
 #include "Plant.h"
 
+#include "VTKWriter.h"
+#include "Checkpoint.h"
+
 #include <memory>
 #include <iostream>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <string>
 #include <fstream>
+#include <limits>
 
 namespace CPlantBox {
 
@@ -25,7 +29,24 @@ std::shared_ptr<Organism> Plant::copy()
         no->baseOrgans[i] = baseOrgans[i]->copy(no);
     }
     for (int ot = 0; ot < numberOfOrganTypes; ot++) { // copy organ type parameters
-        for (auto& otp : organParam[ot]) {
+        for (auto& otp : no->organParam[ot]) {
+            otp.second = otp.second->copy(no);
+        }
+    }
+    return no;
+}
+
+/**
+ * Copies the plant for scenario branching (@see Organism::fork)
+ */
+std::shared_ptr<Organism> Plant::fork()
+{
+    auto no = std::make_shared<Plant>(*this); // copy constructor
+    for (size_t i=0; i<baseOrgans.size(); i++) {
+        no->baseOrgans[i] = baseOrgans[i]->fork(no);
+    }
+    for (int ot = 0; ot < numberOfOrganTypes; ot++) { // copy organ type parameters
+        for (auto& otp : no->organParam[ot]) {
             otp.second = otp.second->copy(no);
         }
     }
@@ -68,6 +89,9 @@ void Plant::reset()
     simtime = 0;
     organId = -1;
     nodeId = -1;
+    nodeStore.clear();
+    updatedNodes.clear();
+    registry.clear();
 }
 
 /**
@@ -83,7 +107,7 @@ void Plant::initialize(bool verbose)
     // create seed
     auto seed = std::make_shared<Seed>(shared_from_this());
     seed->initialize(verbose);
-    baseOrgans.push_back(seed);
+    addOrgan(seed);
 
     oldNumberOfNodes = getNumberOfNodes(); // todo check what this does
 
@@ -224,6 +248,29 @@ std::shared_ptr<GrowthFunction>Plant::createGrowthFunction(int gft) {
     }
 }
 
+/**
+ * @copydoc Organism::writeCheckpoint
+ */
+void Plant::writeCheckpoint(std::ostream& os) const
+{
+    Organism::writeCheckpoint(os);
+    Checkpoint::write(os, leafphytomerID);
+    Checkpoint::write(os, Stem::phytomerId);
+}
+
+/**
+ * @copydoc Organism::readCheckpoint
+ *
+ * Tropisms and growth functions are created like in Plant::initialize, i.e. set the confining geometry before.
+ */
+void Plant::readCheckpoint(std::istream& is)
+{
+    Organism::readCheckpoint(is);
+    Checkpoint::read(is, leafphytomerID);
+    Checkpoint::read(is, Stem::phytomerId);
+    initCallbacks();
+}
+
 /**
  * todo most important debug informations
  */
@@ -239,8 +286,10 @@ std::string Plant::toString() const
  * todo move to Organism
  *
  * @param name      file name e.g. output.vtp
+ * @param format    vtp data format (VTKWriter::Formats): ascii (default), appended raw, or appended base64
+ * @param compress  zlib compression of binary vtp data
  */
-void Plant::write(std::string name) const
+void Plant::write(std::string name, int format, bool compress) const
 {
     std::string ext = name.substr(name.size()-3,name.size()); // pick the right writer
     if (ext.compare("sml")==0) {
@@ -249,8 +298,8 @@ void Plant::write(std::string name) const
     } else if (ext.compare("vtp")==0) {
         std::cout << "writing VTP... "<< name.c_str() <<"\n";
         std::ofstream fos;
-        fos.open(name.c_str());
-        writeVTP(-1, fos);
+        fos.open(name.c_str(), std::ios::binary);
+        writeVTP(-1, fos, format, compress);
         fos.close();
 //    } else if (ext.compare(".py")==0)  {
 //        std::cout << "writing Geometry ... "<< name.c_str() <<"\n";
@@ -261,88 +310,84 @@ void Plant::write(std::string name) const
 }
 
 /**
-write VTP using tinyXML
-todo move to Organism
- **/
-void Plant::writeVTP(int otype, std::ostream & os) const // Write .VTP file by using TinyXML2 performance slowed by 0.5 seconds but precision increased
+ * Writes the organs as polylines into a VTP file (VTK polydata file)
+ *
+ * todo move to Organism
+ *
+ * @param otype     organ type, -1 for all organ types
+ * @param os        typically a file out stream (opened in binary mode for raw data)
+ * @param format    data format (VTKWriter::Formats): ascii (default, written with full float precision), appended raw, or appended base64
+ * @param compress  zlib compression of binary data
+ */
+void Plant::writeVTP(int otype, std::ostream & os, int format, bool compress) const
 {
-    tinyxml2::XMLPrinter printer( 0, false, 0 );
-
     auto organs = this->getOrgans(otype); // update roots (if necessary)
     auto nodes = getPolylines(otype);
     auto times = getPolylineCTs(otype);
 
-    os << "<?xml version=\"1.0\"?>";
-    printer.OpenElement("VTKFile"); printer.PushAttribute("type", "PolyData"); printer.PushAttribute("version", "0.1"); printer.PushAttribute("byte_order", "LittleEndian");
-    printer.OpenElement("PolyData");
+    auto precision = os.precision(std::numeric_limits<float>::max_digits10);
+    VTKWriter w(os, format, compress);
+    w.beginFile("PolyData");
     int non = 0; // number of nodes
     for (const auto& r : organs) {
         non += r->getNumberOfNodes();
     }
     int nol=organs.size(); // number of lines
-    printer.OpenElement("Piece"); printer.PushAttribute("NumberOfLines",  nol); printer.PushAttribute("NumberOfPoints", non);
+    w.openElement("Piece", "NumberOfLines=\""+std::to_string(nol)+"\" NumberOfPoints=\""+std::to_string(non)+"\"");
 
     // POINTDATA
-    printer.OpenElement("PointData"); printer.PushAttribute("Scalars", "Pointdata");
-    printer.OpenElement("DataArray"); printer.PushAttribute("type", "Float32");  printer.PushAttribute("Name", "time"); printer.PushAttribute("NumberOfComponents", "1"); printer.PushAttribute("format", "ascii" );
-    for (std::vector<double> r: times) {
-        for (double t : r) {
-            printer.PushText(t); printer.PushText(" ");
-        }
+    std::vector<float> time;
+    time.reserve(non);
+    for (const auto& r: times) {
+        time.insert(time.end(), r.begin(), r.end());
     }
-    printer.CloseElement();
-    printer.CloseElement();
+    w.openElement("PointData", "Scalars=\"Pointdata\"");
+    w.dataArray("time", time);
+    w.closeElement("PointData");
 
     // CELLDATA (live on the polylines)
-    printer.OpenElement("CellData"); printer.PushAttribute("Scalars", "CellData" );
+    w.openElement("CellData", "Scalars=\"CellData\"");
     std::vector<std::string> sTypeNames = { "organType", "id", "creationTime", "age", "subType", "order", "radius"}; //  , "order", "radius", "subtype" ,
     for (size_t i=0; i<sTypeNames.size(); i++) {
-        std::string sType = sTypeNames[i];
-        const char *schar = sType.c_str();
-        printer.OpenElement("DataArray"); printer.PushAttribute("type", "Float32");  printer.PushAttribute("Name", schar); printer.PushAttribute("NumberOfComponents", "1"); printer.PushAttribute("format", "ascii" );
         std::vector<double> scalars = getParameter(sTypeNames[i], otype);
-        for (double s : scalars) {
-            printer.PushText(s); printer.PushText(" ");
-        }
-        printer.CloseElement();
+        w.dataArray(sTypeNames[i], std::vector<float>(scalars.begin(), scalars.end()));
     }
-    printer.CloseElement();
+    w.closeElement("CellData");
 
     // POINTS (=nodes)
-    printer.OpenElement("Points");
-    printer.OpenElement("DataArray"); printer.PushAttribute("type", "Float32");  printer.PushAttribute("Name", "Coordinates"); printer.PushAttribute("NumberOfComponents", "3"); printer.PushAttribute("format", "ascii" );
+    std::vector<float> points;
+    points.reserve(3*non);
     for (const auto& r : nodes) {
         for (const auto& n : r) {
-            printer.PushText(n.x); printer.PushText(" "); printer.PushText(n.y); printer.PushText(" "); printer.PushText(n.z); printer.PushText(" ");
+            points.push_back(n.x);
+            points.push_back(n.y);
+            points.push_back(n.z);
         }
     }
-    printer.CloseElement();
-    printer.CloseElement();
+    w.openElement("Points");
+    w.dataArray("Coordinates", points, 3);
+    w.closeElement("Points");
 
     // LINES (polylines)
-    printer.OpenElement("Lines");
-    printer.OpenElement("DataArray"); printer.PushAttribute("type", "Float32");  printer.PushAttribute("Name", "connectivity"); printer.PushAttribute("NumberOfComponents", "1"); printer.PushAttribute("format", "ascii" );
+    std::vector<int32_t> connectivity(non);
+    std::vector<int32_t> offsets;
+    offsets.reserve(nol);
     int c=0;
     for (const auto& r : organs) {
         for (size_t i=0; i<r->getNumberOfNodes(); i++) {
-            printer.PushText(c); printer.PushText(" ");
+            connectivity[c] = c;
             c++;
         }
+        offsets.push_back(c);
     }
-    printer.CloseElement();
+    w.openElement("Lines");
+    w.dataArray("connectivity", connectivity);
+    w.dataArray("offsets", offsets);
+    w.closeElement("Lines");
 
-    printer.OpenElement("DataArray"); printer.PushAttribute("type", "Float32");  printer.PushAttribute("Name", "offsets"); printer.PushAttribute("NumberOfComponents", "1"); printer.PushAttribute("format", "ascii" );
-    c = 0;
-    for (const auto& r : organs) {
-        c += r->getNumberOfNodes();
-        printer.PushText(c); printer.PushText(" ");
-    }
-    printer.CloseElement();
-    printer.CloseElement();
-    printer.CloseElement();
-    printer.CloseElement();
-    printer.CloseElement();
-    os << std::string(printer.CStr());
+    w.closeElement("Piece");
+    w.endFile();
+    os.precision(precision);
 }
 
 } // namespace CPlantBox
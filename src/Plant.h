@@ -41,6 +41,7 @@ public:
   virtual ~Plant() { };
 
   std::shared_ptr<Organism> copy() override; ///< deep copies the organism
+  std::shared_ptr<Organism> fork() override; ///< copies the organism for scenario branching, node data is copied on write
 
   /* organs */
   std::shared_ptr<Seed> getSeed(); ///< the plant seed
@@ -62,14 +63,17 @@ public:
   virtual std::shared_ptr<Tropism> createTropismFunction(int tt, double N, double sigma); ///< Creates the tropisms, overwrite or change this method to add more tropisms
   virtual std::shared_ptr<GrowthFunction> createGrowthFunction(int gft); ///< Creates the growth function per root type, overwrite or change this method to add more tropisms
 
-  void write(std::string name) const; /// writes simulation results (type is determined from file extension in name)
+  void write(std::string name, int format = 0, bool compress = false) const; /// writes simulation results (type is determined from file extension in name)
   std::string toString() const override;
-  void writeVTP(int otype, std::ostream & os) const;
+  void writeVTP(int otype, std::ostream & os, int format = 0, bool compress = false) const; ///< writes the organs as polylines (format is a VTKWriter::Formats)
 
   std::vector<int> leafphytomerID = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
 
 protected:
 
+  void writeCheckpoint(std::ostream& os) const override; ///< additionally writes the phytomer counters
+  void readCheckpoint(std::istream& is) override; ///< additionally reads the phytomer counters, and sets up the call backs
+
   std::shared_ptr<SignedDistanceFunction> geometry = std::make_shared<SignedDistanceFunction>();  ///< Confining geometry (unconfined by default)
   std::shared_ptr<SoilLookUp> soil; ///< callback for hydro, or chemo tropism (needs to set before initialize()) TODO should be a part of tf, or rtparam
 
@@ -1,6 +1,7 @@
 // -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
 #include "external/pybind11/include/pybind11/pybind11.h"
 #include "external/pybind11/include/pybind11/stl.h"
+#include "external/pybind11/include/pybind11/numpy.h"
 #include <pybind11/functional.h>
 namespace py = pybind11;
 
@@ -26,6 +27,9 @@ namespace py = pybind11;
 
 #include "RootSystem.h"
 #include "Plant.h"
+#include "Ensemble.h"
+#include "SegmentQuery.h"
+#include "VTKWriter.h"
 
 // sepcialized
 #include "MappedOrganism.h"
@@ -78,6 +82,18 @@ public:
 
 };
 
+/**
+ * Read only numpy view (zero copy) of a std::vector owned by @param base,
+ * the view is invalid as soon as the vector grows (e.g. after the next simulate call)
+ */
+template<class T>
+py::array_t<T> numpyView(const std::vector<T>& v, py::handle base)
+{
+    auto a = py::array_t<T>(std::vector<ssize_t>{ ssize_t(v.size()) }, v.data(), base);
+    a.attr("flags").attr("writeable") = false;
+    return a;
+}
+
 // todo
 // SignedDistanceFunction
 // OrganRandomParameter
@@ -189,8 +205,19 @@ PYBIND11_MODULE(plantbox, m) {
     py::class_<SignedDistanceFunction, std::shared_ptr<SignedDistanceFunction>>(m,"SignedDistanceFunction")
             .def(py::init<>())
             .def("getDist",&SignedDistanceFunction::getDist)
+            .def("getDists", [](const SignedDistanceFunction& s, const std::vector<Vector3d>& p) {
+                size_t n = p.size();
+                std::vector<double> xyz(3*n), d(n);
+                for (size_t i=0; i<n; i++) {
+                    xyz[i] = p[i].x; xyz[n+i] = p[i].y; xyz[2*n+i] = p[i].z;
+                }
+                s.getDists(xyz.data(), n, d.data());
+                return d;
+            }) // batch of points
             .def("writePVPScript", (std::string (SignedDistanceFunction::*)() const) &SignedDistanceFunction::writePVPScript) // overloads
             .def("getGradient",  &SignedDistanceFunction::getGradient, py::arg("p"), py::arg("eps") = 5.e-4) // defaults
+            .def("getBoundingBox", [](const SignedDistanceFunction& s) { Vector3d a, b; s.getBoundingBox(a, b); return std::make_pair(a, b); })
+            .def("getInnerBox", [](const SignedDistanceFunction& s) { Vector3d a, b; s.getInnerBox(a, b); return std::make_pair(a, b); })
             .def("__str__",&SignedDistanceFunction::toString);
     py::class_<SDF_PlantBox, SignedDistanceFunction, std::shared_ptr<SDF_PlantBox>>(m, "SDF_PlantBox")
             .def(py::init<double,double,double>());
@@ -223,6 +250,14 @@ PYBIND11_MODULE(plantbox, m) {
             .def_readwrite("n", &SDF_HalfPlane::n)
             .def_readwrite("p1", &SDF_HalfPlane::p1)
             .def_readwrite("p2", &SDF_HalfPlane::p2);
+    py::class_<SDF_Bounds, std::shared_ptr<SDF_Bounds>>(m, "SDF_Bounds")
+            .def(py::init<>())
+            .def(py::init<const SignedDistanceFunction&>())
+            .def("classify", &SDF_Bounds::classify, py::arg("v"), py::arg("open") = false)
+            .def_readonly("min", &SDF_Bounds::min)
+            .def_readonly("max", &SDF_Bounds::max)
+            .def_readonly("innerMin", &SDF_Bounds::innerMin)
+            .def_readonly("innerMax", &SDF_Bounds::innerMax);
     /*
      * organparameter.h
      */
@@ -254,6 +289,7 @@ PYBIND11_MODULE(plantbox, m) {
             .def(py::init<std::shared_ptr<Organism>, std::shared_ptr<Organ>, int, int, double, Vector3d, double, int>())
             .def(py::init<int, std::shared_ptr<const OrganSpecificParameter>, bool, bool, double, double, Vector3d, double, int, bool, int>())
             .def("copy",&Organ::copy)
+            .def("fork",&Organ::fork)
             .def("organType",&Organ::organType)
             .def("simulate",&Organ::simulate,py::arg("dt"), py::arg("verbose") = bool(false) ) // default
 
@@ -266,6 +302,7 @@ PYBIND11_MODULE(plantbox, m) {
             .def("getChild",&Organ::getChild)
 
             .def("getId",&Organ::getId)
+            .def("getRandomKey",&Organ::getRandomKey)
             .def("getParam",&Organ::getParam)
             .def("getOrganRandomParameter",&Organ::getOrganRandomParameter)
             .def("isAlive",&Organ::isAlive)
@@ -279,6 +316,7 @@ PYBIND11_MODULE(plantbox, m) {
             .def("getNodeCT",&Organ::getNodeCT)
             .def("addNode",(void (Organ::*)(Vector3d n, double t)) &Organ::addNode) // overloads
             .def("addNode",(void (Organ::*)(Vector3d n, int id, double t)) &Organ::addNode) // overloads
+            .def("moveNode",&Organ::moveNode)
             .def("getSegments",&Organ::getSegments)
 
             .def("hasMoved",&Organ::hasMoved)
@@ -296,9 +334,21 @@ PYBIND11_MODULE(plantbox, m) {
     /*
      * Organism.h
      */
+    py::class_<NodeStore>(m, "NodeStore")
+            .def("size", &NodeStore::size)
+            .def_property_readonly("x", [](py::object s) { return numpyView(s.cast<const NodeStore&>().x.get(), s); })
+            .def_property_readonly("y", [](py::object s) { return numpyView(s.cast<const NodeStore&>().y.get(), s); })
+            .def_property_readonly("z", [](py::object s) { return numpyView(s.cast<const NodeStore&>().z.get(), s); })
+            .def_property_readonly("cts", [](py::object s) { return numpyView(s.cast<const NodeStore&>().cts.get(), s); })
+            .def_property_readonly("prev", [](py::object s) { return numpyView(s.cast<const NodeStore&>().prev.get(), s); })
+            .def_property_readonly("organId", [](py::object s) { return numpyView(s.cast<const NodeStore&>().organId.get(), s); })
+            .def_property_readonly("organType", [](py::object s) { return numpyView(s.cast<const NodeStore&>().organType.get(), s); })
+            .def_property_readonly("subType", [](py::object s) { return numpyView(s.cast<const NodeStore&>().subType.get(), s); })
+            .def_property_readonly("radius", [](py::object s) { return numpyView(s.cast<const NodeStore&>().radius.get(), s); });
     py::class_<Organism, std::shared_ptr<Organism>>(m, "Organism")
             .def(py::init<>())
             .def("copy", &Organism::copy)
+            .def("fork", &Organism::fork)
             .def("organTypeNumber", &Organism::organTypeNumber)
             .def("organTypeName", &Organism::organTypeName)
             .def("getOrganRandomParameter", (std::shared_ptr<OrganRandomParameter> (Organism::*)(int, int) const)  &Organism::getOrganRandomParameter) //overloads
@@ -309,6 +359,8 @@ PYBIND11_MODULE(plantbox, m) {
             .def("initialize", &Organism::initialize, py::arg("verbose") = true)
             .def("simulate", &Organism::simulate, py::arg("dt"), py::arg("verbose") = false) //default
             .def("getSimTime", &Organism::getSimTime)
+            .def("setNumberOfThreads", &Organism::setNumberOfThreads)
+            .def("getNumberOfThreads", &Organism::getNumberOfThreads)
 
             .def("getOrgans", &Organism::getOrgans, py::arg("ot") = -1) // default
             .def("getParameter", &Organism::getParameter, py::arg("name"), py::arg("ot") = -1, py::arg("organs") = std::vector<std::shared_ptr<Organ>>(0)) // default
@@ -335,11 +387,14 @@ PYBIND11_MODULE(plantbox, m) {
             .def("getNewNodeCTs", &Organism::getNewNodeCTs)
             .def("getNewSegments", &Organism::getNewSegments, py::arg("ot") = -1)  // default
             .def("getNewSegmentOrigins", &Organism::getNewSegmentOrigins, py::arg("ot") = -1)  // default
+            .def("getNodeStore", &Organism::getNodeStore, py::return_value_policy::reference_internal)
 
             .def("initializeReader", &Organism::initializeReader)
             .def("readParameters", &Organism::readParameters, py::arg("name"), py::arg("basetag") = "plant")  // default
             .def("writeParameters", &Organism::writeParameters, py::arg("name"), py::arg("basetag") = "plant", py::arg("comments") = true)  // default
             .def("writeRSML", &Organism::writeRSML)
+            .def("saveCheckpoint", &Organism::saveCheckpoint)
+            .def("loadCheckpoint", &Organism::loadCheckpoint)
             .def("getRSMLSkip", &Organism::getRSMLSkip)
             .def("setRSMLSkip", &Organism::setRSMLSkip)
             .def("getRSMLProperties", &Organism::getRSMLProperties) //todo policy
@@ -349,8 +404,10 @@ PYBIND11_MODULE(plantbox, m) {
 
             .def("setMinDx", &Organism::setMinDx)
             .def("setSeed", &Organism::setSeed)
-            .def("rand", &Organism::rand)
-            .def("randn", &Organism::randn)
+            .def("rand", (double (Organism::*)()) &Organism::rand) //overloads
+            .def("randn", (double (Organism::*)()) &Organism::randn) //overloads
+            .def("rand", (double (Organism::*)(uint64_t, int, int, int) const) &Organism::rand, py::arg("key"), py::arg("index"), py::arg("purpose"), py::arg("draw")) //overloads
+            .def("randn", (double (Organism::*)(uint64_t, int, int, int) const) &Organism::randn, py::arg("key"), py::arg("index"), py::arg("purpose"), py::arg("draw")) //overloads
             //        .def_readwrite("seed_nC_", &Organism::seed_nC_)
             //        .def_readwrite("seed_nZ_", &Organism::seed_nZ_)
 
@@ -364,6 +421,14 @@ PYBIND11_MODULE(plantbox, m) {
             .value("stem", Organism::OrganTypes::ot_stem)
             .value("leaf", Organism::OrganTypes::ot_leaf)
             .export_values();
+    py::enum_<Organism::RandomPurposes>(m, "RandomPurposes")
+            .value("default", Organism::RandomPurposes::rp_default)
+            .value("parameter", Organism::RandomPurposes::rp_parameter)
+            .value("rotation", Organism::RandomPurposes::rp_rotation)
+            .value("emergence", Organism::RandomPurposes::rp_emergence)
+            .value("lateral", Organism::RandomPurposes::rp_lateral)
+            .value("tropism", Organism::RandomPurposes::rp_tropism)
+            .export_values();
     /*
      * soil.h
      */
@@ -449,16 +514,50 @@ PYBIND11_MODULE(plantbox, m) {
            .def("distribution", (std::vector<SegmentAnalyser> (SegmentAnalyser::*)(double, double, int) const) &SegmentAnalyser::distribution) //overloads
            .def("distribution2", (std::vector<std::vector<double>> (SegmentAnalyser::*)(std::string, double, double, double, double, int, int, bool) const) &SegmentAnalyser::distribution2) //overloads
            .def("distribution2", (std::vector<std::vector<SegmentAnalyser>> (SegmentAnalyser::*)(double, double, double, double, int, int) const) &SegmentAnalyser::distribution2) //overloads
+           .def("distribution3", (std::vector<std::vector<std::vector<double>>> (SegmentAnalyser::*)(std::string, double, double, double, double, double, double, int, int, int, bool) const) &SegmentAnalyser::distribution3) //overloads
+           .def("distribution3", (std::vector<std::vector<std::vector<SegmentAnalyser>>> (SegmentAnalyser::*)(double, double, double, double, double, double, int, int, int) const) &SegmentAnalyser::distribution3) //overloads
            .def("mapPeriodic", &SegmentAnalyser::mapPeriodic)
            .def("getOrgans", &SegmentAnalyser::getOrgans)
            .def("getNumberOfOrgans", &SegmentAnalyser::getNumberOfOrgans)
            .def("cut", (SegmentAnalyser (SegmentAnalyser::*)(const SDF_HalfPlane&) const) &SegmentAnalyser::cut)
            .def("addData", &SegmentAnalyser::addData)
-           .def("write", &SegmentAnalyser::write, py::arg("name"), py::arg("types") = std::vector<std::string>({"radius", "subType", "creationTime", "organType"}))
+           .def("hasData", &SegmentAnalyser::hasData)
+           .def("getDataId", &SegmentAnalyser::getDataId)
+           .def("getData", [](py::object a, std::string name) { return numpyView(a.cast<const SegmentAnalyser&>().getData(name), a); }) // zero copy
+           .def("getDataNames", &SegmentAnalyser::getDataNames)
+           .def("write", &SegmentAnalyser::write, py::arg("name"), py::arg("types") = std::vector<std::string>({"radius", "subType", "creationTime", "organType"}),
+                py::arg("format") = 0, py::arg("compress") = false)
            .def_readwrite("nodes", &SegmentAnalyser::nodes)
            .def_readwrite("segments", &SegmentAnalyser::segments)
            .def_readwrite("segO", &SegmentAnalyser::segO)
-           .def_readwrite("data", &SegmentAnalyser::data);
+           .def_property("data", &SegmentAnalyser::getDataMap, &SegmentAnalyser::setDataMap);
+    /*
+     * SegmentQuery.h
+     */
+    py::class_<SegmentQuery, std::shared_ptr<SegmentQuery>>(m, "SegmentQuery")
+           .def(py::init<const SegmentAnalyser&>(), py::keep_alive<1, 2>())
+           .def("filter", (SegmentQuery& (SegmentQuery::*)(std::string, double, double)) &SegmentQuery::filter, py::return_value_policy::reference_internal) //overloads
+           .def("filter", (SegmentQuery& (SegmentQuery::*)(std::string, double)) &SegmentQuery::filter, py::return_value_policy::reference_internal) //overloads
+           .def("crop", &SegmentQuery::crop, py::return_value_policy::reference_internal)
+           .def("cropDomain", &SegmentQuery::cropDomain, py::return_value_policy::reference_internal)
+           .def("mapPeriodic", &SegmentQuery::mapPeriodic, py::return_value_policy::reference_internal)
+           .def("getNumberOfSegments", &SegmentQuery::getNumberOfSegments)
+           .def("getSummed", &SegmentQuery::getSummed)
+           .def("distribution", &SegmentQuery::distribution, py::arg("name"), py::arg("top"), py::arg("bot"), py::arg("n"), py::arg("exact") = false)
+           .def("distribution2", &SegmentQuery::distribution2, py::arg("name"), py::arg("top"), py::arg("bot"), py::arg("left"), py::arg("right"),
+                py::arg("n"), py::arg("m"), py::arg("exact") = false)
+           .def("distribution3", &SegmentQuery::distribution3, py::arg("name"), py::arg("top"), py::arg("bot"), py::arg("left"), py::arg("right"),
+                py::arg("front"), py::arg("back"), py::arg("n"), py::arg("m"), py::arg("o"), py::arg("exact") = false)
+           .def("analyser", &SegmentQuery::analyser)
+           .def("__str__", &SegmentQuery::toString);
+    /*
+     * VTKWriter.h
+     */
+    py::enum_<VTKWriter::Formats>(m, "VTKFormats")
+            .value("ascii", VTKWriter::Formats::vtk_ascii)
+            .value("raw", VTKWriter::Formats::vtk_raw)
+            .value("base64", VTKWriter::Formats::vtk_base64)
+            .export_values();
     /*
      * rootparameter.h
      */
@@ -737,6 +836,7 @@ PYBIND11_MODULE(plantbox, m) {
             .def("simulate",(void (RootSystem::*)(double,bool)) &RootSystem::simulate, py::arg("dt"), py::arg("verbose") = false)
             .def("simulate",(void (RootSystem::*)()) &RootSystem::simulate)
             .def("simulate",(void (RootSystem::*)(double, double, ProportionalElongation*, bool)) &RootSystem::simulate)
+            .def("simulateLimited", &RootSystem::simulateLimited, py::arg("dt"), py::arg("maxinc"), py::arg("se"), py::arg("verbose") = false)
             .def("getRoots", &RootSystem::getRoots)
             .def("initCallbacks", &RootSystem::initCallbacks)
             .def("createTropismFunction", &RootSystem::createTropismFunction)
@@ -748,7 +848,29 @@ PYBIND11_MODULE(plantbox, m) {
             .def("getRootBases", &RootSystem::getRootBases)
             .def("push",&RootSystem::push)
             .def("pop",&RootSystem::pop)
-            .def("write", &RootSystem::write);
+            .def("write", &RootSystem::write, py::arg("name"), py::arg("format") = 0, py::arg("compress") = false);
+    /*
+     * Ensemble.h
+     */
+    py::class_<Ensemble, std::shared_ptr<Ensemble>>(m, "Ensemble")
+            .def(py::init<std::shared_ptr<Organism>, int, unsigned int>(), py::arg("prototype"), py::arg("n"), py::arg("seed") = 0)
+            .def("getNumberOfPlants", &Ensemble::getNumberOfPlants)
+            .def("getPlant", &Ensemble::getPlant)
+            .def("setSeedPositions", &Ensemble::setSeedPositions)
+            .def("setNumberOfThreads", &Ensemble::setNumberOfThreads)
+            .def("getNumberOfThreads", &Ensemble::getNumberOfThreads)
+            .def("initialize", &Ensemble::initialize, py::arg("verbose") = false)
+            .def("simulate", &Ensemble::simulate, py::arg("dt"), py::arg("verbose") = false)
+            .def("getSimTime", &Ensemble::getSimTime)
+            .def("getNodes", &Ensemble::getNodes)
+            .def("getNodeCTs", &Ensemble::getNodeCTs)
+            .def("getNodePlantIds", &Ensemble::getNodePlantIds)
+            .def("getSegments", &Ensemble::getSegments, py::arg("ot") = -1)
+            .def("getSegmentCTs", &Ensemble::getSegmentCTs, py::arg("ot") = -1)
+            .def("getSegmentPlantIds", &Ensemble::getSegmentPlantIds, py::arg("ot") = -1)
+            .def("getSummed", &Ensemble::getSummed, py::arg("name"), py::arg("ot") = -1)
+            .def("getSegmentAnalyser", &Ensemble::getSegmentAnalyser)
+            .def("__str__",&Ensemble::toString);
     /*
      * MappedOrganism.h
      */
@@ -761,8 +883,24 @@ PYBIND11_MODULE(plantbox, m) {
         .def("setSoilGrid", (void (MappedSegments::*)(const std::function<int(double,double,double)>&)) &MappedSegments::setSoilGrid)
         .def("setSoilGrid", (void (MappedSegments::*)(const std::function<int(double,double,double)>&, Vector3d, Vector3d, Vector3d)) &MappedSegments::setSoilGrid)
         .def("setRectangularGrid", &MappedSegments::setRectangularGrid)
-        .def("mapSegments",  &MappedSegments::mapSegments)
+        .def("setSoilIndices", [](MappedSegments& ms, py::function f) {
+            ms.setSoilIndices([f](const std::vector<double>& xyz, std::vector<int>& cells) {
+                py::array_t<double> points(std::vector<ssize_t>{ ssize_t(xyz.size()/3), 3 }, xyz.data()); // copy
+                auto r = py::array_t<int, py::array::c_style | py::array::forcecast>::ensure(f(points));
+                if (!r) {
+                    throw std::invalid_argument("MappedSegments.setSoilIndices: call back must return an array of cell indices");
+                }
+                cells.assign(r.data(), r.data()+r.size());
+            });
+        }) // call back takes a (n,3) array of points, and returns n cell indices
+        .def("mapSegments",  (void (MappedSegments::*)(const std::vector<Vector2i>&)) &MappedSegments::mapSegments)
         .def("cutSegments", &MappedSegments::cutSegments)
+        .def("cutGrid", [](const MappedSegments& ms, const Vector3d& p, const Vector3d& q) {
+            std::vector<double> t;
+            std::vector<int> cells;
+            ms.cutGrid(p, q, t, cells);
+            return std::make_pair(t, cells);
+        })
         .def_readwrite("soil_index", &MappedSegments::soil_index)
         .def("sort",&MappedSegments::sort)
         .def_readwrite("nodes", &MappedSegments::nodes)
@@ -770,11 +908,18 @@ PYBIND11_MODULE(plantbox, m) {
         .def_readwrite("segments", &MappedSegments::segments)
         .def_readwrite("radii", &MappedSegments::radii)
         .def_readwrite("types", &MappedSegments::types)
-        .def_readwrite("seg2cell", &MappedSegments::seg2cell)
-        .def_readwrite("cell2seg", &MappedSegments::cell2seg);
+        .def_property("seg2cell", &MappedSegments::getSeg2Cell, &MappedSegments::setSeg2Cell) // dict, unmapped segments are no keys
+        .def_property_readonly("cell2seg", &MappedSegments::getCell2Seg) // dict, converted on each access, prefer getCellSegments in loops
+        .def_property_readonly("cell2segStart", [](MappedSegments& ms) { ms.updateCell2Seg(); return ms.cell2segStart; })
+        .def_property_readonly("cell2segs", [](MappedSegments& ms) { ms.updateCell2Seg(); return ms.cell2segs; })
+        .def("getCellSegments", &MappedSegments::getCellSegments)
+        .def("getNumberOfCells", &MappedSegments::getNumberOfCells);
     py::class_<MappedRootSystem, RootSystem, MappedSegments,  std::shared_ptr<MappedRootSystem>>(m, "MappedRootSystem")
         .def(py::init<>())
         .def("mappedSegments",  &MappedRootSystem::mappedSegments)
+        .def_readonly("nodeMap", &MappedRootSystem::nodeMap)
+        .def_readonly("firstNewNode", &MappedRootSystem::firstNewNode)
+        .def_readonly("changedSegments", &MappedRootSystem::changedSegments)
         .def("addSegments", &MappedRootSystem::rootSystem);
     py::class_<XylemFlux, std::shared_ptr<XylemFlux>>(m, "XylemFlux")
             .def(py::init<std::shared_ptr<CPlantBox::MappedSegments>>())
@@ -784,6 +929,8 @@ PYBIND11_MODULE(plantbox, m) {
             .def("setKxTables",&XylemFlux::setKxTables)
             .def("linearSystem",&XylemFlux::linearSystem, py::arg("simTime") , py::arg("sx") , py::arg("cells") = true,
             		py::arg("soil_k") = std::vector<double>())
+            .def("solve",&XylemFlux::solve, py::arg("simTime"), py::arg("sx"), py::arg("cells"), py::arg("bcType"), py::arg("bcValue"),
+                    py::arg("soil_k") = std::vector<double>())
             .def("soilFluxes",&XylemFlux::soilFluxes, py::arg("simTime"), py::arg("rx"), py::arg("sx"), py::arg("approx") = false)
             .def("segFluxes",&XylemFlux::segFluxes, py::arg("simTime"), py::arg("rx"), py::arg("sx"), py::arg("approx") = false, py::arg("cells") = false)
             .def("sumSoilFluxes",&XylemFlux::sumSegFluxes)
@@ -792,15 +939,20 @@ PYBIND11_MODULE(plantbox, m) {
 			.def("segLength",&XylemFlux::segLength)
             .def("segSchroeder",&XylemFlux::segSchroeder)
             .def("segSchroederStressedFlux",&XylemFlux::segSchroederStressedFlux)
-            .def_readonly("kr_f", &XylemFlux::kr_f)
-            .def_readonly("kx_f", &XylemFlux::kx_f)
+            .def("kr_f", &XylemFlux::kr_f, py::arg("age"), py::arg("type"))
+            .def("kx_f", &XylemFlux::kx_f, py::arg("age"), py::arg("type"))
             .def_readwrite("aI", &XylemFlux::aI)
             .def_readwrite("aJ", &XylemFlux::aJ)
             .def_readwrite("aV", &XylemFlux::aV)
             .def_readwrite("aB", &XylemFlux::aB)
+            .def_readwrite("incremental", &XylemFlux::incremental)
             .def_readwrite("kr", &XylemFlux::kr)
             .def_readwrite("kx", &XylemFlux::kx)
             .def_readwrite("rs", &XylemFlux::rs);
+    py::enum_<XylemFlux::BCTypes>(m, "BCType")
+            .value("neumann", XylemFlux::BCTypes::bct_neumann)
+            .value("dirichlet", XylemFlux::BCTypes::bct_dirichlet)
+            .export_values();
     /*
      * Plant.h
      */
@@ -816,7 +968,7 @@ PYBIND11_MODULE(plantbox, m) {
             .def("initCallbacks", &Plant::initCallbacks)
             .def("createTropismFunction", &Plant::createTropismFunction)
             .def("createGrowthFunction", &Plant::createGrowthFunction)
-            .def("write", &Plant::write);
+            .def("write", &Plant::write, py::arg("name"), py::arg("format") = 0, py::arg("compress") = false);
     py::enum_<Plant::TropismTypes>(m, "TropismType")
             .value("plagio", Plant::TropismTypes::tt_plagio)
             .value("gravi", Plant::TropismTypes::tt_gravi)
@@ -843,13 +995,21 @@ PYBIND11_MODULE(plantbox, m) {
             .def_readwrite("n0", &ExudationModel::n0)
             .def_readwrite("thresh13", &ExudationModel::thresh13)
             .def_readwrite("calc13", &ExudationModel::calc13)
+            .def_readwrite("type13", &ExudationModel::type13)
             .def_readwrite("observationRadius", &ExudationModel::observationRadius)
+            .def_readwrite("numberOfThreads", &ExudationModel::numberOfThreads)
+            .def_readwrite("tileSize", &ExudationModel::tileSize)
+            .def_readwrite("incremental", &ExudationModel::incremental)
             .def("calculate",  &ExudationModel::calculate);
     py::enum_<ExudationModel::IntegrationType>(m, "IntegrationType")
             .value("mps_straight", ExudationModel::IntegrationType::mps_straight )
             .value("mps", ExudationModel::IntegrationType::mps )
             .value("mls", ExudationModel::IntegrationType::mls )
             .export_values();
+    py::enum_<ExudationModel::Integration13Type>(m, "Integration13Type")
+            .value("direct13", ExudationModel::Integration13Type::direct13 )
+            .value("separable13", ExudationModel::Integration13Type::separable13 )
+            .export_values();
 
     //   /*
     //    * sdf_rs.h todo revise
@@ -44,6 +44,7 @@ Root::Root(std::shared_ptr<Organism> rs, int type, Vector3d heading, double dela
     :Organ(rs, parent, Organism::ot_root, type, delay, heading, pbl, pni) // <- OrganRandomParameter::realize() is called here
 {
     assert(parent!=nullptr && "Root::Root parent must be set");
+    Organism::RandomScope scope(randomKey, 0, Organism::rp_rotation);
     double beta = 2*M_PI*plant.lock()->rand(); // initial rotation
     double theta = param()->theta;
     if (parent->organType()!=Organism::ot_seed) { // scale if not a baseRoot
@@ -70,6 +71,7 @@ std::shared_ptr<Organ> Root::copy(std::shared_ptr<Organism> rs)
     r->parent = std::weak_ptr<Organ>();
     r->plant = rs;
     r->param_ = std::make_shared<RootSpecificParameter>(*param()); // copy parameters
+    r->rrp_ = nullptr; // random parameters of the new plant
     for (size_t i=0; i< children.size(); i++) {
         r->children[i] = children[i]->copy(rs); // copy laterals
         r->children[i]->setParent(r);
@@ -77,6 +79,24 @@ std::shared_ptr<Organ> Root::copy(std::shared_ptr<Organism> rs)
     return r;
 }
 
+/**
+ * Copies the root into the new plant @param rs, sharing the specific parameters and the node data (@see Organ::fork).
+ *
+ * @param rs     the plant the copied organ will be part of
+ */
+std::shared_ptr<Organ> Root::fork(std::shared_ptr<Organism> rs)
+{
+    auto r = std::make_shared<Root>(*this); // shallow copy, shares parameters and node data
+    r->parent = std::weak_ptr<Organ>();
+    r->plant = rs;
+    r->rrp_ = nullptr; // random parameters of the new plant
+    for (size_t i=0; i< children.size(); i++) {
+        r->children[i] = children[i]->fork(rs); // fork laterals
+        r->children[i]->setParent(r);
+    }
+    return r;
+}
+
 /**
  * Simulates the development of the organ in a time span of @param dt days.
  *
@@ -88,6 +108,7 @@ void Root::simulate(double dt, bool verbose)
     firstCall = true;
     moved = false;
     oldNumberOfNodes = nodes.size();
+    updateCache(); // random parameters might have changed since the last time step
 
     const RootSpecificParameter& p = *param(); // rename
 
@@ -102,9 +123,10 @@ void Root::simulate(double dt, bool verbose)
 
         // probabilistic branching model
         if ((age>0) && (age-dt<=0)) { // the root emerges in this time step
-            double P = getRootRandomParameter()->f_sbp->getValue(nodes.back(),shared_from_this());
+            double P = rrp().f_sbp->getValue(nodes.back(),shared_from_this());
             if (P<1.) { // P==1 means the lateral emerges with probability 1 (default case)
                 double p = 1.-std::pow((1.-P), dt); //probability of emergence in this time step
+                Organism::RandomScope scope(randomKey, Organism::hashIndex(age), Organism::rp_emergence);
                 if (plant.lock()->rand()>p) { // not rand()<p
                     age -= dt; // the root does not emerge in this time step
                 }
@@ -131,7 +153,7 @@ void Root::simulate(double dt, bool verbose)
 
                 double targetlength = calcLength(age_+dt_);
                 double e = targetlength-length; // unimpeded elongation in time step dt
-                double scale = getRootRandomParameter()->f_se->getValue(nodes.back(), shared_from_this());
+                double scale = rrp().f_se->getValue(nodes.back(), shared_from_this());
                 double dl = std::max(scale*e, 0.); // length increment
                 // std::cout << "Root::simulate: " << dt_ << ", " << e <<  ", " << scale <<"\n"; // for debugging
 
@@ -187,7 +209,7 @@ void Root::simulate(double dt, bool verbose)
                     }
                 } // if lateralgetLengths
             } // if active
-            active = length<(p.getK()-dx()/10); // become inactive, if final length is nearly reached
+            active = length<(growth().k-dx()/10); // become inactive, if final length is nearly reached
         }
     } // if alive
 
@@ -210,6 +232,32 @@ double Root::calcCreationTime(double length, double dt)
     return a+nodeCTs[0];
 }
 
+/**
+ * Analytical creation (=emergence) times of points along the already grown root, @see Root::calcCreationTime
+ *
+ * @param lengths  lengths along the root, where the points are located [cm]
+ * @param dt       current time step [day]
+ * @return         the analytic times when the points were reached by the growing root [day]
+ */
+std::vector<double> Root::calcCreationTimes(const std::vector<double>& lengths, double dt)
+{
+    std::vector<double> ets(lengths.size());
+    const OrganGrowth& g = growth();
+    if (g.type==OrganGrowth::gt_generic) {
+        for (size_t i=0; i<lengths.size(); i++) {
+            ets[i] = calcAge(lengths[i]);
+        }
+    } else {
+        g.getAges(lengths.data(), lengths.size(), ets.data()); // root ages as if grown unimpeded
+    }
+    for (size_t i=0; i<lengths.size(); i++) {
+        double a = std::max(ets[i], age-dt);
+        a = std::min(a, age); // a in [age-dt, age]
+        ets[i] = a+nodeCTs[0];
+    }
+    return ets;
+}
+
 /**
  * Analytical length of the single root at a given age
  *
@@ -219,7 +267,11 @@ double Root::calcCreationTime(double length, double dt)
 double Root::calcLength(double age)
 {
     assert(age >= 0 && "Root::calcLength() negative root age");
-    return getRootRandomParameter()->f_gf->getLength(age,param()->r,param()->getK(), shared_from_this());
+    const OrganGrowth& g = growth();
+    if (g.type==OrganGrowth::gt_generic) {
+        return g.f->getLength(age,g.r,g.k, shared_from_this());
+    }
+    return g.getLength(age);
 }
 
 /**
@@ -231,7 +283,32 @@ double Root::calcLength(double age)
 double Root::calcAge(double length)
 {
     assert(length >= 0 && "Root::calcAge() negative root length");
-    return getRootRandomParameter()->f_gf->getAge(length,param()->r,param()->getK(), shared_from_this());
+    const OrganGrowth& g = growth();
+    if (g.type==OrganGrowth::gt_generic) {
+        return g.f->getAge(length,g.r,g.k, shared_from_this());
+    }
+    return g.getAge(length);
+}
+
+/**
+ * Length increment of this root in the next time step as if grown unimpeded, from the growth function only (i.e. without
+ * the elongation scale f_se, and without the laterals). Used as cheap estimate of the overall growth (@see RootSystem::simulateLimited).
+ *
+ * @param dt        time step [day]
+ * @return          unimpeded elongation [cm], zero for dead or inactive roots, and roots not emerging within the time step
+ */
+double Root::calcElongation(double dt)
+{
+    if (!alive || !active) {
+        return 0.;
+    }
+    updateCache(); // random parameters might have changed since the last time step
+    double dt_ = std::min(age+dt, param()->rlt) - std::max(age, 0.); // growth time within the time step
+    if (dt_<=0) {
+        return 0.;
+    }
+    double age_ = calcAge(length); // root age as if grown unimpeded
+    return std::max(calcLength(age_+dt_)-length, 0.);
 }
 
 /**
@@ -242,6 +319,16 @@ std::shared_ptr<RootRandomParameter> Root::getRootRandomParameter() const
     return std::static_pointer_cast<RootRandomParameter>(plant.lock()->getOrganRandomParameter(Organism::ot_root, param_->subType));
 }
 
+/**
+ * Caches the root random parameter, and resolves the growth function with the parameters r and k of this root (@see OrganGrowth),
+ * to avoid looking them up for each new node. Root::simulate() updates the cache, changed random parameters take effect in the next time step.
+ */
+void Root::updateCache() const
+{
+    rrp_ = getRootRandomParameter();
+    growth_ = OrganGrowth(rrp_->f_gf, param()->r, param()->getK());
+}
+
 /**
  * @return Parameters of the specific root
  */
@@ -259,11 +346,12 @@ std::shared_ptr<RootRandomParameter> Root::getRootRandomParameter() const
  */
 void Root::createLateral(double dt, bool verbose)
 {
-    int lt = getRootRandomParameter()->getLateralType(nodes.back());
+    Organism::RandomScope scope(randomKey, nodes.size()-1, Organism::rp_lateral);
+    int lt = rrp().getLateralType(nodes.back());
     if (lt>0) {
         double ageLN = this->calcAge(length); // age of root when lateral node is created
         ageLN = std::max(ageLN, age-dt);
-        double meanLn = getRootRandomParameter()->ln; // mean inter-lateral distance
+        double meanLn = rrp().ln; // mean inter-lateral distance
         double effectiveLa = std::max(param()->la-meanLn/2, 0.); // effective apical distance, observed apical distance is in [la-ln/2, la+ln/2]
         double ageLG = this->calcAge(length+effectiveLa); // age of the root, when the lateral starts growing (i.e when the apical zone is developed)
         double delay = ageLG-ageLN; // time the lateral has to wait
@@ -298,7 +386,7 @@ Vector3d Root::getIncrement(const Vector3d& p, double sdx)
 {
     Vector3d h = heading();
     Matrix3d ons = Matrix3d::ons(h);
-    Vector2d ab = getRootRandomParameter()->f_tf->getHeading(p, ons, dx(), shared_from_this());
+    Vector2d ab = rrp().f_tf->getHeading(p, ons, dx(), shared_from_this());
     Vector3d sv = ons.times(Vector3d::rotAB(ab.x,ab.y));
     return sv.times(sdx);
 }
@@ -337,10 +425,9 @@ void Root::createSegments(double l, double dt, bool verbose)
                 double sdx = olddx + shiftl; // length of new segment
                 // Vector3d newdxv = getIncrement(n2, sdx);
                 h.normalize();
-                nodes[nn-1] = Vector3d(n2.plus(h.times(sdx))); // n2.plus(newdxv)
                 double et = this->calcCreationTime(length+shiftl, dt);
-                nodeCTs[nn-1] = et; // in case of impeded growth the node emergence time is not exact anymore, but might break down to temporal resolution
-                moved = true;
+                // in case of impeded growth the node emergence time is not exact anymore, but might break down to temporal resolution
+                moveNode(nn-1, Vector3d(n2.plus(h.times(sdx))), et); // n2.plus(newdxv)
                 l -= shiftl;
                 if (l<=0) { // ==0 should be enough
                     return;
@@ -353,29 +440,31 @@ void Root::createSegments(double l, double dt, bool verbose)
         }
     }
     // create n+1 new nodes
-    double sl = 0; // summed length of created segment
-    int n = floor(l/dx());
-    for (int i = 0; i < n + 1; i++) {
-
-        double sdx; // segment length (<=dx)
-        if (i<n) {  // normal case
-            sdx = dx();
-        } else { // last segment
-            sdx = l-n*dx();
-            if (sdx<plant.lock()->getMinDx()) { // quit if l is too small
-                if (verbose) {
-                    std::cout << "skipped small segment ("<< sdx <<" < "<< plant.lock()->getMinDx() << ") \n";
-                }
-                return;
-            }
+    double dx_ = dx();
+    int n = floor(l/dx_);
+    double lastdx = l-n*dx_; // length of the last segment
+    int m = n+1; // number of new nodes
+    if (lastdx<plant.lock()->getMinDx()) { // skip the last segment if it is too small
+        if (verbose) {
+            std::cout << "skipped small segment ("<< lastdx <<" < "<< plant.lock()->getMinDx() << ") \n";
         }
-        sl += sdx;
+        m = n;
+    }
+    std::vector<double> ls(m); // lengths along the root of the new nodes
+    double sl = 0; // summed length of created segment
+    for (int i = 0; i < m; i++) {
+        sl += (i<n) ? dx_ : lastdx;
+        ls[i] = length+shiftl+sl;
+    }
+    // in case of impeded growth the node emergence time is not exact anymore,
+    // but might break down to temporal resolution
+    std::vector<double> ets = calcCreationTimes(ls, dt);
+    for (int i = 0; i < m; i++) {
+        double sdx = (i<n) ? dx_ : lastdx; // segment length (<=dx)
+        Organism::RandomScope scope(randomKey, nodes.size(), Organism::rp_tropism); // draws for the new node
         Vector3d newdx = getIncrement(nodes.back(), sdx);
         Vector3d newnode = Vector3d(nodes.back().plus(newdx));
-        double et = this->calcCreationTime(length+shiftl+sl, dt);
-        // in case of impeded growth the node emergence time is not exact anymore,
-        // but might break down to temporal resolution
-        addNode(newnode, et);
+        addNode(newnode, ets[i]);
     }
 }
 
@@ -31,6 +31,7 @@ public:
     virtual ~Root() { }; ///< no need to do anything, children are deleted in ~Organ()
 
     std::shared_ptr<Organ> copy(std::shared_ptr<Organism> rs) override;  ///< deep copies the root tree
+    std::shared_ptr<Organ> fork(std::shared_ptr<Organism> rs) override;  ///< copies the root tree, sharing parameters and node data
 
     int organType() const override { return Organism::ot_root; }; ///< returns the organs type
 
@@ -45,11 +46,13 @@ public:
     double calcCreationTime(double length, double dt); ///< analytical creation (=emergence) time of a node at a length
     double calcLength(double age); ///< analytical length of the root
     double calcAge(double length); ///< analytical age of the root
+    std::vector<double> calcCreationTimes(const std::vector<double>& lengths, double dt); ///< analytical creation times of nodes at multiple lengths
+    double calcElongation(double dt); ///< unimpeded length increment of this root (without laterals) in the next time step
 
     /* Abbreviations */
     std::shared_ptr<RootRandomParameter> getRootRandomParameter() const;  ///< root type parameter of this root
     std::shared_ptr<const RootSpecificParameter> param() const; ///< root parameter
-    double dx() const { return getRootRandomParameter()->dx; } ///< returns the axial resolution
+    double dx() const { return rrp().dx; } ///< returns the axial resolution
 
 protected:
 
@@ -61,6 +64,13 @@ protected:
 
     bool firstCall = true; ///< firstCall of createSegments in simulate
 
+    void updateCache() const; ///< caches the root random parameter and the growth function, called by Root::simulate()
+    RootRandomParameter& rrp() const { if (!rrp_) { updateCache(); } return *rrp_; } ///< cached root random parameter
+    const OrganGrowth& growth() const { if (!rrp_) { updateCache(); } return growth_; } ///< cached growth function with the parameters of this root
+
+    mutable std::shared_ptr<RootRandomParameter> rrp_; ///< cached root random parameter (nullptr if not set)
+    mutable OrganGrowth growth_; ///< cached growth function
+
 };
 
 } // end namespace CPlantBox
@@ -15,6 +15,7 @@ std::shared_ptr<Organ> RootDelay::copy(std::shared_ptr<Organism> rs)
     r->parent = std::weak_ptr<Organ>();
     r->plant = rs;
     r->param_ = std::make_shared<RootSpecificParameter>(*param()); // copy parameters
+    r->rrp_ = nullptr; // random parameters of the new plant
     for (size_t i=0; i< children.size(); i++) {
         r->children[i] = children[i]->copy(rs); // copy laterals
         r->children[i]->setParent(r);
@@ -22,6 +23,24 @@ std::shared_ptr<Organ> RootDelay::copy(std::shared_ptr<Organism> rs)
     return r;
 }
 
+/**
+ * Copies the root into the new plant @param rs, sharing the specific parameters and the node data (@see Organ::fork).
+ *
+ * @param rs     the plant the copied organ will be part of
+ */
+std::shared_ptr<Organ> RootDelay::fork(std::shared_ptr<Organism> rs)
+{
+    auto r = std::make_shared<RootDelay>(*this); // shallow copy, shares parameters and node data
+    r->parent = std::weak_ptr<Organ>();
+    r->plant = rs;
+    r->rrp_ = nullptr; // random parameters of the new plant
+    for (size_t i=0; i< children.size(); i++) {
+        r->children[i] = children[i]->fork(rs); // fork laterals
+        r->children[i]->setParent(r);
+    }
+    return r;
+}
+
 /**
  * @return Quick info about the object for debugging
  * additionally, use getParam()->toString() and getOrganRandomParameter()->toString() to obtain all information.
@@ -46,6 +65,7 @@ void RootDelay::createLateral(double dt, bool verbose)
 {
 	// std::cout<< "create delayed root\n";
 	auto rrp = getRootRandomParameter(); // rename
+    Organism::RandomScope scope(randomKey, nodes.size()-1, Organism::rp_lateral);
     int lt = rrp->getLateralType(nodes.back());
     if (lt>0) {
     	double delay = std::max(rrp->ldelay + plant.lock()->randn()*rrp->ldelays, 0.);
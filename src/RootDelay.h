@@ -3,6 +3,7 @@
 #define ROOTDELAY_H_
 
 #include "Root.h"
+#include "Checkpoint.h"
 
 namespace CPlantBox {
 
@@ -20,7 +21,9 @@ public:
 
     using Root::Root;
     std::shared_ptr<Organ> copy(std::shared_ptr<Organism> rs) override;  ///< deep copies the root tree
+    std::shared_ptr<Organ> fork(std::shared_ptr<Organism> rs) override;  ///< copies the root tree, sharing parameters and node data
     std::string toString() const override;
+    int checkpointClass() const override { return Checkpoint::oc_rootDelay; } ///< class of the organ in a checkpoint
 
 	protected:
     void createLateral(double dt, bool silence) override; ///< creates a new lateral based on a delay
@@ -4,6 +4,8 @@
 #include "organparameter.h"
 #include "Organism.h"
 #include "RootDelay.h"
+#include "VTKWriter.h"
+#include "Checkpoint.h"
 
 namespace CPlantBox {
 
@@ -20,8 +22,33 @@ std::shared_ptr<Organism> RootSystem::copy()
 {
     roots.clear(); // clear buffer
     auto nrs = std::make_shared<RootSystem>(*this); // copy constructor
-    nrs->seed = std::static_pointer_cast<Seed>(seed->copy(nrs));
-    baseOrgans = nrs->seed->copyBaseOrgans();
+    if (seed) { // not initialized yet
+        nrs->seed = std::static_pointer_cast<Seed>(seed->copy(nrs));
+    }
+    for (size_t i = 0; i < baseOrgans.size(); i++) {
+        nrs->baseOrgans[i] = baseOrgans[i]->copy(nrs);
+    }
+    for (int ot = 0; ot < numberOfOrganTypes; ot++) { // copy organ type parameters
+        for (auto& otp : nrs->organParam[ot]) {
+            otp.second = otp.second->copy(nrs);
+        }
+    }
+    return nrs;
+}
+
+/**
+ * Copies the root system for scenario branching (@see Organism::fork)
+ */
+std::shared_ptr<Organism> RootSystem::fork()
+{
+    roots.clear(); // clear buffer
+    auto nrs = std::make_shared<RootSystem>(*this); // copy constructor
+    if (seed) { // not initialized yet
+        nrs->seed = seed->forkSeed(nrs); // without its children, which are not simulated
+    }
+    for (size_t i = 0; i < baseOrgans.size(); i++) {
+        nrs->baseOrgans[i] = baseOrgans[i]->fork(nrs);
+    }
     for (int ot = 0; ot < numberOfOrganTypes; ot++) { // copy organ type parameters
         for (auto& otp : nrs->organParam[ot]) {
             otp.second = otp.second->copy(nrs);
@@ -77,6 +104,9 @@ void RootSystem::reset()
     simtime = 0;
     organId = -1;
     nodeId = -1;
+    nodeStore.clear();
+    updatedNodes.clear();
+    registry.clear();
 }
 
 /**
@@ -226,6 +256,7 @@ void RootSystem::initialize_(int basal, int shootborne, bool verbose)
     seed->initialize(verbose);
     seedParam = SeedSpecificParameter(*seed->param()); // copy the specific parameters
     baseOrgans = seed->copyBaseOrgans();
+    organsChanged();
     oldNumberOfNodes = baseOrgans.size();
     initCallbacks();
 }
@@ -345,6 +376,74 @@ void RootSystem::simulate(double dt, double maxinc_, ProportionalElongation* se,
     this->simulate(dt, verbose);
 }
 
+/**
+ * Simulates root system growth for a time span, elongates a maximum of @param maxinc total length [cm/day],
+ * with the same result as RootSystem::simulate(dt, maxinc, se) within its accuracy, but with less trial simulations.
+ *
+ * The scale of the proportional elongation @param se is first estimated from the unimpeded elongations of the active roots
+ * (@see Root::calcElongation), that are proportional to the scale. The estimate is corrected by secant steps on the
+ * length increments of trial simulations, safeguarded by the bracket of the binary search. The last trial simulation is kept,
+ * if it is within the accuracy.
+ *
+ * @param dt        time step [day]
+ * @param maxinc_   maximal total length [cm/day] the root system is allowed to grow in this time step
+ * @param se        The class ProportionalElongation is used to scale overall root growth
+ * @param verbose   indicates if status is written to the console (cout) (default = false)
+ */
+void RootSystem::simulateLimited(double dt, double maxinc_, ProportionalElongation* se, bool verbose)
+{
+    const double accuracy = 1.e-3; // as RootSystem::simulate(dt, maxinc, se)
+    const int maxiter = 20;
+    double maxinc = dt*maxinc_; // [cm]
+    double ol = getSummed("length");
+
+    se->setScale(1.);
+    double e = 0.; // estimated increase for scale 1
+    for (const auto& r : getRoots()) {
+        double dl = r->calcElongation(dt);
+        if (dl>0) {
+            e += dl*r->getRootRandomParameter()->f_se->getValue(r->getNode(r->getNumberOfNodes()-1), r);
+        }
+    }
+    double s = (e>maxinc) ? maxinc/e : 1.; // scale
+    if (verbose) {
+        std::cout << "estimated increase is " << e << " maximum is " << maxinc << ", scale " << s << "\n";
+    }
+
+    double sl = 0.; // left
+    double sr = 1.; // right
+    double s0 = 0., i0 = 0.; // previous trial (scale, increase), no growth for scale 0
+    for (int i=0; i<maxiter; i++) {
+        push();
+        se->setScale(s);
+        simulate(dt, verbose);
+        double inc_ = getSummed("length") - ol;
+        if (verbose) {
+            std::cout << "\t(sl, s, sr) = (" << sl << ", " <<  s << ", " <<  sr << "), inc " <<  inc_ << ", err: " << std::abs(inc_-maxinc) << "\n";
+        }
+        if (((s==1.) && (inc_<=maxinc)) || (std::abs(inc_-maxinc)<=accuracy) || (i==maxiter-1)) {
+            stateStack.pop(); // keep the trial
+            return;
+        }
+        pop();
+        if (inc_>maxinc) {
+            sr = s;
+        } else {
+            sl = s;
+        }
+        double sn = (sl+sr)/2.; // bisection
+        if (inc_!=i0) { // secant step
+            double ss = s + (maxinc-inc_)*(s-s0)/(inc_-i0);
+            if ((ss>sl) && (ss<sr)) {
+                sn = ss;
+            }
+        }
+        s0 = s;
+        i0 = inc_;
+        s = sn;
+    }
+}
+
 /**
  * Creates a specific tropism from the tropism type index.
  * the function must be extended or overwritten to add more tropisms.
@@ -386,18 +485,15 @@ std::shared_ptr<GrowthFunction>  RootSystem::createGrowthFunction(int gft) {
 
 /**
  * Represents the root system as sequential vector of roots, copies the root only, if it has more than 1 node.
- * buffers the result, until next call of simulate(dt), a bit redundant to @see Organsim::getOrgans().
+ * buffers the result, until next call of simulate(dt), taken from the cached organ list (@see Organsim::getOrgans()).
  *
  * \return sequential vector of roots with more than 1 node
  */
 std::vector<std::shared_ptr<Root>> RootSystem::getRoots() const
 {
     if (roots.empty()) { // create buffer
-        std::vector<std::shared_ptr<Organ>> organs;
-        organs.reserve(getNumberOfOrgans()); // for speed up
-        for (const auto& br : this->baseOrgans) {
-            br->getOrgans(ot_root, organs);
-        }
+        auto organs = getOrgans(ot_root);
+        roots.reserve(organs.size());
         for (auto& o :organs) {
             roots.push_back(std::static_pointer_cast<Root>(o));
         }
@@ -488,6 +584,49 @@ void RootSystem::pop()
     stateStack.pop();
 }
 
+/**
+ * @copydoc Organism::writeCheckpoint
+ */
+void RootSystem::writeCheckpoint(std::ostream& os) const
+{
+    Organism::writeCheckpoint(os);
+    seedParam.writeCheckpoint(os);
+    Checkpoint::write(os, numberOfCrowns);
+    Checkpoint::write(os, bool(seed));
+    if (seed) {
+        Checkpoint::write(os, seed->checkpointClass());
+        seed->writeCheckpoint(os);
+    }
+}
+
+/**
+ * @copydoc Organism::readCheckpoint
+ *
+ * Tropisms and growth functions are created like in RootSystem::initialize, i.e. set the confining geometry and
+ * the soil before, and manually set tropisms afterwards. The stack of RootSystem::push is emptied.
+ */
+void RootSystem::readCheckpoint(std::istream& is)
+{
+    Organism::readCheckpoint(is);
+    seedParam.readCheckpoint(is);
+    Checkpoint::read(is, numberOfCrowns);
+    bool hasSeed;
+    Checkpoint::read(is, hasSeed);
+    seed = nullptr;
+    if (hasSeed) {
+        int oc;
+        Checkpoint::read(is, oc);
+        seed = std::dynamic_pointer_cast<Seed>(Checkpoint::createOrgan(oc));
+        if (!seed) {
+            throw std::invalid_argument("RootSystem::readCheckpoint: corrupted checkpoint");
+        }
+        seed->readCheckpoint(is, shared_from_this());
+    }
+    roots.clear();
+    stateStack = std::stack<RootSystemState>();
+    initCallbacks();
+}
+
 /**
  * @return quick info about the root system for debugging
  */
@@ -506,8 +645,10 @@ std::string RootSystem::toString() const
  * todo move to Organism
  *
  * @param name      file name e.g. output.vtp
+ * @param format    vtp data format (VTKWriter::Formats): ascii (default), appended raw, or appended base64
+ * @param compress  zlib compression of binary vtp data
  */
-void RootSystem::write(std::string name) const
+void RootSystem::write(std::string name, int format, bool compress) const
 {
     std::string ext = name.substr(name.size()-3,name.size()); // pick the right writer
     if (ext.compare("sml")==0) {
@@ -516,8 +657,8 @@ void RootSystem::write(std::string name) const
     } else if (ext.compare("vtp")==0) {
         std::cout << "writing VTP... "<< name.c_str() <<"\n";
         std::ofstream fos;
-        fos.open(name.c_str());
-        writeVTP(fos);
+        fos.open(name.c_str(), std::ios::binary);
+        writeVTP(fos, format, compress);
         fos.close();
     } else if (ext.compare(".py")==0)  {
         std::cout << "writing Geometry ... "<< name.c_str() <<"\n";
@@ -537,74 +678,76 @@ void RootSystem::write(std::string name) const
  * Use SegmentAnalyser::writeVTP() for a representation based on segments,
  * e.g. for creating a movie (and run the animate.py script), or mapping values to segments
  *
- * todo use tinyxml2, move to Organism
+ * todo move to Organism
  *
- * @param os      typically a file out stream
+ * @param os        typically a file out stream (opened in binary mode for raw data)
+ * @param format    data format (VTKWriter::Formats): ascii (default), appended raw, or appended base64
+ * @param compress  zlib compression of binary data
  */
-void RootSystem::writeVTP(std::ostream & os) const
+void RootSystem::writeVTP(std::ostream & os, int format, bool compress) const
 {
     this->getRoots(); // update roots (if necessary)
     const auto& nodes = getPolylines();
     const auto& times = getPolylineCTs();
 
-    os << "<?xml version=\"1.0\"?>";
-    os << "<VTKFile type=\"PolyData\" version=\"0.1\" byte_order=\"LittleEndian\">\n";
-    os << "<PolyData>\n";
+    VTKWriter w(os, format, compress);
+    w.beginFile("PolyData");
     int non = 0; // number of nodes
     for (const auto& r : roots) {
         non += r->getNumberOfNodes();
     }
     int nol=roots.size(); // number of lines
-    os << "<Piece NumberOfLines=\""<< nol << "\" NumberOfPoints=\""<<non<<"\">\n";
+    w.openElement("Piece", "NumberOfLines=\""+std::to_string(nol)+"\" NumberOfPoints=\""+std::to_string(non)+"\"");
     // POINTDATA
-    os << "<PointData Scalars=\" PointData\">\n" << "<DataArray type=\"Float32\" Name=\"time\" NumberOfComponents=\"1\" format=\"ascii\" >\n";
+    std::vector<float> time;
+    time.reserve(non);
     for (const auto& r: times) {
-        for (const auto& t : r) {
-            os << t << " ";
-        }
+        time.insert(time.end(), r.begin(), r.end());
     }
-    os << "\n</DataArray>\n" << "\n</PointData>\n";
+    w.openElement("PointData", "Scalars=\" PointData\"");
+    w.dataArray("time", time);
+    w.closeElement("PointData");
     // CELLDATA (live on the polylines)
-    os << "<CellData Scalars=\"CellData\">\n";
+    w.openElement("CellData", "Scalars=\"CellData\"");
     const size_t N = 3; // SCALARS
     std::string scalarTypeNames[N] = { "radius", "subType", "creationTime" };
     for (size_t i=0; i<N; i++) {
-        os << "<DataArray type=\"Float32\" Name=\"" << scalarTypeNames[i] <<"\" NumberOfComponents=\"1\" format=\"ascii\" >\n";
         auto scalars = getParameter(scalarTypeNames[i]);
-        for (auto s : scalars) {
-            os << s<< " ";
-        }
-        os << "\n</DataArray>\n";
+        w.dataArray(scalarTypeNames[i], std::vector<float>(scalars.begin(), scalars.end()));
     }
-    os << "\n</CellData>\n";
+    w.closeElement("CellData");
     // POINTS (=nodes)
-    os << "<Points>\n"<<"<DataArray type=\"Float32\" Name=\"Coordinates\" NumberOfComponents=\"3\" format=\"ascii\" >\n";
+    std::vector<float> points;
+    points.reserve(3*non);
     for (const auto& r : nodes) {
         for (const auto& n : r) {
-            os << n.x << " "<< n.y <<" "<< n.z<< " ";
+            points.push_back(n.x);
+            points.push_back(n.y);
+            points.push_back(n.z);
         }
     }
-    os << "\n</DataArray>\n"<< "</Points>\n";
+    w.openElement("Points");
+    w.dataArray("Coordinates", points, 3);
+    w.closeElement("Points");
     // LINES (polylines)
-    os << "<Lines>\n"<<"<DataArray type=\"Int32\" Name=\"connectivity\" NumberOfComponents=\"1\" format=\"ascii\" >\n";
+    std::vector<int32_t> connectivity(non);
+    std::vector<int32_t> offsets;
+    offsets.reserve(nol);
     int c=0;
     for (const auto& r : roots) {
         for (size_t i=0; i<r->getNumberOfNodes(); i++) {
-            os << c << " ";
+            connectivity[c] = c;
             c++;
         }
+        offsets.push_back(c);
     }
-    os << "\n</DataArray>\n"<<"<DataArray type=\"Int32\" Name=\"offsets\" NumberOfComponents=\"1\" format=\"ascii\" >\n";
-    c = 0;
-    for (const auto& r : roots) {
-        c += r->getNumberOfNodes();
-        os << c << " ";
-    }
-    os << "\n</DataArray>\n";
-    os << "\n</Lines>\n";
+    w.openElement("Lines");
+    w.dataArray("connectivity", connectivity);
+    w.dataArray("offsets", offsets);
+    w.closeElement("Lines");
 
-    os << "</Piece>\n";
-    os << "</PolyData>\n" << "</VTKFile>\n";
+    w.closeElement("Piece");
+    w.endFile();
 }
 
 /**
@@ -630,7 +773,7 @@ void RootSystem::writeGeometry(std::ostream & os) const
  *
  * @param rs        the root system to be stored
  */
-RootSystemState::RootSystemState(const RootSystem& rs) : simtime(rs.simtime), rid(rs.organId), old_non(rs.oldNumberOfNodes), old_nor(rs.oldNumberOfOrgans),
+RootSystemState::RootSystemState(const RootSystem& rs) : simtime(rs.simtime), rid(rs.organId), nid(rs.nodeId), old_non(rs.oldNumberOfNodes), old_nor(rs.oldNumberOfOrgans),
     numberOfCrowns(rs.numberOfCrowns), gen(rs.gen), UD(rs.UD), ND(rs.ND)
 {
     baseRoots = std::vector<RootState>(rs.baseOrgans.size()); // store base roots
@@ -659,6 +802,8 @@ void RootSystemState::restore(RootSystem& rs)
     for (size_t i=0; i<baseRoots.size(); i++) { // restore base roots
         baseRoots[i].restore(*(std::static_pointer_cast<Root>(rs.baseOrgans[i])));
     }
+    rs.organsChanged();
+    rs.storeNodes(0); // rebuild the node store
 }
 
 /**
@@ -693,9 +838,9 @@ void RootState::restore(Root& r)
     r.nodes.resize(non); // shrink vectors
     r.nodeIds.resize(non);
     r.nodeCTs.resize(non);
-    r.nodes.back() = lNode; // restore last value
-    r.nodeIds.back() = lNodeId;
-    r.nodeCTs.back() = lneTime;
+    r.nodes.modify().back() = lNode; // restore last value
+    r.nodeIds.modify().back() = lNodeId;
+    r.nodeCTs.modify().back() = lneTime;
     r.children.resize(laterals.size()); // shrink and restore laterals
     for (size_t i=0; i<laterals.size(); i++) {
         laterals[i].restore(*(std::static_pointer_cast<Root>(r.children[i])));
@@ -39,6 +39,7 @@ public:
     virtual ~RootSystem() { };
 
     std::shared_ptr<Organism> copy() override; ///< deep copies the organism
+    std::shared_ptr<Organism> fork() override; ///< copies the organism for scenario branching, node data is copied on write
 
     /* Parameter input output */
     std::shared_ptr<RootRandomParameter> getRootRandomParameter(int type) const;///< returns the i-th root parameter set (i=1..n)
@@ -67,6 +68,8 @@ public:
     void simulate(); ///< simulates root system growth for the time defined in the root system parameters
     void simulate(double dt, double maxinc, ProportionalElongation* se, bool silence = false);
     ///< simulates the root system with a maximal overall elongation
+    void simulateLimited(double dt, double maxinc, ProportionalElongation* se, bool verbose = false);
+    ///< simulates the root system with a maximal overall elongation, scale from a cheap growth model (faster than the binary search)
 
     /* sequential */
     std::vector<std::shared_ptr<Root>> getRoots() const; ///< represents the root system as sequential vector of roots and buffers the result
@@ -93,12 +96,17 @@ public:
     void pop(); ///< retrieve previous state from stack
 
     /* Output */
-    void write(std::string name) const; /// writes simulation results (type is determined from file extension in name)
-    void writeVTP(std::ostream & os) const; ///< writes current simulation results as VTP (VTK polydata file)
+    void write(std::string name, int format = 0, bool compress = false) const; /// writes simulation results (type is determined from file extension in name)
+    void writeVTP(std::ostream & os, int format = 0, bool compress = false) const; ///< writes current simulation results as VTP (VTK polydata file)
     void writeGeometry(std::ostream & os) const; ///< writes the current confining geometry (e.g. a plant container) as paraview Python script
 
     std::string toString() const override; ///< infos about current root system state (for debugging)
 
+protected:
+
+    void writeCheckpoint(std::ostream& os) const override; ///< additionally writes the seed
+    void readCheckpoint(std::istream& is) override; ///< additionally reads the seed, and sets up the call backs
+
 private:
 
     void initialize_(int basal = 4, int shootborne = 5, bool verbose = true);
@@ -3,6 +3,7 @@
 
 #include "Root.h"
 #include "Stem.h"
+#include "Checkpoint.h"
 
 namespace CPlantBox {
 
@@ -35,6 +36,38 @@ std::shared_ptr<Organ> Seed::copy(std::shared_ptr<Organism> rs)
 	return s;
 }
 
+/**
+ * Copies the seed into the new plant @param rs, sharing the specific parameters and the node data (@see Organ::fork).
+ *
+ * @param rs     the plant the copied organ will be part of
+ */
+std::shared_ptr<Organ> Seed::fork(std::shared_ptr<Organism> rs)
+{
+	auto s = std::make_shared<Seed>(*this); // shallow copy, shares parameters and node data
+	s->parent = std::weak_ptr<Organ>();
+	s->plant = rs;
+	for (size_t i=0; i< children.size(); i++) {
+		s->children[i] = children[i]->fork(rs); // fork laterals
+		s->children[i]->setParent(s);
+	}
+	return s;
+}
+
+/**
+ * Copies the seed organ into the new plant @param rs, without its children. A RootSystem simulates copies of the
+ * base organs (@see Seed::copyBaseOrgans), the children of its seed are only the initial organs, and need no fork.
+ *
+ * @param rs     the plant the copied seed will be part of
+ */
+std::shared_ptr<Seed> Seed::forkSeed(std::shared_ptr<Organism> rs) const
+{
+	auto s = std::make_shared<Seed>(*this); // shallow copy, shares parameters and node data
+	s->parent = std::weak_ptr<Organ>();
+	s->plant = rs;
+	s->children.clear();
+	return s;
+}
+
 /**
  * Creates the initial organs,
  * i.e. taproot, basal root, (if needed) shoot borne root (if plant) stem
@@ -212,6 +245,28 @@ std::string Seed::toString() const
 	return str;
 }
 
+/**
+ * @copydoc Organ::writeCheckpoint
+ */
+void Seed::writeCheckpoint(std::ostream& os) const
+{
+	Organ::writeCheckpoint(os);
+	for (int v : { tapType, basalType, shootborneType, mainStemType, tillerType, numberOfRootCrowns }) {
+		Checkpoint::write(os, v);
+	}
+}
+
+/**
+ * @copydoc Organ::readCheckpoint
+ */
+void Seed::readCheckpoint(std::istream& is, std::shared_ptr<Organism> plant)
+{
+	Organ::readCheckpoint(is, plant);
+	for (int* v : { &tapType, &basalType, &shootborneType, &mainStemType, &tillerType, &numberOfRootCrowns }) {
+		Checkpoint::read(is, *v);
+	}
+}
+
 /**
  * todo doc
  */
@@ -25,11 +25,16 @@ public:
     virtual ~Seed() { };
 
     std::shared_ptr<Organ> copy(std::shared_ptr<Organism> rs) override;  ///< deep copies the seed
+    std::shared_ptr<Organ> fork(std::shared_ptr<Organism> rs) override;  ///< copies the seed, sharing parameters and node data
+    std::shared_ptr<Seed> forkSeed(std::shared_ptr<Organism> rs) const; ///< copies the seed without its children (@see RootSystem::fork)
 
     virtual int organType() const override { return Organism::ot_seed; }
 
     virtual std::string toString() const override;
 
+    void writeCheckpoint(std::ostream& os) const override; ///< writes the seed and its base organs into a binary checkpoint
+    void readCheckpoint(std::istream& is, std::shared_ptr<Organism> plant) override; ///< reads the seed and its base organs from a binary checkpoint
+
     void initialize(bool verbose = true);
 
     std::shared_ptr<const SeedSpecificParameter> param() const { return std::static_pointer_cast<const SeedSpecificParameter>(param_); }
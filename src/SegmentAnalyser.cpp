@@ -4,11 +4,14 @@
 #include "Organ.h"
 #include "Organism.h"
 #include "MappedOrganism.h"
+#include "VTKWriter.h"
 
 #include <iomanip>
 #include <istream>
 #include <fstream>
 #include <set>
+#include <map>
+#include <algorithm>
 #include <math.h>
 
 namespace CPlantBox {
@@ -29,8 +32,8 @@ SegmentAnalyser::SegmentAnalyser(const std::vector<Vector3d>& nodes, const std::
 {
     assert((segments.size() == segCTs.size()) && "SegmentAnalyser::SegmentAnalyser(): Unequal vector sizes");
     assert((segments.size() == radii.size()) && "SegmentAnalyser::SegmentAnalyser(): Unequal vector sizes");
-    data["creationTime"] = segCTs;
-    data["radius"] = radii;
+    column("creationTime") = segCTs;
+    column("radius") = radii;
     segO = std::vector<std::weak_ptr<Organ>>(segments.size()); // create expired
 }
 
@@ -46,18 +49,19 @@ SegmentAnalyser::SegmentAnalyser(const Organism& plant)
     segments = plant.getSegments();
     auto segCTs = plant.getSegmentCTs();
     assert(segments.size()==segCTs.size() && "SegmentAnalyser::SegmentAnalyser(Organism p): Unequal vector sizes");
-    data["creationTime"] = segCTs;
+    column("creationTime") = segCTs;
     auto sego = plant.getSegmentOrigins();
+    const auto& ns = plant.getNodeStore();
     segO = std::vector<std::weak_ptr<Organ>>(segments.size());
     auto radii = std::vector<double>(segments.size());
     auto types = std::vector<double>(segments.size());
     for (size_t i=0; i<segments.size(); i++) {
         segO[i] = sego[i]; // convert shared_ptr to weak_ptr
-        radii[i] = segO[i].lock()->getParameter("radius");
-        types[i] = segO[i].lock()->getParameter("type");
+        radii[i] = ns.radius[segments[i].y];
+        types[i] = ns.subType[segments[i].y];
     }
-    data["radius"] = radii;
-    data["subType"] = types;
+    column("radius") = radii;
+    column("subType") = types;
 }
 
 /**
@@ -77,9 +81,9 @@ SegmentAnalyser::SegmentAnalyser(const MappedSegments& plant) :nodes(plant.nodes
         segCTs.push_back(plant.nodeCTs.at(segments[i].y));
         typesd[i] = double(plant.types[i]);
     }
-    data["creationTime"] = segCTs;
-    data["radius"] = plant.radii;
-    data["subType"] = typesd;
+    column("creationTime") = segCTs;
+    column("radius") = plant.radii;
+    column("subType") = typesd;
 }
 
 /**
@@ -93,7 +97,7 @@ void SegmentAnalyser::addSegments(const Organism& plant)
 /**
  * Adds all line segments from the analyser @param a to this analysis.
  *
- * Ignores any user data from @param a.
+ * User data are appended, if they exist in both analysers, otherwise they are removed.
  */
 void SegmentAnalyser::addSegments(const SegmentAnalyser& a)
 {
@@ -107,13 +111,13 @@ void SegmentAnalyser::addSegments(const SegmentAnalyser& a)
     segments.insert(segments.end(),ns.begin(),ns.end()); // copy segments
     segO.insert(segO.end(),a.segO.begin(),a.segO.end());// copy origins
     assert(segments.size() == segO.size() && "SegmentAnalyser::addSegments(): Unequal vector sizes" );
-    for(auto iter = data.begin(); iter != data.end(); ++iter) {
-        std::string key =  iter->first;
-        if (a.data.count(key)>=0) {
-            data[key].insert(data[key].end(),a.data.at(key).begin(),a.data.at(key).end());
-            assert(segments.size() == data[key].size() && "SegmentAnalyser::addSegments(): Unequal vector sizes" );
+    for (int k = columnNames.size()-1; k>=0; k--) {
+        int id = a.getDataId(columnNames[k]);
+        if (id>=0) {
+            columns[k].insert(columns[k].end(), a.columns[id].begin(), a.columns[id].end());
+            assert(segments.size() == columns[k].size() && "SegmentAnalyser::addSegments(): Unequal vector sizes" );
         } else {
-            data.erase(key);
+            removeColumn(columnNames[k]);
         }
     }
 }
@@ -131,19 +135,22 @@ void SegmentAnalyser::addSegment(Vector2i seg, double ct, double radius, bool in
 {
     if (insert) {
         segments.insert(segments.begin(),seg);
-        data["creationTime"].insert(data["creationTime"].begin(),ct);
+        auto& cts = column("creationTime");
+        cts.insert(cts.begin(),ct);
         segO.insert(segO.begin(),std::weak_ptr<Organ>()); // expired
-        data["radius"].insert(data["radius"].begin(),radius);
-        if (data.count("subType")>0) {
-            data["subType"].insert(data["subType"].begin(), -1.);
+        auto& radii = column("radius");
+        radii.insert(radii.begin(),radius);
+        if (hasData("subType")) {
+            auto& types = column("subType");
+            types.insert(types.begin(), -1.);
         }
     } else {
         segments.push_back(seg);
-        data["creationTime"].push_back(ct);
+        column("creationTime").push_back(ct);
         segO.push_back(std::weak_ptr<Organ>()); // expired
-        data["radius"].push_back(radius);
-        if (data.count("subType")>0) {
-            data["subType"].push_back(-1.);
+        column("radius").push_back(radius);
+        if (hasData("subType")) {
+            column("subType").push_back(-1.);
         }
     }
 }
@@ -162,8 +169,9 @@ void SegmentAnalyser::addSegment(Vector2i seg, double ct, double radius, bool in
  */
 std::vector<double> SegmentAnalyser::getParameter(std::string name, double def) const
 {
-    if (data.count(name)) { // first, check data
-        return data.at(name);
+    int id = getDataId(name);
+    if (id>=0) { // first, check data
+        return columns[id];
     }
     std::vector<double> d(segments.size()); // make return vector
     if (name == "length") {
@@ -173,14 +181,16 @@ std::vector<double> SegmentAnalyser::getParameter(std::string name, double def)
         return d;
     }
     if (name == "surface") {
+        const auto& radii = getData("radius");
         for (size_t i=0; i<d.size(); i++) {
-            d.at(i) = 2*data.at("radius")[i]*M_PI*getSegmentLength(i);
+            d.at(i) = 2*radii[i]*M_PI*getSegmentLength(i);
         }
         return d;
     }
     if (name == "volume") {
+        const auto& radii = getData("radius");
         for (size_t i=0; i<d.size(); i++) {
-            double a = data.at("radius")[i];
+            double a = radii[i];
             d.at(i) = a*a*M_PI*getSegmentLength(i);
         }
         return d;
@@ -218,27 +228,23 @@ double SegmentAnalyser::getSegmentLength(int i) const
  *
  * All nodes are kept, use pack() to remove unused nodes.
  *
+ * Each node is classified once, most nodes by the bounding and inner box of the geometry,
+ * the signed distance function is only evaluated for nodes in between, as one batch (@see SDF_Bounds::isInside).
+ *
  * @param geometry      signed distance function of the geometry
  */
 void SegmentAnalyser::crop(std::shared_ptr<SignedDistanceFunction> geometry)
 {
     //std::cout << "cropping " << segments.size() << " segments...";
-    std::vector<Vector2i> seg;
-    std::vector<std::weak_ptr<Organ>> sO;
-    std::map<std::string, std::vector<double>> ndata;
+    std::vector<int8_t> inside = SDF_Bounds(*geometry).isInside(*geometry, nodes); // per node
+    std::vector<int> sel; // selected segments
+    sel.reserve(segments.size());
     for (size_t i=0; i<segments.size(); i++) {
         auto s = segments.at(i);
-        bool x_ = geometry->getDist(nodes.at(s.x))<=0; // in?
-        bool y_ = geometry->getDist(nodes.at(s.y))<=0; // in?
+        bool x_ = inside.at(s.x); // in?
+        bool y_ = inside.at(s.y); // in?
         if (x_ && y_) { //segment is inside
-            seg.push_back(s);
-            if (segO.size()>0) {
-                sO.push_back(segO.at(i));
-            }
-            for(auto iter = data.begin(); iter != data.end(); ++iter) {
-                std::string key =  iter->first;
-                ndata[key].push_back(data[key].at(i));
-            }
+            sel.push_back(i);
         } else if ((x_==false) && (y_==false)) { // segment is outside
         } else { // one node is inside, one outside
             if (x_==false) { // swap indices
@@ -248,20 +254,11 @@ void SegmentAnalyser::crop(std::shared_ptr<SignedDistanceFunction> geometry)
             }
             Vector3d newnode = cut(nodes[s.x], nodes[s.y], geometry);
             nodes.push_back(newnode); // add new segment
-            Vector2i newseg(s.x,nodes.size()-1);
-            seg.push_back(newseg);
-            if (segO.size()>0) {
-                sO.push_back(segO.at(i));
-            }
-            for(auto iter = data.begin(); iter != data.end(); ++iter) { // copy data
-                std::string key =  iter->first;
-                ndata[key].push_back(data[key].at(i));
-            }
+            segments[i] = Vector2i(s.x,nodes.size()-1);
+            sel.push_back(i);
         }
     }
-    segments = seg;
-    segO  = sO;
-    data = ndata;
+    select(sel);
     //std::cout << " cropped to " << segments.size() << " segments " << "\n";
 }
 
@@ -284,24 +281,14 @@ void SegmentAnalyser::cropDomain(double xx, double yy, double zz)
 void SegmentAnalyser::filter(std::string name, double min, double max)
 {
     std::vector<double> d_ = getParameter(name);
-    std::vector<Vector2i> seg;
-    std::vector<std::weak_ptr<Organ>> sO;
-    std::map<std::string, std::vector<double>> ndata;
+    std::vector<int> sel; // selected segments
+    sel.reserve(segments.size());
     for (size_t i=0; i<segments.size(); i++) {
         if ((d_.at(i)>=min) && (d_.at(i)<=max)) {
-            seg.push_back(segments.at(i));
-            if (segO.size()>0) {
-                sO.push_back(segO.at(i));
-            }
-            for(auto iter = data.begin(); iter != data.end(); ++iter) {
-                std::string key =  iter->first;
-                ndata[key].push_back(data[key].at(i));
-            }
+            sel.push_back(i);
         }
     }
-    segments = seg;
-    segO  = sO;
-    data = ndata;
+    select(sel);
 }
 
 /**
@@ -314,22 +301,14 @@ void SegmentAnalyser::filter(std::string name, double min, double max)
 void SegmentAnalyser::filter(std::string name, double value)
 {
     std::vector<double> d_ = getParameter(name);
-    std::vector<Vector2i> seg;
-    std::vector<std::weak_ptr<Organ>> sO;
-    std::map<std::string, std::vector<double>> ndata;
+    std::vector<int> sel; // selected segments
+    sel.reserve(segments.size());
     for (size_t i=0; i<segments.size(); i++) {
         if (d_.at(i)==value) {
-            seg.push_back(segments.at(i));
-            sO.push_back(segO.at(i));
-            for(auto iter = data.begin(); iter != data.end(); ++iter) {
-                std::string key =  iter->first;
-                ndata[key].push_back(data[key].at(i));
-            }
+            sel.push_back(i);
         }
     }
-    segments = seg;
-    segO  = sO;
-    data = ndata;
+    select(sel);
 }
 
 /**
@@ -403,11 +382,15 @@ double SegmentAnalyser::getSummed(std::string name) const {
  */
 double SegmentAnalyser::getSummed(std::string name, std::shared_ptr<SignedDistanceFunction> g) const {
     std::vector<double> data = getParameter(name);
-    double v = 0;
+    std::vector<Vector3d> mids(segments.size());
     for (size_t i=0; i<segments.size(); i++) {
         Vector2i s = segments.at(i);
-        Vector3d mid = nodes.at(s.x).plus(nodes.at(s.y)).times(0.5);
-        if (g->getDist(mid)<0) {
+        mids[i] = nodes.at(s.x).plus(nodes.at(s.y)).times(0.5);
+    }
+    std::vector<int8_t> inside = SDF_Bounds(*g).isInside(*g, mids, true);
+    double v = 0;
+    for (size_t i=0; i<segments.size(); i++) {
+        if (inside[i]) {
             v += data.at(i);
         }
     }
@@ -439,9 +422,9 @@ void SegmentAnalyser::mapPeriodic(double xx, double yy) {
 void SegmentAnalyser::mapPeriodic_(double xx, Vector3d axis, double eps) {
     /* 1. split segments at the boundaries */
     std::vector<Vector2i> seg;
-    std::vector<std::weak_ptr<Organ>> sO;
-    std::map<std::string, std::vector<double>> ndata;
-
+    std::vector<int> idx; // original segment index of each new segment
+    seg.reserve(segments.size());
+    idx.reserve(segments.size());
     for (size_t i=0; i<segments.size(); i++) {
         auto s = segments.at(i);
         auto n1 = nodes.at(s.x);
@@ -450,13 +433,7 @@ void SegmentAnalyser::mapPeriodic_(double xx, Vector3d axis, double eps) {
         int p2 = floor((n2.times(axis)+xx/2.)/xx);
         if (p1 == p2) { //same periodicity index, do nothing [0,xx)
             seg.push_back(s);
-            if (segO.size()>0) { // if used
-                sO.push_back(segO.at(i));
-            }
-            for(auto iter = data.begin(); iter != data.end(); ++iter) { // copy data
-                std::string key =  iter->first;
-                ndata[key].push_back(data[key].at(i));
-            }
+            idx.push_back(i);
         } else { // otherwise split
             if (p1 > p2) { // sort
                 int ind = s.x;
@@ -475,31 +452,20 @@ void SegmentAnalyser::mapPeriodic_(double xx, Vector3d axis, double eps) {
             auto x = n1.plus(v.times(theta)); // cutting point
             auto x0 = x.minus(axis.times(eps)); // less
             auto x1 = x.plus(axis.times(eps)); // greater
-            int c = 0; // segments added
             if ((n1.minus(x0)).length()>eps) { // if inside segment is large enough
                 nodes.push_back(x0); // add node and new add segment
                 seg.push_back(Vector2i(s.x,nodes.size()-1));
-                c++;
+                idx.push_back(i);
             }
             if ((n2.minus(x1)).length()>eps) { // if outside segment is large enough
                 nodes.push_back(x1); // add node and new add segment
                 seg.push_back(Vector2i(nodes.size()-1, s.y));
-                c++;
-            }
-            for (int j=0; j<c; j++) { // copy attached data
-                if (segO.size()>0) { // if used
-                    sO.push_back(segO.at(i));
-                }
-                for(auto iter = data.begin(); iter != data.end(); ++iter) {
-                    std::string key =  iter->first;
-                    ndata[key].push_back(data[key].at(i));
-                }
+                idx.push_back(i);
             }
         }
     }
     segments = seg;
-    segO  = sO;
-    data = ndata;
+    gather(*this, idx); // copy attached data
     /* 2. map points to period [-xx/2, xx/2] */
     for (auto& n : nodes) {
         n = n.minus(axis.times(floor((n.times(axis)+xx/2.)/xx)*xx));
@@ -570,6 +536,7 @@ SegmentAnalyser SegmentAnalyser::cut(const SDF_HalfPlane& plane) const
 {
     SegmentAnalyser f;
     f.nodes = nodes; // copy all nodes
+    std::vector<int> idx;
     for (size_t i=0; i<segments.size(); i++) {
         Vector2i s = segments.at(i);
         Vector3d n1 = nodes.at(s.x);
@@ -577,13 +544,10 @@ SegmentAnalyser SegmentAnalyser::cut(const SDF_HalfPlane& plane) const
         double d = plane.getDist(n1)*plane.getDist(n2);
         if (d<=0) { // one is inside, one is outside
             f.segments.push_back(s);
-            f.segO.push_back(segO.at(i));
-            for(auto iter = data.begin(); iter != data.end(); ++iter) {
-                std::string key =  iter->first;
-                f.data[key].push_back(data.at(key)[i]);
-            }
+            idx.push_back(i);
         }
     }
+    f.gather(*this, idx); // copy attached data
     f.pack(); // delete unused nodes
     return f;
 }
@@ -591,6 +555,8 @@ SegmentAnalyser SegmentAnalyser::cut(const SDF_HalfPlane& plane) const
 /**
  * Creates a vertical distribution of the parameter @param name.
  *
+ * The segments are binned in a single pass, @see SegmentAnalyser::binParameter
+ *
  * @param name      parameter name
  * @param top       vertical top position (cm) (normally = 0)
  * @param bot       vertical bot position (cm) (e.g. = -100 cm)
@@ -600,22 +566,9 @@ SegmentAnalyser SegmentAnalyser::cut(const SDF_HalfPlane& plane) const
  */
 std::vector<double> SegmentAnalyser::distribution(std::string name, double top, double bot, int n, bool exact) const
 {
-    std::vector<double> d(n);
     double dz = (top-bot)/double(n);
     assert(dz > 0 && "SegmentAnalyser::distribution: top must be larger than bot" );
-    std::shared_ptr<SignedDistanceFunction> layer = std::make_shared<SDF_PlantBox>(1e100,1e100,dz);
-    for (int i=0; i<n; i++) {
-        Vector3d t(0,0,top-i*dz);
-        auto g = std::make_shared<SDF_RotateTranslate>(layer,t);
-        if (exact) {
-            SegmentAnalyser a(*this); // copy everything
-            a.crop(g); // crop exactly
-            d.at(i) = a.getSummed(name);
-        } else {
-            d.at(i) = this->getSummed(name, g);
-        }
-    }
-    return d;
+    return binParameter(name, { { 2, top, -dz, n } }, exact);
 }
 
 /**
@@ -628,17 +581,9 @@ std::vector<double> SegmentAnalyser::distribution(std::string name, double top,
  */
 std::vector<SegmentAnalyser> SegmentAnalyser::distribution(double top, double bot, int n) const
 {
-    std::vector<SegmentAnalyser> d(n);
     double dz = (top-bot)/double(n);
     assert(dz > 0 && "SegmentAnalyser::distribution: top must be larger than bot" );
-    std::shared_ptr<SignedDistanceFunction> layer = std::make_shared<SDF_PlantBox>(1.e100, 1.e100, dz);
-    for (int i=0; i<n; i++) {
-        Vector3d t(0,0,top-i*dz);
-        SegmentAnalyser a = SegmentAnalyser(*this); // copy everything
-        a.crop(std::make_shared<SDF_RotateTranslate>(layer,t)); // crop exactly
-        d.at(i) = a;
-    }
-    return d;
+    return binAnalysers({ { 2, top, -dz, n } });
 }
 
 /**
@@ -656,26 +601,14 @@ std::vector<SegmentAnalyser> SegmentAnalyser::distribution(double top, double bo
  */
 std::vector<std::vector<double>> SegmentAnalyser::distribution2(std::string name, double top, double bot, double left, double right, int n, int m, bool exact) const
 {
-    std::vector<std::vector<double>> d(n);
     double dz = (top-bot)/double(n);
     assert(dz > 0 && "SegmentAnalyser::distribution2: top must be larger than bot" );
     double dx = (right-left)/double(m);
     assert(dx > 0 && "SegmentAnalyser::distribution2: right must be larger than left" );
-    std::shared_ptr<SignedDistanceFunction> layer = std::make_shared<SDF_PlantBox>(dx, 1.e9, dz);
+    std::vector<double> v = binParameter(name, { { 2, top, -dz, n }, { 0, left, dx, m } }, exact);
+    std::vector<std::vector<double>> d(n);
     for (int i=0; i<n; i++) {
-        std::vector<double> row(m); // m columns
-        for (int j=0; j<m; j++) {
-            Vector3d t(left+(j+0.5)*dx,0.,top-i*dz); // box is [-x/2,-y/2,0] - [x/2,y/2,-z]
-            auto g = std::make_shared<SDF_RotateTranslate>(layer,t);
-            if (exact) {
-                SegmentAnalyser a(*this); // copy everything
-                a.crop(g); // crop exactly
-                row.at(j) = a.getSummed(name);
-            } else {
-                row.at(j) = this->getSummed(name, g);
-            }
-        }
-        d.at(i)=row; // store the row (n rows)
+        d.at(i) = std::vector<double>(v.begin()+i*m, v.begin()+(i+1)*m); // store the row (n rows)
     }
     return d;
 }
@@ -693,23 +626,258 @@ std::vector<std::vector<double>> SegmentAnalyser::distribution2(std::string name
  */
 std::vector<std::vector<SegmentAnalyser>> SegmentAnalyser::distribution2(double top, double bot, double left, double right, int n, int m) const
 {
-    std::vector<std::vector<SegmentAnalyser>> d(n);
     double dz = (top-bot)/double(n);
     assert(dz > 0 && "SegmentAnalyser::distribution2: top must be larger than bot" );
     double dx = (right-left)/double(m);
     assert(dx > 0 && "SegmentAnalyser::distribution2: right must be larger than left" );
-    std::shared_ptr<SignedDistanceFunction> layer = std::make_shared<SDF_PlantBox>(dx, 1.e4, dz);
+    std::vector<SegmentAnalyser> a = binAnalysers({ { 2, top, -dz, n }, { 0, left, dx, m } });
+    std::vector<std::vector<SegmentAnalyser>> d(n);
+    for (int i=0; i<n; i++) {
+        d.at(i) = std::vector<SegmentAnalyser>(a.begin()+i*m, a.begin()+(i+1)*m);
+    }
+    return d;
+}
+
+/**
+ *  Creates a three-dimensional distribution of the parameter @param name.
+ *
+ * @param name      parameter name
+ * @param top       vertical top position (cm) (normally = 0)
+ * @param bot       vertical bot position (cm) (e.g. = -100 cm)
+ * @param left      left along x-axis (cm)
+ * @param right     right along x-axis (cm)
+ * @param front     front along y-axis (cm)
+ * @param back      back along y-axis (cm)
+ * @param n         number of layers, each with a height of (top-bot)/n
+ * @param m         number of grid elements along x (each with length of (right-left)/m)
+ * @param o         number of grid elements along y (each with length of (back-front)/o)
+ * @param exact     calculates the intersection with the cell boundaries (true), only based on segment midpoints (false)
+ * @return          the summed parameter per cell, indexed [layer][x][y]
+ */
+std::vector<std::vector<std::vector<double>>> SegmentAnalyser::distribution3(std::string name, double top, double bot, double left, double right,
+    double front, double back, int n, int m, int o, bool exact) const
+{
+    double dz = (top-bot)/double(n);
+    assert(dz > 0 && "SegmentAnalyser::distribution3: top must be larger than bot" );
+    double dx = (right-left)/double(m);
+    assert(dx > 0 && "SegmentAnalyser::distribution3: right must be larger than left" );
+    double dy = (back-front)/double(o);
+    assert(dy > 0 && "SegmentAnalyser::distribution3: back must be larger than front" );
+    std::vector<double> v = binParameter(name, { { 2, top, -dz, n }, { 0, left, dx, m }, { 1, front, dy, o } }, exact);
+    std::vector<std::vector<std::vector<double>>> d(n, std::vector<std::vector<double>>(m));
+    for (int i=0; i<n; i++) {
+        for (int j=0; j<m; j++) {
+            d[i][j] = std::vector<double>(v.begin()+(i*m+j)*o, v.begin()+(i*m+j+1)*o);
+        }
+    }
+    return d;
+}
+
+/**
+ *  Creates a three-dimensional distribution
+ *
+ * @param top       vertical top position (cm) (normally = 0)
+ * @param bot       vertical bot position (cm) (e.g. = -100 cm)
+ * @param left      left along x-axis (cm)
+ * @param right     right along x-axis (cm)
+ * @param front     front along y-axis (cm)
+ * @param back      back along y-axis (cm)
+ * @param n         number of layers, each with a height of (top-bot)/n
+ * @param m         number of grid elements along x (each with length of (right-left)/m)
+ * @param o         number of grid elements along y (each with length of (back-front)/o)
+ * @return          Analysis objects of the cells (cropped exact), indexed [layer][x][y]
+ */
+std::vector<std::vector<std::vector<SegmentAnalyser>>> SegmentAnalyser::distribution3(double top, double bot, double left, double right,
+    double front, double back, int n, int m, int o) const
+{
+    double dz = (top-bot)/double(n);
+    assert(dz > 0 && "SegmentAnalyser::distribution3: top must be larger than bot" );
+    double dx = (right-left)/double(m);
+    assert(dx > 0 && "SegmentAnalyser::distribution3: right must be larger than left" );
+    double dy = (back-front)/double(o);
+    assert(dy > 0 && "SegmentAnalyser::distribution3: back must be larger than front" );
+    std::vector<SegmentAnalyser> a = binAnalysers({ { 2, top, -dz, n }, { 0, left, dx, m }, { 1, front, dy, o } });
+    std::vector<std::vector<std::vector<SegmentAnalyser>>> d(n, std::vector<std::vector<SegmentAnalyser>>(m));
     for (int i=0; i<n; i++) {
         for (int j=0; j<m; j++) {
-            Vector3d t(left+(j+0.5)*dx,0.,top-i*dz); // box is [-x/2,-y/2,0] - [x/2,y/2,-z]
-            SegmentAnalyser a(*this); // copy everything
-            a.crop(std::make_shared<SDF_RotateTranslate>(layer,t)); // crop exactly
-            d.at(i).push_back(a);
+            d[i][j] = std::vector<SegmentAnalyser>(a.begin()+(i*m+j)*o, a.begin()+(i*m+j+1)*o);
+        }
+    }
+    return d;
+}
+
+/**
+ * Clips the segments against the planes of a regular grid, in a single pass over the segments.
+ *
+ * Each segment is restricted to the grid bounding box, and split at the grid planes it crosses.
+ * For each piece, @param f is called with segment index, cell index, and the piece [t0, t1] in segment coordinates (0 = segment.x, 1 = segment.y).
+ * The cell index is (i0*n1+i1)*n2+i2 for axes cell indices i0, i1, i2 (unbounded axes have a single cell).
+ *
+ * @param axes      grid axes, e.g. (z, x, y)
+ * @param f         called for each segment piece within a grid cell
+ */
+void SegmentAnalyser::binSegments(const std::vector<GridAxis>& axes, const std::function<void(int si, int cell, double t0, double t1)>& f) const
+{
+    auto coord = [](const Vector3d& p, int d) { return d==0 ? p.x : (d==1 ? p.y : p.z); };
+    const size_t na = axes.size();
+    std::vector<double> ua(na), du(na); // segment start and direction in cell units
+    std::vector<double> ts;
+    for (size_t si=0; si<segments.size(); si++) {
+        const Vector3d& a = nodes.at(segments[si].x);
+        const Vector3d& b = nodes.at(segments[si].y);
+        double t0 = 0., t1 = 1.;
+        for (size_t k=0; k<na; k++) { // clip to the grid bounding box
+            const auto& ax = axes[k];
+            ua[k] = (coord(a, ax.d)-ax.origin)/ax.h;
+            du[k] = (coord(b, ax.d)-ax.origin)/ax.h - ua[k];
+            if (ax.n==0) {
+                continue;
+            }
+            if (du[k]==0.) {
+                if ((ua[k]<0.) || (ua[k]>ax.n)) {
+                    t1 = -1.; // outside
+                }
+            } else {
+                double ta = -ua[k]/du[k];
+                double tb = (ax.n-ua[k])/du[k];
+                t0 = std::max(t0, std::min(ta, tb));
+                t1 = std::min(t1, std::max(ta, tb));
+            }
+        }
+        if (t1<t0) {
+            continue;
+        }
+        ts.clear(); // split at the grid planes
+        ts.push_back(t0);
+        for (size_t k=0; k<na; k++) {
+            if ((axes[k].n>0) && (du[k]!=0.)) {
+                double u0 = ua[k]+t0*du[k], u1 = ua[k]+t1*du[k];
+                for (double p = std::floor(std::min(u0, u1))+1.; p<std::max(u0, u1); p+=1.) {
+                    double t = (p-ua[k])/du[k];
+                    if ((t>t0) && (t<t1)) {
+                        ts.push_back(t);
+                    }
+                }
+            }
+        }
+        ts.push_back(t1);
+        std::sort(ts.begin(), ts.end());
+        for (size_t l=0; l+1<ts.size(); l++) {
+            if ((ts[l+1]==ts[l]) && (ts.size()>2)) { // skip empty pieces, but keep zero length segments
+                continue;
+            }
+            double tm = 0.5*(ts[l]+ts[l+1]);
+            int cell = 0;
+            for (size_t k=0; k<na; k++) {
+                int n = std::max(axes[k].n, 1);
+                int i = (axes[k].n>0) ? std::min(std::max(int(std::floor(ua[k]+tm*du[k])), 0), n-1) : 0;
+                cell = cell*n + i;
+            }
+            f(si, cell, ts[l], ts[l+1]);
+        }
+    }
+}
+
+/**
+ * Sums up the parameter @param name per grid cell, in a single pass over the segments.
+ *
+ * Exact, the segments are clipped at the cell boundaries: "length", "surface", and "volume" are summed proportionally,
+ * other parameters are summed per cell the segment intersects (like cropping each cell with SegmentAnalyser::crop).
+ * Otherwise, each segment is summed to the cell that contains its mid point.
+ *
+ * @param name      parameter name
+ * @param axes      grid axes, e.g. (z, x, y)
+ * @param exact     clips the segments at the cell boundaries (true), only based on segment midpoints (false)
+ * @return          the summed parameter per cell, @see SegmentAnalyser::binSegments for the cell index
+ */
+std::vector<double> SegmentAnalyser::binParameter(std::string name, const std::vector<GridAxis>& axes, bool exact) const
+{
+    int nc = 1;
+    for (const auto& ax : axes) {
+        nc *= std::max(ax.n, 1);
+    }
+    std::vector<double> d(nc, 0.);
+    std::vector<double> v = getParameter(name);
+    if (exact) {
+        bool proportional = !hasData(name) && ((name=="length") || (name=="surface") || (name=="volume"));
+        binSegments(axes, [&](int si, int cell, double t0, double t1) {
+            d[cell] += proportional ? v[si]*(t1-t0) : v[si];
+        });
+    } else {
+        auto coord = [](const Vector3d& p, int d) { return d==0 ? p.x : (d==1 ? p.y : p.z); };
+        for (size_t si=0; si<segments.size(); si++) {
+            Vector3d mid = nodes.at(segments[si].x).plus(nodes.at(segments[si].y)).times(0.5);
+            int cell = 0;
+            bool inside = true;
+            for (const auto& ax : axes) {
+                int n = std::max(ax.n, 1);
+                int i = 0;
+                if (ax.n>0) {
+                    double u = (coord(mid, ax.d)-ax.origin)/ax.h;
+                    i = int(std::floor(u));
+                    inside = inside && (u>i) && (i>=0) && (i<n); // mid points on cell boundaries are not counted
+                }
+                cell = cell*n + i;
+            }
+            if (inside) {
+                d[cell] += v[si];
+            }
         }
     }
     return d;
 }
 
+/**
+ * Crops the segments exactly to each grid cell, in a single pass over the segments.
+ *
+ * The nodes of each analyser are the nodes used by its segments (like after SegmentAnalyser::pack), segments keep their direction,
+ * and segment origins and user data are copied.
+ *
+ * @param axes      grid axes, e.g. (z, x, y)
+ * @return          one analyser per cell, @see SegmentAnalyser::binSegments for the cell index
+ */
+std::vector<SegmentAnalyser> SegmentAnalyser::binAnalysers(const std::vector<GridAxis>& axes) const
+{
+    int nc = 1;
+    for (const auto& ax : axes) {
+        nc *= std::max(ax.n, 1);
+    }
+    SegmentAnalyser empty; // user data names, without data
+    empty.columns = std::vector<std::vector<double>>(columns.size());
+    empty.columnNames = columnNames;
+    empty.columnIds = columnIds;
+    std::vector<SegmentAnalyser> d(nc, empty);
+    std::vector<std::map<int,int>> nodeIndex(nc); // original node index -> cell node index
+    auto addNode = [&](int cell, int si, double t, int ni) {
+        if (ni>=0) { // original node
+            auto it = nodeIndex[cell].find(ni);
+            if (it!=nodeIndex[cell].end()) {
+                return it->second;
+            }
+            d[cell].nodes.push_back(nodes.at(ni));
+            nodeIndex[cell][ni] = d[cell].nodes.size()-1;
+        } else { // cut point
+            const Vector3d& a = nodes.at(segments[si].x);
+            const Vector3d& b = nodes.at(segments[si].y);
+            d[cell].nodes.push_back(a.plus(b.minus(a).times(t)));
+        }
+        return int(d[cell].nodes.size()-1);
+    };
+    binSegments(axes, [&](int si, int cell, double t0, double t1) {
+        const Vector2i& s = segments[si];
+        int x = addNode(cell, si, t0, t0==0. ? s.x : -1);
+        int y = addNode(cell, si, t1, t1==1. ? s.y : -1);
+        d[cell].segments.push_back(Vector2i(x, y));
+        if (segO.size()>0) {
+            d[cell].segO.push_back(segO.at(si));
+        }
+        for (size_t k=0; k<columns.size(); k++) {
+            d[cell].columns[k].push_back(columns[k].at(si));
+        }
+    });
+    return d;
+}
+
 /**
  * Adds user data that can be accessed by SegmentAnalyser::getParameter, and that can be written to the VTP file
  * (e.g. used to add simulation results like xylem pressure to the output).
@@ -720,19 +888,160 @@ std::vector<std::vector<SegmentAnalyser>> SegmentAnalyser::distribution2(double
 void SegmentAnalyser::addData(std::string name, std::vector<double> values)
 {
     if (values.size()== segments.size()) {
-        data[name] = values;
+        column(name) = values;
     } else if (values.size()==nodes.size()) { // convert node to segment data
         std::vector<double> d;
         d.reserve(segments.size());
         for (int i = 0; i<segments.size(); i++) {
             d.push_back(values.at(segments[i].y));
         }
-        data[name] = d;
+        column(name) = d;
     } else {
         throw std::invalid_argument("SegmentAnalyser::addData: parameter values has wrong size.");
     }
 }
 
+/**
+ * @param name      name of the user data
+ * @return          the interned column id of the user data, or -1 if there are no data named @param name
+ */
+int SegmentAnalyser::getDataId(std::string name) const
+{
+    auto it = columnIds.find(name);
+    if (it!=columnIds.end()) {
+        return it->second;
+    }
+    return -1;
+}
+
+/**
+ * User data column, without copying (in contrast to SegmentAnalyser::getParameter)
+ *
+ * @param name      name of the user data
+ * @return          one value per segment
+ */
+const std::vector<double>& SegmentAnalyser::getData(std::string name) const
+{
+    int id = getDataId(name);
+    if (id<0) {
+        throw std::invalid_argument("SegmentAnalyser::getData: there are no user data named "+name);
+    }
+    return columns[id];
+}
+
+/**
+ * @return a copy of all user data (name to column)
+ */
+std::map<std::string, std::vector<double>> SegmentAnalyser::getDataMap() const
+{
+    std::map<std::string, std::vector<double>> data;
+    for (size_t k=0; k<columns.size(); k++) {
+        data[columnNames[k]] = columns[k];
+    }
+    return data;
+}
+
+/**
+ * Replaces all user data
+ *
+ * @param data      name to column, with one value per segment
+ */
+void SegmentAnalyser::setDataMap(const std::map<std::string, std::vector<double>>& data)
+{
+    columns.clear();
+    columnNames.clear();
+    columnIds.clear();
+    for (const auto& iter : data) {
+        column(iter.first) = iter.second;
+    }
+}
+
+/**
+ * @return the user data column named @param name, an empty column is created if necessary
+ */
+std::vector<double>& SegmentAnalyser::column(std::string name)
+{
+    auto it = columnIds.find(name);
+    if (it!=columnIds.end()) {
+        return columns[it->second];
+    }
+    columnIds[name] = columns.size();
+    columnNames.push_back(name);
+    columns.push_back(std::vector<double>());
+    return columns.back();
+}
+
+/**
+ * Removes the user data named @param name (if it exists), the column ids of the following columns are shifted.
+ */
+void SegmentAnalyser::removeColumn(std::string name)
+{
+    int id = getDataId(name);
+    if (id<0) {
+        return;
+    }
+    columns.erase(columns.begin()+id);
+    columnNames.erase(columnNames.begin()+id);
+    columnIds.clear();
+    for (size_t k=0; k<columnNames.size(); k++) {
+        columnIds[columnNames[k]] = k;
+    }
+}
+
+/**
+ * Keeps the selected segments, compacting segments, segment origins, and all user data columns in place (in a single pass).
+ *
+ * @param sel       indices of the segments that are kept, in increasing order
+ */
+void SegmentAnalyser::select(const std::vector<int>& sel)
+{
+    for (size_t k=0; k<sel.size(); k++) {
+        segments[k] = segments[sel[k]];
+    }
+    segments.resize(sel.size());
+    if (segO.size()>0) { // if used
+        for (size_t k=0; k<sel.size(); k++) {
+            segO[k] = segO[sel[k]];
+        }
+        segO.resize(sel.size());
+    }
+    for (auto& c : columns) {
+        for (size_t k=0; k<sel.size(); k++) {
+            c[k] = c[sel[k]];
+        }
+        c.resize(sel.size());
+    }
+}
+
+/**
+ * Sets segment origins and user data of the segments, where segment i is a copy (or piece) of segment idx[i] of @param a.
+ * The segments themselves are not changed. @param a can be this analyser.
+ *
+ * @param a         the analyser the data are copied from
+ * @param idx       index into the segments of @param a, per segment
+ */
+void SegmentAnalyser::gather(const SegmentAnalyser& a, const std::vector<int>& idx)
+{
+    std::vector<std::weak_ptr<Organ>> sO;
+    if (a.segO.size()>0) { // if used
+        sO.reserve(idx.size());
+        for (int i : idx) {
+            sO.push_back(a.segO.at(i));
+        }
+    }
+    std::vector<std::vector<double>> c(a.columns.size());
+    for (size_t k=0; k<c.size(); k++) {
+        c[k].reserve(idx.size());
+        for (int i : idx) {
+            c[k].push_back(a.columns[k].at(i));
+        }
+    }
+    columnNames = a.columnNames;
+    columnIds = a.columnIds;
+    segO = std::move(sO);
+    columns = std::move(c);
+}
+
 /**
  * Exports the simulation results with the type from the file extension in name (must be lower case)
  * Currently its possible to write "vtp", "txt", or "dgf" files.
@@ -742,16 +1051,18 @@ void SegmentAnalyser::addData(std::string name, std::vector<double> values)
  * @param name      file name e.g. output.vtp
  * @param types 	Optionally, for vtp we can determine the cell data by a vector of parameter names
  *                  (default = { "radius", "subType", "creationTime", "organType" })
+ * @param format    vtp data format (VTKWriter::Formats): ascii (default), appended raw, or appended base64
+ * @param compress  zlib compression of binary vtp data
  */
-void SegmentAnalyser::write(std::string name, std::vector<std::string> types)
+void SegmentAnalyser::write(std::string name, std::vector<std::string> types, int format, bool compress)
 {
     this->pack(); // a good idea before writing any file
     std::ofstream fos;
-    fos.open(name.c_str());
+    fos.open(name.c_str(), std::ios::binary);
     std::string ext = name.substr(name.size()-3,name.size()); // pick the right writer
     if (ext.compare("vtp")==0) {
         std::cout << "writing VTP: " << name << "\n" << std::flush;
-        this->writeVTP(fos, types);
+        this->writeVTP(fos, types, format, compress);
     } else if (ext.compare("txt")==0)  {
         std::cout << "writing text file for Matlab import: "<< name << "\n"<< std::flush;
         writeRBSegments(fos);
@@ -767,46 +1078,48 @@ void SegmentAnalyser::write(std::string name, std::vector<std::string> types)
 /**
  * Writes a VTP file with @param types data per segment.
  *
- * @param os        a file out stream
+ * @param os        a file out stream (opened in binary mode for raw data)
  * @param types     parameter names of the cell data  (default = { "radius", "subType", "creationTime", "organType" })
+ * @param format    data format (VTKWriter::Formats): ascii (default), appended raw, or appended base64
+ * @param compress  zlib compression of binary data
  */
-void SegmentAnalyser::writeVTP(std::ostream & os, std::vector<std::string> types) const
+void SegmentAnalyser::writeVTP(std::ostream & os, std::vector<std::string> types, int format, bool compress) const
 {
-    os << "<?xml version=\"1.0\"?>";
-    os << "<VTKFile type=\"PolyData\" version=\"0.1\" byte_order=\"LittleEndian\">\n";
-    os << "<PolyData>\n";
-    os << "<Piece NumberOfLines=\""<< segments.size() << "\" NumberOfPoints=\""<< nodes.size()<< "\">\n";
+    VTKWriter w(os, format, compress);
+    w.beginFile("PolyData");
+    w.openElement("Piece", "NumberOfLines=\""+std::to_string(segments.size())+"\" NumberOfPoints=\""+std::to_string(nodes.size())+"\"");
     // data (CellData)
-    os << "<CellData Scalars=\" CellData\">\n";
+    w.openElement("CellData", "Scalars=\" CellData\"");
     for (auto name : types) {
         std::vector<double> data = getParameter(name, -1.);
-        os << "<DataArray type=\"Float32\" Name=\"" << name << "\" NumberOfComponents=\"1\" format=\"ascii\" >\n";
-        for (const auto& t : data) {
-            os << t << " ";
-        }
-        os << "\n</DataArray>\n";
+        w.dataArray(name, std::vector<float>(data.begin(), data.end()));
     }
-    os << "\n</CellData>\n";
+    w.closeElement("CellData");
     // nodes (Points)
-    os << "<Points>\n"<<"<DataArray type=\"Float32\" Name=\"Coordinates\" NumberOfComponents=\"3\" format=\"ascii\" >\n";
-    for (const auto& n : nodes) {
-        os << n.x << " "<< n.y <<" "<< n.z<< " ";
+    std::vector<float> points(3*nodes.size());
+    for (size_t i=0; i<nodes.size(); i++) {
+        points[3*i] = nodes[i].x;
+        points[3*i+1] = nodes[i].y;
+        points[3*i+2] = nodes[i].z;
     }
-    os << "\n</DataArray>\n"<< "</Points>\n";
+    w.openElement("Points");
+    w.dataArray("Coordinates", points, 3);
+    w.closeElement("Points");
     // segments (Lines)
-    os << "<Lines>\n"<<"<DataArray type=\"Int32\" Name=\"connectivity\" NumberOfComponents=\"1\" format=\"ascii\" >\n";
-    for (const auto& s : segments) {
-        os << s.x << " " << s.y << " ";
-    }
-    os << "\n</DataArray>\n"<<"<DataArray type=\"Int32\" Name=\"offsets\" NumberOfComponents=\"1\" format=\"ascii\" >\n";
+    std::vector<int32_t> connectivity(2*segments.size());
+    std::vector<int32_t> offsets(segments.size());
     for (size_t i=0; i<segments.size(); i++) {
-        os << 2*i+2 << " ";
+        connectivity[2*i] = segments[i].x;
+        connectivity[2*i+1] = segments[i].y;
+        offsets[i] = 2*i+2;
     }
-    os << "\n</DataArray>\n";
-    os << "\n</Lines>\n";
+    w.openElement("Lines");
+    w.dataArray("connectivity", connectivity);
+    w.dataArray("offsets", offsets);
+    w.closeElement("Lines");
     //
-    os << "</Piece>\n";
-    os << "</PolyData>\n" << "</VTKFile>\n";
+    w.closeElement("Piece");
+    w.endFile();
 }
 
 /**
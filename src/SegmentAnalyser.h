@@ -8,6 +8,8 @@
 
 #include <memory>
 #include <limits>
+#include <functional>
+#include <map>
 
 namespace CPlantBox {
 
@@ -20,6 +22,8 @@ class MappedSegments;
 class SegmentAnalyser
 {
 
+    friend class SegmentQuery;
+
 public:
 
     SegmentAnalyser() { }; ///< creates an empty object (use AnalysisSDF::addSegments)
@@ -50,7 +54,10 @@ public:
     std::vector<SegmentAnalyser> distribution(double top, double bot, int n) const; ///< vertical distribution
     std::vector<std::vector<double>> distribution2(std::string name, double top, double bot, double left, double right, int n, int m, bool exact=false) const; ///< 2d distribution (x,z) of a parameter
     std::vector<std::vector<SegmentAnalyser>> distribution2(double top, double bot, double left, double right, int n, int m) const; ///< 2d distribution (x,z)
-    // todo distribution3
+    std::vector<std::vector<std::vector<double>>> distribution3(std::string name, double top, double bot, double left, double right, double front, double back,
+        int n, int m, int o, bool exact=false) const; ///< 3d distribution (z,x,y) of a parameter
+    std::vector<std::vector<std::vector<SegmentAnalyser>>> distribution3(double top, double bot, double left, double right, double front, double back,
+        int n, int m, int o) const; ///< 3d distribution (z,x,y)
 
     // rather specialized things we want to know
     void mapPeriodic(double xx, double yy); /// maps into a periodic domain, splits up intersecting segments
@@ -61,10 +68,19 @@ public:
 
     // User data for export or distributions
     void addData(std::string name, std::vector<double> data); ///< adds user data that are written into the VTP file, @see SegmentAnalyser::writeVTP
+    bool hasData(std::string name) const { return columnIds.count(name)>0; } ///< true, if user data named @param name exist
+    int getDataId(std::string name) const; ///< interned column id of the user data, or -1 if there are no data named @param name
+    const std::vector<double>& getData(std::string name) const; ///< user data column (no copy)
+    const std::vector<double>& getData(int id) const { return columns.at(id); } ///< user data column by interned id (no copy)
+    const std::vector<std::string>& getDataNames() const { return columnNames; } ///< names of the user data, index is the interned column id
+    std::map<std::string, std::vector<double>> getDataMap() const; ///< copy of all user data
+    void setDataMap(const std::map<std::string, std::vector<double>>& data); ///< replaces all user data
 
     // some exports
-    void write(std::string name, std::vector<std::string>  types = { "radius", "subType", "creationTime", "organType" }); ///< writes simulation results (type is determined from file extension in name)
-    void writeVTP(std::ostream & os, std::vector<std::string>  types = { "radius", "subType", "creationTime", "organType"  }) const; ///< writes a VTP file
+    void write(std::string name, std::vector<std::string>  types = { "radius", "subType", "creationTime", "organType" },
+        int format = 0, bool compress = false); ///< writes simulation results (type is determined from file extension in name)
+    void writeVTP(std::ostream & os, std::vector<std::string>  types = { "radius", "subType", "creationTime", "organType"  },
+        int format = 0, bool compress = false) const; ///< writes a VTP file (format is a VTKWriter::Formats)
     void writeRBSegments(std::ostream & os) const; ///< Writes the segments of the root system, mimics the Matlab script getSegments()
     void writeDGF(std::ostream & os) const; ///< Writes the segments of the root system in DGF format used by DuMux
 
@@ -74,12 +90,34 @@ public:
     std::vector<Vector3d> nodes; ///< nodes
     std::vector<Vector2i> segments; ///< connectivity of the nodes
     std::vector<std::weak_ptr<Organ>> segO; ///< to look up things
-    std::map<std::string, std::vector<double>> data; ///< user data attached to the segments (for vtp file), e.g. flux, pressure, etc.
 
 protected:
 
     void mapPeriodic_(double xx, Vector3d axis, double eps);
 
+    /* user data attached to the segments (for vtp file), e.g. flux, pressure, etc., stored column wise */
+    std::vector<double>& column(std::string name); ///< user data column, created if necessary
+    void removeColumn(std::string name); ///< removes user data
+    void select(const std::vector<int>& sel); ///< keeps the selected segments, compacts segments, origins and all columns in place
+    void gather(const SegmentAnalyser& a, const std::vector<int>& idx); ///< origins and user data of the segments, copied from segment idx[i] of @param a
+    std::vector<std::vector<double>> columns; ///< one data column per interned id
+    std::vector<std::string> columnNames; ///< name per interned id
+    std::map<std::string, int> columnIds; ///< interned id per name
+
+    /**
+     * One axis of a regular grid used for the distributions, axes are given in the order z, x, y.
+     * Cell i covers [origin+i*h, origin+(i+1)*h] (or the reverse for negative h), n = 0 denotes an unbounded axis.
+     */
+    struct GridAxis {
+        int d; ///< coordinate direction (0 = x, 1 = y, 2 = z)
+        double origin; ///< position of the first grid plane [cm]
+        double h; ///< cell size, negative for layers from top to bottom [cm]
+        int n; ///< number of cells, 0 for an unbounded axis
+    };
+    void binSegments(const std::vector<GridAxis>& axes, const std::function<void(int si, int cell, double t0, double t1)>& f) const; ///< clips the segments against the grid planes
+    std::vector<double> binParameter(std::string name, const std::vector<GridAxis>& axes, bool exact) const; ///< summed parameter per grid cell
+    std::vector<SegmentAnalyser> binAnalysers(const std::vector<GridAxis>& axes) const; ///< segments per grid cell (cropped exact)
+
 };
 
 } // end namespace CPlantBox
@@ -0,0 +1,322 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+#include "SegmentQuery.h"
+
+#include <sstream>
+#include <utility>
+#include <cmath>
+
+namespace CPlantBox {
+
+/**
+ * Keeps the segments, where the parameter is within the interval [min,max]
+ *
+ * @param name  parameter name, "length", "surface", and "volume" refer to the segments after the previous steps (e.g. cropped)
+ * @param min   minimal value
+ * @param max   maximal value
+ */
+SegmentQuery& SegmentQuery::filter(std::string name, double min, double max)
+{
+    steps.push_back(Step{ st_filter, name, min, max, nullptr, Vector3d() });
+    return *this;
+}
+
+/**
+ * Keeps the segments, where parameter equals a specific value
+ *
+ * @param name      parameter name
+ * @param value     parameter value of the segments that are kept
+ */
+SegmentQuery& SegmentQuery::filter(std::string name, double value)
+{
+    steps.push_back(Step{ st_filterValue, name, value, value, nullptr, Vector3d() });
+    return *this;
+}
+
+/**
+ * Crops the segments exactly to the geometry, segments are cut at the geometry border
+ *
+ * @param geometry      signed distance function of the geometry
+ */
+SegmentQuery& SegmentQuery::crop(std::shared_ptr<SignedDistanceFunction> geometry)
+{
+    steps.push_back(Step{ st_crop, "", 0., 0., geometry, Vector3d() });
+    return *this;
+}
+
+/**
+ *  Crops the segments to the domain [-xx/2, -yy/2, -zz] - [xx/2, yy/2, 0.]
+ */
+SegmentQuery& SegmentQuery::cropDomain(double xx, double yy, double zz)
+{
+    return crop(std::make_shared<SDF_PlantBox>(xx,yy,zz));
+}
+
+/**
+ * Maps the segments into a periodic domain, segments crossing the periodic boundary are split
+ *
+ * @param xx    period in x direction
+ * @param yy    period in y direction
+ */
+SegmentQuery& SegmentQuery::mapPeriodic(double xx, double yy)
+{
+    steps.push_back(Step{ st_periodic, "", xx, 0., nullptr, Vector3d(1.,0.,0.) });
+    steps.push_back(Step{ st_periodic, "", yy, 0., nullptr, Vector3d(0.,1.,0.) });
+    return *this;
+}
+
+/**
+ * @return the number of segments after all steps
+ */
+int SegmentQuery::getNumberOfSegments() const
+{
+    int c = 0;
+    run([&](int si, const Piece& p) { c++; });
+    return c;
+}
+
+/**
+ * @return the sum of parameter @param name over the segments after all steps
+ */
+double SegmentQuery::getSummed(std::string name) const
+{
+    double v = 0.;
+    if (geometric(name)) {
+        std::vector<double> radii;
+        if (name!="length") {
+            radii = a.getParameter("radius");
+        }
+        run([&](int si, const Piece& p) {
+            double l = p.y.minus(p.x).length();
+            if (name=="length") {
+                v += l;
+            } else if (name=="surface") {
+                v += 2*radii[si]*M_PI*l;
+            } else {
+                v += radii[si]*radii[si]*M_PI*l;
+            }
+        });
+    } else {
+        std::vector<double> data = a.getParameter(name);
+        run([&](int si, const Piece& p) { v += data[si]; });
+    }
+    return v;
+}
+
+/**
+ * Vertical distribution of the parameter @param name of the segments after all steps, @see SegmentAnalyser::distribution
+ */
+std::vector<double> SegmentQuery::distribution(std::string name, double top, double bot, int n, bool exact) const
+{
+    return aggregate(name).distribution(name, top, bot, n, exact);
+}
+
+/**
+ * Two-dimensional distribution of the parameter @param name of the segments after all steps, @see SegmentAnalyser::distribution2
+ */
+std::vector<std::vector<double>> SegmentQuery::distribution2(std::string name, double top, double bot, double left, double right, int n, int m,
+    bool exact) const
+{
+    return aggregate(name).distribution2(name, top, bot, left, right, n, m, exact);
+}
+
+/**
+ * Three-dimensional distribution of the parameter @param name of the segments after all steps, @see SegmentAnalyser::distribution3
+ */
+std::vector<std::vector<std::vector<double>>> SegmentQuery::distribution3(std::string name, double top, double bot, double left, double right,
+    double front, double back, int n, int m, int o, bool exact) const
+{
+    return aggregate(name).distribution3(name, top, bot, left, right, front, back, n, m, o, exact);
+}
+
+/**
+ * Materialises the segments after all steps, including segment origins and all user data.
+ *
+ * Nodes are ordered by their occurrence in the segment list, unused nodes are not copied (like after SegmentAnalyser::pack)
+ *
+ * @return the resulting segments
+ */
+SegmentAnalyser SegmentQuery::analyser() const
+{
+    SegmentAnalyser r;
+    std::vector<int> nodeIndex(a.nodes.size(), -1); // analyser node index -> result node index
+    std::vector<int> idx; // analyser segment index per resulting segment
+    auto addNode = [&](const Vector3d& n, int ni) {
+        if (ni>=0) {
+            if (nodeIndex[ni]<0) {
+                r.nodes.push_back(n);
+                nodeIndex[ni] = r.nodes.size()-1;
+            }
+            return nodeIndex[ni];
+        }
+        r.nodes.push_back(n);
+        return int(r.nodes.size()-1);
+    };
+    run([&](int si, const Piece& p) {
+        int x = addNode(p.x, p.nx);
+        int y = addNode(p.y, p.ny);
+        r.segments.push_back(Vector2i(x, y));
+        idx.push_back(si);
+    });
+    r.gather(a, idx); // origins and user data
+    return r;
+}
+
+/**
+ * Runs all steps in a single pass over the segments of the analyser.
+ *
+ * Each segment is passed through the steps, and might be dropped (filter, crop), cut (crop), or split into two pieces (mapPeriodic).
+ * The resulting pieces are passed to @param f, with the index of the segment they originate from.
+ * The pieces are in the same order as the segments after calling the steps on the analyser.
+ *
+ * @param f     called for each resulting piece
+ */
+void SegmentQuery::run(const std::function<void(int si, const Piece& p)>& f) const
+{
+    std::vector<std::vector<double>> values(steps.size()); // filter parameters per segment of the analyser
+    std::vector<double> radii;
+    for (size_t k=0; k<steps.size(); k++) {
+        if ((steps[k].type==st_filter) || (steps[k].type==st_filterValue)) {
+            if (!geometric(steps[k].name)) {
+                values[k] = a.getParameter(steps[k].name);
+            } else if ((steps[k].name!="length") && radii.empty()) {
+                radii = a.getParameter("radius");
+            }
+        }
+    }
+    const double eps = 1.e-6; // accuracy at periodic boundaries, as SegmentAnalyser::mapPeriodic
+    std::vector<SDF_Bounds> bounds(steps.size()); // of the crop geometries
+    for (size_t k=0; k<steps.size(); k++) {
+        if (steps[k].type==st_crop) {
+            bounds[k] = SDF_Bounds(*steps[k].geometry);
+        }
+    }
+    std::vector<std::pair<Piece, size_t>> stack; // pieces, and their next step
+    for (size_t si=0; si<a.segments.size(); si++) {
+        const Vector2i& s = a.segments[si];
+        stack.push_back(std::make_pair(Piece{ a.nodes.at(s.x), a.nodes.at(s.y), s.x, s.y }, size_t(0)));
+        while (!stack.empty()) {
+            Piece p = stack.back().first;
+            size_t k = stack.back().second;
+            stack.pop_back();
+            bool keep = true;
+            for (; (k<steps.size()) && keep; k++) {
+                const Step& st = steps[k];
+                if ((st.type==st_filter) || (st.type==st_filterValue)) {
+                    double v;
+                    if (geometric(st.name)) {
+                        double l = p.y.minus(p.x).length();
+                        if (st.name=="length") {
+                            v = l;
+                        } else if (st.name=="surface") {
+                            v = 2*radii[si]*M_PI*l;
+                        } else {
+                            v = radii[si]*radii[si]*M_PI*l;
+                        }
+                    } else {
+                        v = values[k][si];
+                    }
+                    keep = (st.type==st_filter) ? ((v>=st.min) && (v<=st.max)) : (v==st.min);
+                } else if (st.type==st_crop) {
+                    bool x_ = bounds[k].isInside(*st.geometry, p.x); // in?
+                    bool y_ = bounds[k].isInside(*st.geometry, p.y); // in?
+                    if ((x_==false) && (y_==false)) { // segment is outside
+                        keep = false;
+                    } else if (x_!=y_) { // one node is inside, one outside
+                        if (x_==false) { // swap
+                            std::swap(p.x, p.y);
+                            std::swap(p.nx, p.ny);
+                        }
+                        p.y = SegmentAnalyser::cut(p.x, p.y, st.geometry);
+                        p.ny = -1;
+                    }
+                } else if (st.type==st_periodic) {
+                    const double xx = st.min;
+                    const Vector3d& axis = st.axis;
+                    auto map = [&](const Vector3d& n) { return n.minus(axis.times(floor((n.times(axis)+xx/2.)/xx)*xx)); };
+                    int p1 = floor((p.x.times(axis)+xx/2.)/xx);
+                    int p2 = floor((p.y.times(axis)+xx/2.)/xx);
+                    if (p1 == p2) {
+                        p.x = map(p.x);
+                        p.y = map(p.y);
+                    } else { // split
+                        if (p1 > p2) { // sort
+                            std::swap(p.x, p.y);
+                            std::swap(p.nx, p.ny);
+                            std::swap(p1, p2);
+                        }
+                        double theta = (p2*xx - (p.x.times(axis)+xx/2) )/(p.y.times(axis)-p.x.times(axis));
+                        auto c = p.x.plus(p.y.minus(p.x).times(theta)); // cutting point
+                        auto x0 = c.minus(axis.times(eps)); // less
+                        auto x1 = c.plus(axis.times(eps)); // greater
+                        if ((p.y.minus(x1)).length()>eps) { // outside piece, continues after the first piece
+                            stack.push_back(std::make_pair(Piece{ map(x1), map(p.y), -1, p.ny }, k+1));
+                        }
+                        if ((p.x.minus(x0)).length()>eps) { // inside piece
+                            p = Piece{ map(p.x), map(x0), p.nx, -1 };
+                        } else {
+                            keep = false;
+                        }
+                    }
+                }
+            }
+            if (keep) {
+                f(si, p);
+            }
+        }
+    }
+}
+
+/**
+ * @return true, if the parameter is computed from the segment geometry (and not overwritten by user data)
+ */
+bool SegmentQuery::geometric(std::string name) const
+{
+    return !a.hasData(name) && ((name=="length") || (name=="surface") || (name=="volume"));
+}
+
+/**
+ * Materialises the resulting segments as pairs of nodes, with the data needed for the parameter @param name only
+ */
+SegmentAnalyser SegmentQuery::aggregate(std::string name) const
+{
+    std::vector<Vector3d> nodes;
+    std::vector<Vector2i> segments;
+    std::vector<int> idx;
+    run([&](int si, const Piece& p) {
+        segments.push_back(Vector2i(nodes.size(), nodes.size()+1));
+        nodes.push_back(p.x);
+        nodes.push_back(p.y);
+        idx.push_back(si);
+    });
+    std::vector<double> radii(segments.size(), 0.);
+    std::vector<double> values;
+    if (geometric(name)) {
+        if (name!="length") {
+            values = a.getParameter("radius");
+        }
+    } else {
+        values = a.getParameter(name);
+    }
+    std::vector<double> v(segments.size());
+    for (size_t i=0; i<idx.size() && !values.empty(); i++) {
+        v[i] = values[idx[i]];
+    }
+    if (geometric(name)) {
+        return SegmentAnalyser(nodes, segments, std::vector<double>(segments.size(), 0.), v);
+    }
+    SegmentAnalyser r(nodes, segments, std::vector<double>(segments.size(), 0.), radii);
+    r.addData(name, v);
+    return r;
+}
+
+/**
+ * @return quick info about the query for debugging
+ */
+std::string SegmentQuery::toString() const
+{
+    std::stringstream str;
+    str << "SegmentQuery with " << steps.size() << " steps on " << a.segments.size() << " segments";
+    return str.str();
+}
+
+} // namespace CPlantBox
@@ -0,0 +1,81 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+#ifndef SEGMENTQUERY_H_
+#define SEGMENTQUERY_H_
+
+#include "SegmentAnalyser.h"
+
+#include <functional>
+
+namespace CPlantBox {
+
+/**
+ * SegmentQuery
+ *
+ * Lazy version of a typical SegmentAnalyser pipeline (e.g. filter, crop, and distribution):
+ * the steps are only recorded, and run fused in one pass over the segments of the analyser, when a result is requested.
+ * Only the final result is materialised (the analyser is not changed or copied).
+ *
+ * Results equal the results of calling the same steps on a copy of the analyser,
+ * but SegmentQuery::analyser() returns packed nodes (@see SegmentAnalyser::pack).
+ *
+ * The analyser must outlive the query.
+ */
+class SegmentQuery
+{
+public:
+
+    SegmentQuery(const SegmentAnalyser& a) :a(a) { } ///< query on the segments of @param a
+    virtual ~SegmentQuery() { }
+
+    /* steps */
+    SegmentQuery& filter(std::string name, double min, double max); ///< keeps the segments with parameter in [min, max], @see SegmentAnalyser::filter
+    SegmentQuery& filter(std::string name, double value); ///< keeps the segments with parameter equal to value, @see SegmentAnalyser::filter
+    SegmentQuery& crop(std::shared_ptr<SignedDistanceFunction> geometry); ///< crops the segments to the geometry, @see SegmentAnalyser::crop
+    SegmentQuery& cropDomain(double xx, double yy, double zz); ///< crops to the domain, @see SegmentAnalyser::cropDomain
+    SegmentQuery& mapPeriodic(double xx, double yy); ///< maps into a periodic domain, @see SegmentAnalyser::mapPeriodic
+
+    /* aggregates (each runs the query) */
+    int getNumberOfSegments() const; ///< number of resulting segments
+    double getSummed(std::string name) const; ///< sums up the parameter, @see SegmentAnalyser::getSummed
+    std::vector<double> distribution(std::string name, double top, double bot, int n, bool exact=false) const; ///< @see SegmentAnalyser::distribution
+    std::vector<std::vector<double>> distribution2(std::string name, double top, double bot, double left, double right, int n, int m,
+        bool exact=false) const; ///< @see SegmentAnalyser::distribution2
+    std::vector<std::vector<std::vector<double>>> distribution3(std::string name, double top, double bot, double left, double right,
+        double front, double back, int n, int m, int o, bool exact=false) const; ///< @see SegmentAnalyser::distribution3
+    SegmentAnalyser analyser() const; ///< materialises the resulting segments, with all user data
+
+    std::string toString() const; ///< quick info for debugging
+
+protected:
+
+    enum StepTypes { st_filter = 0, st_filterValue = 1, st_crop = 2, st_periodic = 3 };
+
+    struct Step {
+        int type; ///< StepTypes
+        std::string name; ///< parameter name (filter)
+        double min; ///< minimal value (filter), or value (filterValue), or period (periodic)
+        double max; ///< maximal value (filter)
+        std::shared_ptr<SignedDistanceFunction> geometry; ///< geometry (crop)
+        Vector3d axis; ///< periodic direction (periodic)
+    };
+
+    /** a segment (or a part of it) passing the steps */
+    struct Piece {
+        Vector3d x; ///< first node
+        Vector3d y; ///< second node
+        int nx; ///< index of the first node in the analyser, or -1 for a new node
+        int ny; ///< index of the second node in the analyser, or -1 for a new node
+    };
+
+    void run(const std::function<void(int si, const Piece& p)>& f) const; ///< runs the steps, calls f for each resulting piece of segment si
+    bool geometric(std::string name) const; ///< parameter is derived from the segment geometry (length, surface, volume)
+    SegmentAnalyser aggregate(std::string name) const; ///< resulting segments, with the data needed for parameter @param name
+
+    const SegmentAnalyser& a;
+    std::vector<Step> steps;
+
+};
+
+} // namespace CPlantBox
+
+#endif
@@ -0,0 +1,73 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+#ifndef SHAREDVECTOR_H_
+#define SHAREDVECTOR_H_
+
+#include <vector>
+#include <memory>
+#include <atomic>
+
+namespace CPlantBox {
+
+/**
+ * SharedVector
+ *
+ * A std::vector with copy on write semantics: copies share the same data,
+ * which is copied when one of them is changed (@see Organism::fork).
+ *
+ * Read access is const, write access is by SharedVector::push_back, SharedVector::resize,
+ * SharedVector::clear, or by SharedVector::modify, which returns the (unshared) std::vector.
+ * References obtained by SharedVector::get or SharedVector::modify become invalid by the next write access.
+ */
+template<class T>
+class SharedVector
+{
+public:
+
+    using value_type = T;
+    using const_iterator = typename std::vector<T>::const_iterator;
+
+    SharedVector() { } ///< empty vector (without allocation)
+    SharedVector(const std::vector<T>& v) :data_(std::make_shared<std::vector<T>>(v)) { } ///< copies the vector
+    SharedVector(std::vector<T>&& v) :data_(std::make_shared<std::vector<T>>(std::move(v))) { } ///< takes the vector
+
+    /* read access */
+    const std::vector<T>& get() const { return data_ ? *data_ : emptyData(); } ///< the data
+    operator const std::vector<T>&() const { return get(); } ///< the data
+    size_t size() const { return data_ ? data_->size() : 0; } ///< number of elements
+    bool empty() const { return size()==0; } ///< no elements
+    const T& operator[](size_t i) const { return (*data_)[i]; } ///< i-th element
+    const T& at(size_t i) const { return get().at(i); } ///< i-th element, with range check
+    const T& front() const { return data_->front(); } ///< first element
+    const T& back() const { return data_->back(); } ///< last element
+    const_iterator begin() const { return get().begin(); } ///< iterator to the first element
+    const_iterator end() const { return get().end(); } ///< iterator behind the last element
+    bool isShared() const { return data_ && (data_.use_count()>1); } ///< the data is shared with a copy
+
+    /* write access, copies shared data */
+    std::vector<T>& modify() {
+        if (!data_) {
+            data_ = std::make_shared<std::vector<T>>();
+        } else if (data_.use_count()>1) {
+            data_ = std::make_shared<std::vector<T>>(*data_);
+        } else {
+            std::atomic_thread_fence(std::memory_order_acquire); // former owners (e.g. in other threads) have finished reading
+        }
+        return *data_;
+    } ///< the unshared data for writing
+    void push_back(const T& x) { modify().push_back(x); } ///< appends an element
+    void resize(size_t n) { modify().resize(n); } ///< resizes the vector
+    void resize(size_t n, const T& x) { modify().resize(n, x); } ///< resizes the vector, new elements are x
+    void reserve(size_t n) { modify().reserve(n); } ///< reserves memory
+    void clear() { data_ = nullptr; } ///< removes all elements (releases the data)
+
+private:
+
+    static const std::vector<T>& emptyData() { static const std::vector<T> e; return e; } ///< empty data
+
+    std::shared_ptr<std::vector<T>> data_; ///< the (possibly shared) data, nullptr if empty
+
+};
+
+} // namespace CPlantBox
+
+#endif
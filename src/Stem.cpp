@@ -57,6 +57,7 @@ Stem::Stem(std::shared_ptr<Organism> plant, int type, Vector3d iheading, double
 
 	//        std::cout <<"subtype ="<<stem_p->subType <<"stem getPhytomerId =" <<getphytomerId(stem_p->subType)<< "\n";
 	addPhytomerId(stem_p->subType);
+	Organism::RandomScope scope(randomKey, 0, Organism::rp_rotation);
 	double beta = getphytomerId(stem_p->subType)*M_PI*getStemRandomParameter()->rotBeta +
 			M_PI*plant->rand()*getStemRandomParameter()->betaDev ;  //+ ; //2 * M_PI*plant->rand(); // initial rotation
 	Matrix3d ons = Matrix3d::ons(iHeading);
@@ -100,6 +101,23 @@ std::shared_ptr<Organ> Stem::copy(std::shared_ptr<Organism> p)
 	return s;
 }
 
+/**
+ * Copies the stem into the new plant @param p, sharing the specific parameters and the node data (@see Organ::fork).
+ *
+ * @param p     the plant the copied organ will be part of
+ */
+std::shared_ptr<Organ> Stem::fork(std::shared_ptr<Organism> p)
+{
+	auto s = std::make_shared<Stem>(*this); // shallow copy, shares parameters and node data
+	s->parent = std::weak_ptr<Organ>();
+	s->plant = p;
+	for (size_t i=0; i< children.size(); i++) {
+		s->children[i] = children[i]->fork(p); // fork laterals
+		s->children[i]->setParent(s);
+	}
+	return s;
+}
+
 /**
  * Simulates growth of this stem for a time span dt
  *
@@ -140,6 +158,7 @@ void Stem::simulate(double dt, bool verbose)
 			double P = getStemRandomParameter()->f_sbp->getValue(nodes.back(),shared_from_this());
 			if (P<1.) { // P==1 means the lateral emerges with probability 1 (default case)
 				double p = 1.-std::pow((1.-P), dt); //probability of emergence in this time step
+				Organism::RandomScope scope(randomKey, Organism::hashIndex(age), Organism::rp_emergence);
 				if (plant.lock()->rand()>p) { // not rand()<p
 					age -= dt; // the root does not emerge in this time step
 				}
@@ -216,6 +235,7 @@ void Stem::simulate(double dt, bool verbose)
 									//this decide which successor grow the leaf (TODO) adding it to parameterfile
 
 									createLateral(verbose);
+									Organism::RandomScope scope(randomKey, nodes.size()-1, Organism::rp_default);
 									if (getStemRandomParameter()->getLateralType(getNode(nodes.size()-1))==2){
 										leafGrow(verbose, nodes.back());
 									}else
@@ -347,6 +367,7 @@ void Stem::createLateral(bool silence)
 {
 	std::cout<<"lnf is = "<<getStemRandomParameter()->lnf<<"\n";
 	auto sp = param(); // rename
+	Organism::RandomScope scope(randomKey, nodes.size()-1, Organism::rp_lateral);
 	int lt = getStemRandomParameter()->getLateralType(getNode(nodes.size()-1));
         double ageLN = this->calcAge(length); // age of stem when lateral node is created
 		double ageLG = this->calcAge(length+sp->la); // age of the stem, when the lateral starts growing (i.e when the apical zone is developed)
@@ -609,11 +630,11 @@ void Stem::createSegments(double l, bool verbose)
 			if (olddx<dx()*0.99) { // shift node instead of creating a new node
 				shiftl = std::min(dx()-olddx, l);
 				double sdx = olddx + shiftl; // length of new segment
+				Organism::RandomScope scope(randomKey, Organism::hashIndex(length+shiftl), Organism::rp_tropism); // draws for the moved node
 				Vector3d newdxv = getIncrement(n2, sdx);
-				nodes[nn-1] = Vector3d(n2.plus(newdxv));
 				double et = this->calcCreationTime(length+shiftl);
-				nodeCTs[nn-1] = et; // in case of impeded growth the node emergence time is not exact anymore, but might break down to temporal resolution
-				moved = true;
+				// in case of impeded growth the node emergence time is not exact anymore, but might break down to temporal resolution
+				moveNode(nn-1, Vector3d(n2.plus(newdxv)), et);
 				l -= shiftl;
 				if (l<=0) { // ==0 should be enough
 					return;
@@ -643,6 +664,7 @@ void Stem::createSegments(double l, bool verbose)
 			}
 		}
 		sl += sdx;
+		Organism::RandomScope scope(randomKey, nodes.size(), Organism::rp_tropism); // draws for the new node
 		Vector3d newdx = getIncrement(nodes.back(), sdx);
 		Vector3d newnode = Vector3d(nodes.back().plus(newdx));
 		double et = this->calcCreationTime(length+shiftl+sl);
@@ -31,6 +31,7 @@ public:
     virtual ~Stem() { };
 
     std::shared_ptr<Organ> copy(std::shared_ptr<Organism> plant) override;   ///< deep copies the root tree
+    std::shared_ptr<Organ> fork(std::shared_ptr<Organism> plant) override;   ///< copies the stem tree, sharing parameters and node data
 
     int organType() const override { return Organism::ot_stem; } ///< returns the organs type
 
@@ -0,0 +1,240 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+#include "VTKWriter.h"
+
+#include <stdexcept>
+#include <algorithm>
+
+#ifdef USE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace CPlantBox {
+
+const size_t VTKWriter::blockSize;
+
+/**
+ * @param os        typically a file out stream
+ * @param format    VTKWriter::vtk_ascii, VTKWriter::vtk_raw, or VTKWriter::vtk_base64
+ * @param compress  zlib compression of the binary data (needs zlib at compile time)
+ */
+VTKWriter::VTKWriter(std::ostream& os, int format, bool compress) :os(os), format(format), compress(compress && (format!=vtk_ascii))
+{
+    if ((format<vtk_ascii) || (format>vtk_base64)) {
+        throw std::invalid_argument("VTKWriter::VTKWriter: unknown format "+std::to_string(format));
+    }
+    if (this->compress && !hasCompression()) {
+        throw std::invalid_argument("VTKWriter::VTKWriter: compression needs zlib, CPlantBox was compiled without");
+    }
+}
+
+/**
+ * @return true, if CPlantBox was compiled with zlib
+ */
+bool VTKWriter::hasCompression()
+{
+#ifdef USE_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * Writes the xml header, and opens the VTKFile and the data set element
+ *
+ * @param type      VTK data set type (e.g. "PolyData", "UnstructuredGrid")
+ */
+void VTKWriter::beginFile(std::string type)
+{
+    this->type = type;
+    appended.clear();
+    const uint16_t one = 1;
+    bool little = (*reinterpret_cast<const uint8_t*>(&one)==1);
+    os << "<?xml version=\"1.0\"?>";
+    os << "<VTKFile type=\"" << type << "\" version=\"0.1\" byte_order=\"" << (little ? "LittleEndian" : "BigEndian") << "\" header_type=\"UInt32\"";
+    if (compress) {
+        os << " compressor=\"vtkZLibDataCompressor\"";
+    }
+    os << ">\n<" << type << ">\n";
+}
+
+/**
+ * Closes the data set element, writes the appended data (if any), and closes the VTKFile element
+ */
+void VTKWriter::endFile()
+{
+    os << "</" << type << ">\n";
+    if (format!=vtk_ascii) {
+        os << "<AppendedData encoding=\"" << (format==vtk_raw ? "raw" : "base64") << "\">\n_";
+        os.write(appended.data(), appended.size());
+        os << "\n</AppendedData>\n";
+    }
+    os << "</VTKFile>\n";
+    appended.clear();
+}
+
+/**
+ * Opens a xml element
+ *
+ * @param name          element name (e.g. "Piece", "CellData")
+ * @param attributes    attributes of the element (e.g. "NumberOfPoints=\"2\"")
+ */
+void VTKWriter::openElement(std::string name, std::string attributes)
+{
+    os << "<" << name;
+    if (!attributes.empty()) {
+        os << " " << attributes;
+    }
+    os << ">\n";
+}
+
+/**
+ * Closes a xml element
+ */
+void VTKWriter::closeElement(std::string name)
+{
+    os << "\n</" << name << ">\n";
+}
+
+/**
+ * Writes a Float32 data array
+ *
+ * @param name          name of the data array
+ * @param data          values, components are stored consecutively
+ * @param components    number of components per tuple (e.g. 3 for coordinates)
+ */
+void VTKWriter::dataArray(std::string name, const std::vector<float>& data, int components)
+{
+    if (format==vtk_ascii) {
+        os << "<DataArray type=\"Float32\" Name=\"" << name << "\" NumberOfComponents=\"" << components << "\" format=\"ascii\" >\n";
+        for (const auto& d : data) {
+            os << d << " ";
+        }
+        os << "\n</DataArray>\n";
+    } else {
+        binaryArray(name, "Float32", reinterpret_cast<const uint8_t*>(data.data()), data.size()*sizeof(float), components);
+    }
+}
+
+/**
+ * Writes an Int32 data array (e.g. connectivity, or offsets)
+ */
+void VTKWriter::dataArray(std::string name, const std::vector<int32_t>& data, int components)
+{
+    if (format==vtk_ascii) {
+        os << "<DataArray type=\"Int32\" Name=\"" << name << "\" NumberOfComponents=\"" << components << "\" format=\"ascii\" >\n";
+        for (const auto& d : data) {
+            os << d << " ";
+        }
+        os << "\n</DataArray>\n";
+    } else {
+        binaryArray(name, "Int32", reinterpret_cast<const uint8_t*>(data.data()), data.size()*sizeof(int32_t), components);
+    }
+}
+
+/**
+ * Writes an UInt8 data array (e.g. cell types of an unstructured grid)
+ */
+void VTKWriter::dataArray(std::string name, const std::vector<uint8_t>& data, int components)
+{
+    if (format==vtk_ascii) {
+        os << "<DataArray type=\"UInt8\" Name=\"" << name << "\" NumberOfComponents=\"" << components << "\" format=\"ascii\" >\n";
+        for (const auto& d : data) {
+            os << int(d) << " ";
+        }
+        os << "\n</DataArray>\n";
+    } else {
+        binaryArray(name, "UInt8", data.data(), data.size(), components);
+    }
+}
+
+/**
+ * Writes the DataArray element referring to the appended data, and appends header and data.
+ *
+ * Uncompressed, the header is the number of bytes. Compressed, the data is split into blocks of VTKWriter::blockSize bytes,
+ * and the header is [number of blocks, block size, size of the last block, compressed size of each block].
+ * For base64, header and data are encoded separately (like VTK does).
+ *
+ * @param name          name of the data array
+ * @param type          VTK type name
+ * @param data          the bytes
+ * @param n             number of bytes
+ * @param components    number of components per tuple
+ */
+void VTKWriter::binaryArray(std::string name, std::string type, const uint8_t* data, size_t n, int components)
+{
+    os << "<DataArray type=\"" << type << "\" Name=\"" << name << "\" NumberOfComponents=\"" << components
+        << "\" format=\"appended\" offset=\"" << appended.size() << "\" />\n";
+    if (n>UINT32_MAX) {
+        throw std::invalid_argument("VTKWriter::binaryArray: data array "+name+" exceeds the UInt32 header");
+    }
+    if (!compress) {
+        uint32_t header = n;
+        appendBlock(reinterpret_cast<const uint8_t*>(&header), sizeof(uint32_t));
+        appendBlock(data, n);
+        return;
+    }
+#ifdef USE_ZLIB
+    size_t nb = (n + blockSize - 1) / blockSize; // number of blocks
+    std::vector<uint32_t> header(3 + nb);
+    header[0] = nb;
+    header[1] = blockSize;
+    header[2] = n % blockSize; // 0 means the last block is full
+    std::vector<uint8_t> buffer;
+    std::vector<uint8_t> block(compressBound(blockSize));
+    for (size_t i=0; i<nb; i++) {
+        size_t bs = std::min(blockSize, n - i*blockSize);
+        uLongf cs = block.size();
+        if (compress2(block.data(), &cs, data + i*blockSize, bs, Z_DEFAULT_COMPRESSION)!=Z_OK) {
+            throw std::runtime_error("VTKWriter::binaryArray: zlib compression failed for data array "+name);
+        }
+        header[3+i] = cs;
+        buffer.insert(buffer.end(), block.begin(), block.begin() + cs);
+    }
+    appendBlock(reinterpret_cast<const uint8_t*>(header.data()), header.size()*sizeof(uint32_t));
+    appendBlock(buffer.data(), buffer.size());
+#endif
+}
+
+/**
+ * Appends raw bytes, or their base64 encoding
+ */
+void VTKWriter::appendBlock(const uint8_t* data, size_t n)
+{
+    if (format==vtk_raw) {
+        appended.append(reinterpret_cast<const char*>(data), n);
+    } else {
+        appended.append(base64(data, n));
+    }
+}
+
+/**
+ * @return the base64 encoding of @param n bytes @param data
+ */
+std::string VTKWriter::base64(const uint8_t* data, size_t n)
+{
+    static const char* table = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string s;
+    s.reserve(4*((n+2)/3));
+    size_t i = 0;
+    for (; i+2<n; i+=3) {
+        uint32_t v = (uint32_t(data[i])<<16) | (uint32_t(data[i+1])<<8) | uint32_t(data[i+2]);
+        s.push_back(table[(v>>18) & 63]);
+        s.push_back(table[(v>>12) & 63]);
+        s.push_back(table[(v>>6) & 63]);
+        s.push_back(table[v & 63]);
+    }
+    if (i<n) { // 1 or 2 bytes left
+        uint32_t v = uint32_t(data[i])<<16;
+        if (i+1<n) {
+            v |= uint32_t(data[i+1])<<8;
+        }
+        s.push_back(table[(v>>18) & 63]);
+        s.push_back(table[(v>>12) & 63]);
+        s.push_back(i+1<n ? table[(v>>6) & 63] : '=');
+        s.push_back('=');
+    }
+    return s;
+}
+
+} // namespace CPlantBox
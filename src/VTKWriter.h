@@ -0,0 +1,59 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+#ifndef VTKWRITER_H_
+#define VTKWRITER_H_
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <cstdint>
+
+namespace CPlantBox {
+
+/**
+ * VTKWriter
+ *
+ * Writes VTK XML files (e.g. VTP, or VTU) with ascii data, or binary appended data (raw or base64 encoded),
+ * optionally zlib compressed in blocks (needs zlib at compile time).
+ *
+ * The caller writes the elements of the file, e.g.
+ * beginFile("PolyData"), openElement("Piece", ...), dataArray(...), ..., closeElement("Piece"), endFile()
+ */
+class VTKWriter
+{
+public:
+
+    enum Formats { vtk_ascii = 0, vtk_raw = 1, vtk_base64 = 2 }; ///< data format of the data arrays
+
+    VTKWriter(std::ostream& os, int format = vtk_ascii, bool compress = false); ///< compression is ignored for ascii
+    virtual ~VTKWriter() { }
+
+    void beginFile(std::string type); ///< writes the header, type is the VTK data set type (e.g. "PolyData", "UnstructuredGrid")
+    void endFile(); ///< writes the appended data, and closes the file
+    void openElement(std::string name, std::string attributes = ""); ///< opens a xml element, e.g. openElement("Piece", "NumberOfPoints=\"2\"")
+    void closeElement(std::string name); ///< closes a xml element
+
+    void dataArray(std::string name, const std::vector<float>& data, int components = 1); ///< writes a Float32 data array
+    void dataArray(std::string name, const std::vector<int32_t>& data, int components = 1); ///< writes an Int32 data array
+    void dataArray(std::string name, const std::vector<uint8_t>& data, int components = 1); ///< writes an UInt8 data array (e.g. VTU cell types)
+
+    static bool hasCompression(); ///< true, if compiled with zlib
+    static std::string base64(const uint8_t* data, size_t n); ///< base64 encoding
+
+    static const size_t blockSize = 32768; ///< size of the compressed blocks before compression [byte]
+
+protected:
+
+    void binaryArray(std::string name, std::string type, const uint8_t* data, size_t n, int components); ///< appends binary data
+    void appendBlock(const uint8_t* data, size_t n); ///< appends raw bytes, or their base64 encoding
+
+    std::ostream& os;
+    int format;
+    bool compress;
+    std::string type; ///< VTK data set type
+    std::string appended; ///< appended data, written by VTKWriter::endFile
+
+};
+
+} // namespace CPlantBox
+
+#endif
@@ -2,6 +2,7 @@
 #include "XylemFlux.h"
 
 #include <algorithm>
+#include <numeric>
 
 // #include "../external/gauss_legendre/gauss_legendre.h"
 
@@ -18,82 +19,312 @@ namespace CPlantBox {
  */
 void XylemFlux::linearSystem(double simTime, const std::vector<double>& sx, bool cells, const std::vector<double> soil_k)
 {
+    updateCoefficients(simTime, sx, cells, soil_k);
     int Ns = rs->segments.size(); // number of segments
-    aI.resize(4*Ns);
-    aJ.resize(4*Ns);
-    aV.resize(4*Ns);
     int N = rs->nodes.size(); // number of nodes
+    if (aI.size()!=4*Ns) { // matrix structure (cleared by updateCoefficients if it changed)
+        aI.resize(4*Ns);
+        aJ.resize(4*Ns);
+        for (int si = 0; si<Ns; si++) {
+            int i = rs->segments[si].x;
+            int j = rs->segments[si].y;
+            aI[4*si] = i; aJ[4*si] = i;
+            aI[4*si+1] = i; aJ[4*si+1] = j;
+            aI[4*si+2] = j; aJ[4*si+2] = j; // edge ji
+            aI[4*si+3] = j; aJ[4*si+3] = i;
+        }
+    }
+    aV.resize(4*Ns);
     aB.resize(N);
     std::fill(aB.begin(), aB.end(), 0.);
-    std::fill(aV.begin(), aV.end(), 0.);
-    std::fill(aI.begin(), aI.end(), 0);
-    std::fill(aJ.begin(), aJ.end(), 0);
-    size_t k=0;
     for (int si = 0; si<Ns; si++) {
+        int i = rs->segments[si].x;
+        int j = rs->segments[si].y;
+        double cii = segCii[si];
+        double cij = segCij[si];
+        double psi_s = segPsi[si];
+        aB[i] += ( segBi[si] + cii * psi_s +cij * psi_s) ;
+        aB[j] += ( -segBi[si] + cii * psi_s +cij * psi_s) ; // (-bi) Eqn (14) with changed sign
+        aV[4*si] = cii;
+        aV[4*si+1] = cij;
+        aV[4*si+2] = cii;
+        aV[4*si+3] = cij;
+    }
+}
+
+/**
+ * Assembles and solves the linear system in C++, the matrix is never exported.
+ *
+ * The segments form a tree, therefore the system is solved by Gaussian elimination along the tree
+ * (from the tips towards the collar, and back substitution from the collar to the tips),
+ * which needs no pivoting, produces no fill in, and has linear complexity.
+ *
+ * @param simTime           [days] current simulation time is needed for age dependent conductivities
+ * @param sx                soil matric potential in the cells or around the segments
+ * @param cells             sx per cell (true), or segments (false)
+ * @param bcType            boundary condition at the root collar (node 0), bct_neumann or bct_dirichlet
+ * @param bcValue           collar flux [cm3 day-1] (Neumann), or collar matric potential [cm] (Dirichlet)
+ * @param soil_k            optional soil conductivities limiting kr per segment
+ *
+ * @return root xylem matric potential per node [cm]
+ */
+std::vector<double> XylemFlux::solve(double simTime, const std::vector<double>& sx, bool cells, int bcType, double bcValue,
+    const std::vector<double> soil_k)
+{
+    updateCoefficients(simTime, sx, cells, soil_k);
+    if (treeParent.size()!=rs->nodes.size()) { // cleared by updateCoefficients if the structure changed
+        updateTree();
+    }
 
+    int Ns = rs->segments.size(); // number of segments
+    int N = rs->nodes.size(); // number of nodes
+    std::vector<double> diag = std::vector<double>(N, 0.); // tree matrix: diagonal per node, one off diagonal entry per segment (segCij)
+    std::vector<double> b = std::vector<double>(N, 0.);
+    for (int si = 0; si<Ns; si++) {
         int i = rs->segments[si].x;
         int j = rs->segments[si].y;
+        double cii = segCii[si];
+        double psi_s = segPsi[si];
+        diag[i] += cii;
+        diag[j] += cii;
+        b[i] += ( segBi[si] + cii * psi_s +segCij[si] * psi_s);
+        b[j] += ( -segBi[si] + cii * psi_s +segCij[si] * psi_s);
+    }
+    if (bcType==bct_neumann) {
+        b[0] += bcValue;
+    }
 
-        double psi_s;
+    // elimination from the tips towards the collar
+    for (int k = treeOrder.size()-1; k>=0; k--) {
+        int i = treeOrder[k];
+        int p = treeParent[i];
+        if ((p<0) || ((p==0) && (bcType==bct_dirichlet))) { // Dirichlet row is replaced by the identity
+            continue;
+        }
+        double f = segCij[treeParentSeg[i]]/diag[i];
+        diag[p] -= f*segCij[treeParentSeg[i]];
+        b[p] -= f*b[i];
+    }
+
+    // back substitution from the collar towards the tips
+    std::vector<double> x = std::vector<double>(N, 0.);
+    for (int i : treeOrder) {
+        int p = treeParent[i];
+        if (p<0) {
+            if ((i==0) && (bcType==bct_dirichlet)) {
+                x[i] = bcValue;
+            } else {
+                x[i] = b[i]/diag[i];
+            }
+        } else {
+            x[i] = (b[i] - segCij[treeParentSeg[i]]*x[p])/diag[i];
+        }
+    }
+    return x;
+}
+
+/**
+ * Computes the matrix entries and the soil matric potential of all segments (segCii, segCij, segBi, segPsi).
+ *
+ * In incremental mode, the matrix entries are only recomputed for segments that are new, were moved or reconnected,
+ * changed radius, type or soil conductivity, or whose conductivities still depend on age.
+ * The soil matric potentials are always updated, since they only enter the load.
+ */
+void XylemFlux::updateCoefficients(double simTime, const std::vector<double>& sx, bool cells, const std::vector<double>& soil_k)
+{
+    int Ns = rs->segments.size(); // number of segments
+    if (!incremental) {
+        cSegs.clear();
+    }
+    int nc = std::min(cSegs.size(), rs->segments.size()); // number of cached segments
+    bool structureChanged = (cSegs.size()!=Ns);
+    segCii.resize(Ns);
+    segCij.resize(Ns);
+    segBi.resize(Ns);
+    segPsi.resize(Ns);
+    if (incremental) {
+        cSegs.resize(Ns);
+        cN1.resize(Ns);
+        cN2.resize(Ns);
+        cRadii.resize(Ns);
+        cSoilK.resize(Ns);
+        cTypes.resize(Ns);
+        cMature.resize(Ns);
+    }
+    std::vector<int> update; // segments with new matrix entries
+    update.reserve(incremental ? Ns-nc : Ns);
+    for (int si = 0; si<Ns; si++) {
+
+        const Vector2i& s = rs->segments[si];
         if (cells) { // soil matric potential given per cell
-            psi_s = sx.at(rs->seg2cell[j-1]); // segIdx = s.y-1
+            segPsi[si] = sx.at(rs->seg2cell.at(s.y-1)); // segIdx = s.y-1
         } else {
-            psi_s = sx.at(j-1); // segIdx = s.y-1
-            if (si!=j-1) {
+            segPsi[si] = sx.at(s.y-1); // segIdx = s.y-1
+            if (si!=s.y-1) {
                 std::cout << "OUCH \n";
                 throw "help";
             }
         }
 
-        double a = rs->radii[si]; // si is correct, with ordered and unordered segmetns
-        double age = simTime - rs->nodeCTs[j];
-        int type = rs->types[si];
-        double kx = 0.;
-        double  kr = 0.;
-        try {
-            kx = kx_f(age, type);
-            kr = kr_f(age, type);
-        } catch(...) {
-            std::cout << "conductivities failed\n" << std::flush;
+        if (!incremental) {
+            update.push_back(si);
+            continue;
+        }
+
+        const Vector3d& n1 = rs->nodes[s.x];
+        const Vector3d& n2 = rs->nodes[s.y];
+        double age = simTime - rs->nodeCTs[s.y];
+        double sk = (soil_k.size()>0) ? soil_k[si] : std::numeric_limits<double>::infinity();
+        bool mature = (age>=krModel.maxAge()) && (age>=kxModel.maxAge());
+        bool valid = (si<nc) && (cSegs[si].x==s.x) && (cSegs[si].y==s.y);
+        if (!valid && (si<nc)) {
+            structureChanged = true; // reconnected
         }
-        //        if (age<=0) {
-        //            std::cout << si << ", " << j <<" age leq 0 " << age << ", " << kx <<  ", " << kr << ", time "<< simTime << ", " << rs->nodeCTs[j] << "\n";
-        //        }
-        if (soil_k.size()>0) {
-            kr = std::min(kr, soil_k[si]);
+        valid = valid && cMature[si] && mature && (cRadii[si]==rs->radii[si]) && (cTypes[si]==rs->types[si]) && (cSoilK[si]==sk)
+            && (cN1[si].x==n1.x) && (cN1[si].y==n1.y) && (cN1[si].z==n1.z) && (cN2[si].x==n2.x) && (cN2[si].y==n2.y) && (cN2[si].z==n2.z);
+        if (!valid) {
+            update.push_back(si);
+            cSegs[si] = s;
+            cN1[si] = n1;
+            cN2[si] = n2;
+            cRadii[si] = rs->radii[si];
+            cTypes[si] = rs->types[si];
+            cSoilK[si] = sk;
+            cMature[si] = mature;
         }
+    }
+
+    std::vector<double> kr, kx;
+    conductivities(simTime, update, kr, kx);
+    for (size_t k = 0; k<update.size(); k++) {
+        int si = update[k];
+        segmentCoefficients(si, kr[k], kx[k], soil_k, segCii[si], segCij[si], segBi[si]);
+    }
+    if (structureChanged) { // rebuild matrix structure and elimination order
+        aI.clear();
+        aJ.clear();
+        treeParent.clear();
+    }
+}
+
+/**
+ * Matrix entries of a single segment, Eqns (16)-(18)
+ *
+ * @param si                segment index
+ * @param kr                radial conductivity of the segment [1 day-1]
+ * @param kx                axial conductivity of the segment [cm3 day-1]
+ * @param soil_k            optional soil conductivities limiting kr per segment
+ * @param cii               [out] diagonal entry
+ * @param cij               [out] off diagonal entry
+ * @param bi                [out] gravitational part of the load
+ */
+void XylemFlux::segmentCoefficients(int si, double kr, double kx, const std::vector<double>& soil_k, double& cii, double& cij, double& bi)
+{
+    int i = rs->segments[si].x;
+    int j = rs->segments[si].y;
 
-        auto n1 = rs->nodes[i];
-        auto n2 = rs->nodes[j];
-        auto v = n2.minus(n1);
-        double l = v.length();
-        if (l<1.e-5) {
-            std::cout << "segment length smaller 1.e-5 \n"; // quick fix?
-            l = 1.e-5;
+    double a = rs->radii[si]; // si is correct, with ordered and unordered segmetns
+    if (soil_k.size()>0) {
+        kr = std::min(kr, soil_k[si]);
+    }
+
+    auto n1 = rs->nodes[i];
+    auto n2 = rs->nodes[j];
+    auto v = n2.minus(n1);
+    double l = v.length();
+    if (l<1.e-5) {
+        std::cout << "segment length smaller 1.e-5 \n"; // quick fix?
+        l = 1.e-5;
+    }
+    double vz = v.z / l; // normed direction
+
+    double tau = std::sqrt(2.*a * M_PI * kr / kx); // Eqn (2)
+    double delta = std::exp(-tau * l) - std::exp(tau * l); // Eqn (5)
+    double idelta = 1. / delta;
+
+    cii = -kx * idelta * tau * (std::exp(-tau * l) + std::exp(tau * l)); // Eqn (16)
+    cij = 2 * kx * idelta * tau;  // Eqn 17
+    bi = kx * vz; //  # Eqn 18
+}
+
+/**
+ * Radial and axial conductivities of the segments @param segIdx, evaluated in one sweep
+ *
+ * @param simTime           [days] current simulation time, age = simTime - segment creation time
+ * @param segIdx            segment indices
+ * @param kr                [out] radial conductivities [1 day-1]
+ * @param kx                [out] axial conductivities [cm3 day-1]
+ */
+void XylemFlux::conductivities(double simTime, const std::vector<int>& segIdx, std::vector<double>& kr, std::vector<double>& kx) const
+{
+    size_t n = segIdx.size();
+    std::vector<double> ages = std::vector<double>(n);
+    std::vector<int> types = std::vector<int>(n);
+    for (size_t k = 0; k<n; k++) {
+        int si = segIdx[k];
+        ages[k] = simTime - rs->nodeCTs[rs->segments[si].y];
+        types[k] = rs->types[si];
+    }
+    kr.resize(n);
+    kx.resize(n);
+    try {
+        kxModel.evaluate(ages.data(), types.data(), n, kx.data());
+        krModel.evaluate(ages.data(), types.data(), n, kr.data());
+    } catch(...) {
+        std::cout << "conductivities failed\n" << std::flush;
+        throw;
+    }
+}
+
+/**
+ * Orders the nodes breadth first starting at the collar (node 0), so that each parent precedes its children.
+ * Each component of a disconnected system starts at its smallest node index.
+ */
+void XylemFlux::updateTree()
+{
+    int Ns = rs->segments.size(); // number of segments
+    int N = rs->nodes.size(); // number of nodes
+
+    // node to segment adjacency (compressed row storage)
+    std::vector<int> adjStart = std::vector<int>(N+1, 0);
+    for (const auto& s : rs->segments) {
+        adjStart[s.x+1]++;
+        adjStart[s.y+1]++;
+    }
+    for (int i = 0; i<N; i++) {
+        adjStart[i+1] += adjStart[i];
+    }
+    std::vector<int> adjSeg = std::vector<int>(2*Ns);
+    std::vector<int> fill = std::vector<int>(adjStart.begin(), adjStart.end()-1);
+    for (int si = 0; si<Ns; si++) {
+        adjSeg[fill[rs->segments[si].x]++] = si;
+        adjSeg[fill[rs->segments[si].y]++] = si;
+    }
+
+    treeOrder.clear();
+    treeOrder.reserve(N);
+    treeParent = std::vector<int>(N, -2); // -2 unvisited, -1 component root
+    treeParentSeg = std::vector<int>(N, -1);
+    for (int r = 0; r<N; r++) {
+        if ((treeParent[r]!=-2) || (adjStart[r]==adjStart[r+1])) { // visited, or not part of any segment
+            continue;
+        }
+        treeParent[r] = -1;
+        size_t c = treeOrder.size();
+        treeOrder.push_back(r);
+        while (c<treeOrder.size()) {
+            int i = treeOrder[c];
+            c++;
+            for (int k = adjStart[i]; k<adjStart[i+1]; k++) {
+                int si = adjSeg[k];
+                int j = (rs->segments[si].x==i) ? rs->segments[si].y : rs->segments[si].x;
+                if (treeParent[j]==-2) {
+                    treeParent[j] = i;
+                    treeParentSeg[j] = si;
+                    treeOrder.push_back(j);
+                }
+            }
         }
-        double vz = v.z / l; // normed direction
-
-        double tau = std::sqrt(2.*a * M_PI * kr / kx); // Eqn (2)
-        double delta = std::exp(-tau * l) - std::exp(tau * l); // Eqn (5)
-        double idelta = 1. / delta;
-
-        double cii = -kx * idelta * tau * (std::exp(-tau * l) + std::exp(tau * l)); // Eqn (16)
-        double cij = 2 * kx * idelta * tau;  // Eqn 17
-        double bi = kx * vz; //  # Eqn 18
-
-        aB[i] += ( bi + cii * psi_s +cij * psi_s) ;
-        aI[k] = i; aJ[k]= i; aV[k] = cii;
-        k += 1;
-        aI[k] = i; aJ[k] = j;  aV[k] = cij;
-        k += 1;
-
-        int ii = i;
-        i = j;  j = ii; // edge ji
-        aB[i] += ( -bi + cii * psi_s +cij * psi_s) ; // (-bi) Eqn (14) with changed sign
-        aI[k] = i; aJ[k]= i; aV[k] = cii;
-        k += 1;
-        aI[k] = i; aJ[k] = j;  aV[k] = cij;
-        k += 1;
     }
 }
 
@@ -173,6 +404,10 @@ std::map<int,double> XylemFlux::soilFluxes(double simTime, const std::vector<dou
 std::vector<double> XylemFlux::segFluxes(double simTime, const std::vector<double>& rx, const std::vector<double>& sx, bool approx, bool cells)
 {
     std::vector<double> fluxes = std::vector<double>(rs->segments.size());
+    std::vector<int> segIdx = std::vector<int>(rs->segments.size());
+    std::iota(segIdx.begin(), segIdx.end(), 0);
+    std::vector<double> kr_, kx_;
+    conductivities(simTime, segIdx, kr_, kx_); // one sweep
     for (int si = 0; si<rs->segments.size(); si++) {
 
         int i = rs->segments[si].x;
@@ -180,16 +415,14 @@ std::vector<double> XylemFlux::segFluxes(double simTime, const std::vector<doubl
 
         double psi_s;
         if (cells) { // soil matric potential given per cell
-            psi_s = sx.at(rs->seg2cell[si]);
+            psi_s = sx.at(rs->seg2cell.at(si));
         } else {
             psi_s = sx.at(si);
         }
 
         double a = rs->radii[si]; // si is correct, with ordered and unordered segments
-        double age = simTime - rs->nodeCTs[j];
-        int type = rs->types[si];
-        double  kr = kr_f(age, type);
-        double  kz = kx_f(age, type);
+        double  kr = kr_[si];
+        double  kz = kx_[si];
 
         Vector3d n1 = rs->nodes[i];
         Vector3d n2 = rs->nodes[j];
@@ -283,12 +516,13 @@ std::vector<double> XylemFlux::segOuterRadii(int type) const {
     double cellVolume = width.x*width.y*width.z/rs->resolution.x/rs->resolution.y/rs->resolution.z; // TODO only true for equidistant rectangular grid
     std::vector<double> radii = std::vector<double>(rs->segments.size());
     std::fill(radii.begin(), radii.end(), 0.);
-    auto& map = rs->cell2seg;
-    for(auto iter = map.begin(); iter != map.end(); ++iter) {
-        int cellId =  iter->first;
-        auto segs = map.at(cellId);
+    rs->updateCell2Seg();
+    for (int cellId = 0; cellId<int(rs->cell2segStart.size())-1; cellId++) {
+        const int* segs_begin = rs->cell2segs.data() + rs->cell2segStart[cellId];
+        const int* segs_end = rs->cell2segs.data() + rs->cell2segStart[cellId+1];
         double v = 0.;  // calculate sum of root volumes or surfaces over cell
-        for (int i : segs) {
+        for (const int* it = segs_begin; it!=segs_end; ++it) {
+            int i = *it;
             if (type==0) { // volume
                 v += M_PI*(rs->radii[i]*rs->radii[i])*lengths[i];
             } else if (type==1) { // surface
@@ -297,7 +531,8 @@ std::vector<double> XylemFlux::segOuterRadii(int type) const {
                 v += lengths[i];
             }
         }
-        for (int i : segs) { // calculate outer radius
+        for (const int* it = segs_begin; it!=segs_end; ++it) { // calculate outer radius
+            int i = *it;
             double l = lengths[i];
             double t =0.; // proportionality factor (must sum up to == 1 over cell)
             if (type==0) { // volume
@@ -327,8 +562,8 @@ std::map<int,double> XylemFlux::sumSegFluxes(const std::vector<double>& segFluxe
     for (int si = 0; si<rs->segments.size(); si++) {
         int j = rs->segments[si].y;
         int segIdx = j-1;
-        if (rs->seg2cell.count(segIdx)>0) {
-            int cellIdx = rs->seg2cell[segIdx];
+        int cellIdx = (segIdx<int(rs->seg2cell.size())) ? rs->seg2cell[segIdx] : -1;
+        if (cellIdx>=0) {
             if (fluxes.count(cellIdx)==0) {
                 fluxes[cellIdx] = segFluxes[segIdx];
             } else {
@@ -350,12 +585,16 @@ std::vector<double> XylemFlux::splitSoilFluxes(const std::vector<double>& soilFl
     auto lengths =  this->segLength();
     std::vector<double> fluxes = std::vector<double>(rs->segments.size());
     std::fill(fluxes.begin(), fluxes.end(), 0.);
-    auto map = rs->cell2seg;
-    for(auto iter = map.begin(); iter != map.end(); ++iter) {
-        int cellId =  iter->first;
-        auto segs = map.at(cellId);
+    rs->updateCell2Seg();
+    for (int cellId = 0; cellId<int(rs->cell2segStart.size())-1; cellId++) {
+        const int* segs_begin = rs->cell2segs.data() + rs->cell2segStart[cellId];
+        const int* segs_end = rs->cell2segs.data() + rs->cell2segStart[cellId+1];
+        if (segs_begin==segs_end) {
+            continue;
+        }
         double v = 0.;  // calculate sum over cell
-        for (int i : segs) {
+        for (const int* it = segs_begin; it!=segs_end; ++it) {
+            int i = *it;
             if (type==0) { // volume
                 v += M_PI*(rs->radii[i]*rs->radii[i])*lengths[i];
             } else if (type==1) { // surface
@@ -364,7 +603,8 @@ std::vector<double> XylemFlux::splitSoilFluxes(const std::vector<double>& soilFl
                 v += lengths[i];
             }
         }
-        for (int i : segs) { // calculate outer radius
+        for (const int* it = segs_begin; it!=segs_end; ++it) { // calculate outer radius
+            int i = *it;
             double t =0.; // proportionality factor (must sum up to == 1 over cell)
             if (type==0) { // volume
                 t = M_PI*(rs->radii[i]*rs->radii[i])*lengths[i]/v;
@@ -398,16 +638,16 @@ std::vector<double> XylemFlux::segLength() const {
 void XylemFlux::setKr(std::vector<double> values, std::vector<double> age) {
     kr = values;
     kr_t = age;
+    resetCache();
     if (age.size()==0) {
+        krModel.setValues(values);
         if (values.size()==1) {
-            kr_f = std::bind(&XylemFlux::kr_const, this, std::placeholders::_1, std::placeholders::_2);
             std::cout << "Kr is constant " << values[0] << " cm2 day g-1 \n";
         } else {
-            kr_f  = std::bind(&XylemFlux::kr_perType, this, std::placeholders::_1, std::placeholders::_2);
             std::cout << "Kr is constant per type, type 0 = " << values[0] << " cm2 day g-1 \n";
         }
     } else {
-        kr_f  = std::bind(&XylemFlux::kr_table, this, std::placeholders::_1, std::placeholders::_2);
+        krModel.setTable(values, age);
         std::cout << "Kr is age dependent\n";
     }
 }
@@ -419,16 +659,16 @@ void XylemFlux::setKr(std::vector<double> values, std::vector<double> age) {
 void XylemFlux::setKx(std::vector<double> values, std::vector<double> age) {
     kx = values;
     kx_t = age;
+    resetCache();
     if (age.size()==0) {
+        kxModel.setValues(values);
         if (values.size()==1) {
-            kx_f = std::bind(&XylemFlux::kx_const, this, std::placeholders::_1, std::placeholders::_2);
             std::cout << "Kx is constant " << values[0] << " cm2 day g-1 \n";
         } else {
-            kx_f  = std::bind(&XylemFlux::kx_perType, this, std::placeholders::_1, std::placeholders::_2);
             std::cout << "Kx is constant per type, type 0 = " << values[0] << " cm2 day g-1 \n";
         }
     } else {
-        kx_f  = std::bind(&XylemFlux::kx_table, this, std::placeholders::_1, std::placeholders::_2);
+        kxModel.setTable(values, age);
         std::cout << "Kx is age dependent\n";
     }
 }
@@ -437,12 +677,10 @@ void XylemFlux::setKx(std::vector<double> values, std::vector<double> age) {
  *  Sets the radial conductivity in [1 day-1]
  */
 void XylemFlux::setKrTables(std::vector<std::vector<double>> values, std::vector<std::vector<double>> age) {
-    krs.resize(0);
-    for (auto v :values) {
-        krs.push_back(v);
-    }
+    krs = values;
     krs_t = age;
-    kr_f = std::bind(&XylemFlux::kr_tablePerType, this, std::placeholders::_1, std::placeholders::_2);
+    resetCache();
+    krModel.setTables(values, age);
     std::cout << "Kr is age dependent per root type\n";
 }
 
@@ -450,29 +688,102 @@ void XylemFlux::setKrTables(std::vector<std::vector<double>> values, std::vector
  *  Sets the axial conductivity in [cm3 day-1]
  */
 void XylemFlux::setKxTables(std::vector<std::vector<double>> values, std::vector<std::vector<double>> age) {
-    kxs.resize(0);
-    for (auto v :values) {
-        kxs.push_back(v);
-    }
+    kxs = values;
     kxs_t = age;
-    kx_f = std::bind(&XylemFlux::kx_tablePerType, this, std::placeholders::_1, std::placeholders::_2);
+    resetCache();
+    kxModel.setTables(values, age);
     std::cout << "Kx is age dependent per root type\n";
 }
 
 /**
- * Linear interpolation
+ * Constant conductivity (one value), or constant conductivity per type
  */
-double XylemFlux::interp1(double ip, std::vector<double> x, std::vector<double> y) {
-    if (ip > x.back()) return y.back(); // check bounds
-    if (ip < x[0]) return y[0];
+void ConductivityModel::setValues(const std::vector<double>& values) {
+    perType = values.size()>1;
+    start = { 0 };
+    x.clear();
+    y.clear();
+    invDx.clear();
+    for (double v : values) {
+        addTable({ v }, { 0. });
+    }
+    maxAge_ = -std::numeric_limits<double>::infinity();
+}
+
+/**
+ * Age dependent conductivity, the same for all types
+ */
+void ConductivityModel::setTable(const std::vector<double>& values, const std::vector<double>& age) {
+    setTables({ values }, { age });
+    perType = false;
+}
+
+/**
+ * Age dependent conductivity per type
+ */
+void ConductivityModel::setTables(const std::vector<std::vector<double>>& values, const std::vector<std::vector<double>>& age) {
+    if (values.size()!=age.size()) {
+        throw std::invalid_argument("ConductivityModel::setTables: number of value and age tables disagree");
+    }
+    perType = true;
+    start = { 0 };
+    x.clear();
+    y.clear();
+    invDx.clear();
+    maxAge_ = -std::numeric_limits<double>::infinity();
+    for (int t = 0; t<values.size(); t++) {
+        addTable(values[t], age[t]);
+        maxAge_ = std::max(maxAge_, age[t].back());
+    }
+}
 
-    // if we are within bounds find the index of the lower bound
-    const auto lookUpIndex = std::distance(x.begin(), std::lower_bound(x.begin(), x.end(), ip));
-    if (lookUpIndex == 0) {
-        return y[0];
+/**
+ * Appends a table, and checks if its ages are equidistant
+ */
+void ConductivityModel::addTable(const std::vector<double>& values, const std::vector<double>& age) {
+    if ((values.size()!=age.size()) || (values.size()==0)) {
+        throw std::invalid_argument("ConductivityModel::addTable: table sizes disagree or are empty");
+    }
+    x.insert(x.end(), age.begin(), age.end());
+    y.insert(y.end(), values.begin(), values.end());
+    start.push_back(x.size());
+    double idx = 0.;
+    int n = age.size();
+    if (n>1) {
+        double dx = (age.back()-age[0])/(n-1);
+        bool equidistant = dx>0;
+        for (int i = 1; i<n; i++) {
+            equidistant = equidistant && (std::abs(age[i]-age[0]-i*dx) <= 1.e-12*(age.back()-age[0]));
+        }
+        if (equidistant) {
+            idx = 1./dx;
+        }
+    }
+    invDx.push_back(idx);
+}
+
+/**
+ * Evaluates the conductivities of a batch of segments
+ *
+ * @param ages      segment ages [day]
+ * @param types     segment types
+ * @param n         number of segments
+ * @param out       conductivities (n values)
+ */
+void ConductivityModel::evaluate(const double* ages, const int* types, size_t n, double* out) const {
+    if ((start.size()==2) && (start[1]==1)) { // single constant
+        std::fill(out, out+n, y[0]);
+        return;
+    }
+    if (!perType) {
+        for (size_t i = 0; i<n; i++) {
+            out[i] = evaluate(0, ages[i]);
+        }
+    } else {
+        for (size_t i = 0; i<n; i++) {
+            out[i] = evaluate(table(types[i]), ages[i]);
+        }
     }
-    double ip_ = (ip - x[lookUpIndex-1])/(x[lookUpIndex] - x[lookUpIndex-1]);
-    return y[lookUpIndex-1]*(1.0 - ip_)  + y[lookUpIndex]*ip_;
 }
 
 /**
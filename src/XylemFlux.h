@@ -4,8 +4,75 @@
 
 #include "MappedOrganism.h"
 
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+
 namespace CPlantBox {
 
+/**
+ * Age and type dependent conductivity, as piecewise linear tables stored in flat contiguous arrays.
+ *
+ * A table with a single value is constant, tables with equidistant ages are evaluated without search.
+ * Ages outside of the table range are clamped to the first or last value.
+ */
+class ConductivityModel
+{
+public:
+
+    void setValues(const std::vector<double>& values); ///< constant (one value), or constant per type
+    void setTable(const std::vector<double>& values, const std::vector<double>& age); ///< one table for all types
+    void setTables(const std::vector<std::vector<double>>& values, const std::vector<std::vector<double>>& age); ///< one table per type
+
+    double operator()(double age, int type) const { return evaluate(table(type), age); } ///< conductivity at age [day] and type
+    void evaluate(const double* ages, const int* types, size_t n, double* out) const; ///< conductivities of n segments
+
+    double maxAge() const { return maxAge_; } ///< conductivities do not change for larger ages
+
+protected:
+
+    int table(int type) const {
+        if (!perType) {
+            return 0;
+        }
+        if ((type<0) || (type>=int(start.size())-1)) {
+            throw std::invalid_argument("ConductivityModel: no conductivity defined for type "+std::to_string(type));
+        }
+        return type;
+    } ///< table index of a type
+
+    double evaluate(int t, double age) const {
+        int i0 = start[t];
+        int n = start[t+1] - i0;
+        const double* x_ = &x[i0];
+        const double* y_ = &y[i0];
+        if ((n==1) || (age<=x_[0])) {
+            return y_[0];
+        }
+        if (age>=x_[n-1]) {
+            return y_[n-1];
+        }
+        int i;
+        if (invDx[t]>0) { // equidistant
+            i = std::min(int((age - x_[0])*invDx[t]), n-2);
+        } else {
+            i = std::upper_bound(x_, x_+n, age) - x_ - 1;
+        }
+        double ip = (age - x_[i])/(x_[i+1] - x_[i]);
+        return y_[i]*(1.-ip) + y_[i+1]*ip;
+    } ///< linear interpolation in table t
+
+    void addTable(const std::vector<double>& values, const std::vector<double>& age);
+
+    bool perType = false;
+    std::vector<int> start = { 0, 1 }; // table t is [start[t], start[t+1])
+    std::vector<double> x = { 0. }; // ages [day]
+    std::vector<double> y = { 0. }; // values
+    std::vector<double> invDx = { 0. }; // 1/dx for equidistant tables, 0 otherwise
+    double maxAge_ = -std::numeric_limits<double>::infinity();
+
+};
+
 /**
  * Hybrid solver (Meunier et al. 2017)
  *
@@ -17,12 +84,16 @@ class XylemFlux
 {
 public:
 
-    XylemFlux(std::shared_ptr<CPlantBox::MappedSegments> rs) :rs(rs) { }
+    enum BCTypes { bct_neumann = 0, bct_dirichlet = 1 }; ///< boundary condition types at the root collar (node 0)
+
+    XylemFlux(std::shared_ptr<CPlantBox::MappedSegments> rs) :rs(rs) { kxModel.setValues({ 1. }); }
 
     virtual ~XylemFlux() { }
 
     void linearSystem(double simTime, const std::vector<double>& sx, bool cells = true,
         const std::vector<double> soil_k = std::vector<double>()); ///< builds linear system (simTime is needed for age dependent conductivities)
+    std::vector<double> solve(double simTime, const std::vector<double>& sx, bool cells, int bcType, double bcValue,
+        const std::vector<double> soil_k = std::vector<double>()); ///< builds and solves the linear system, returns root xylem matric potential [cm]
 
     std::map<int,double> soilFluxes(double simTime, const std::vector<double>& rx, const std::vector<double>& sx, bool approx = false); // [cm3/day]
     std::vector<double> segFluxes(double simTime, const std::vector<double>& rx, const std::vector<double>& sx, bool approx = false, bool cells = false); // for each segment in [cm3/day]
@@ -41,13 +112,18 @@ public:
     std::vector<double> aV;
     std::vector<double> aB;
 
+    bool incremental = false; ///< reuses the matrix structure and the coefficients of unchanged segments between calls (linearSystem, solve)
+
     void setKr(std::vector<double> values, std::vector<double> age); ///< sets a callback for kr:=kr(age,type),  [1 day-1]
     void setKx(std::vector<double> values, std::vector<double> age); ///< sets a callback for kx:=kx(age,type),  [cm3 day-1]
     void setKrTables(std::vector<std::vector<double>> values, std::vector<std::vector<double>> age);
     void setKxTables(std::vector<std::vector<double>> values, std::vector<std::vector<double>> age);
 
-    std::function<double(double,int)> kr_f = [](double age, int type) { return 0.; };
-    std::function<double(double,int)> kx_f = [](double age, int type) { return 1.; };
+    ConductivityModel krModel; ///< radial conductivity, evaluated per sweep in the flux kernels
+    ConductivityModel kxModel; ///< axial conductivity, evaluated per sweep in the flux kernels
+
+    double kr_f(double age, int type) const { return krModel(age, type); } ///< kr(age,type), for single evaluations (Python)
+    double kx_f(double age, int type) const { return kxModel(age, type); } ///< kx(age,type), for single evaluations (Python)
 
     std::shared_ptr<CPlantBox::MappedSegments> rs;
 
@@ -58,17 +134,20 @@ public:
 
 protected:
 
-    double kr_const(double age, int type) { return kr[0]; }
-    double kr_perType(double age, int type) { return kr.at(type); }
-    double kr_table(double age, int type) { return interp1(age, kr_t, kr); }
-    double kr_tablePerType(double age, int type) { return interp1(age, krs_t.at(type), krs.at(type)); }
+    void updateCoefficients(double simTime, const std::vector<double>& sx, bool cells, const std::vector<double>& soil_k); ///< fills segCii, segCij, segBi, and segPsi, invalidates the structure if needed
+    void segmentCoefficients(int si, double kr, double kx, const std::vector<double>& soil_k, double& cii, double& cij, double& bi); ///< matrix entries of segment si, Eqns (16-18)
+    void conductivities(double simTime, const std::vector<int>& segIdx, std::vector<double>& kr, std::vector<double>& kx) const; ///< kr and kx of the segments segIdx
+    void updateTree(); ///< elimination order of the tree solver
+    void resetCache() { cSegs.clear(); } ///< all coefficients are recomputed in the next call
 
-    double kx_const(double age, int type) { return kx[0]; }
-    double kx_perType(double age, int type) { return kx.at(type); }
-    double kx_table(double age, int type) { return interp1(age, kx_t, kx); }
-    double kx_tablePerType(double age, int type) { return interp1(age, kxs_t.at(type), kxs.at(type)); }
+    std::vector<double> segCii, segCij, segBi, segPsi; // per segment matrix entries and soil matric potential
+    std::vector<int> treeOrder, treeParent, treeParentSeg; // nodes ordered from the collar to the tips, their parent node and segment
 
-    static double interp1(double ip, std::vector<double> x, std::vector<double> y);
+    std::vector<Vector2i> cSegs; // segment state, when its coefficients were last computed (incremental mode)
+    std::vector<Vector3d> cN1, cN2;
+    std::vector<double> cRadii, cSoilK;
+    std::vector<int> cTypes;
+    std::vector<bool> cMature;
 
     static double schroederStress(double r, double p, double q_out, double r_in, double r_out, std::function<double(double)> mfp, std::function<double(double)> imfp);
 
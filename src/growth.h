@@ -2,6 +2,8 @@
 #define GROWTH_H
 
 #include <memory>
+#include <cmath>
+#include <typeinfo>
 
 namespace CPlantBox {
 
@@ -86,6 +88,72 @@ public:
 
 };
 
+
+
+/**
+ * A growth function together with the parameters r and k of a specific organ.
+ *
+ * LinearGrowth and ExponentialGrowth are resolved when the object is created, and evaluated inline (without virtual calls),
+ * with the same results. Other growth functions (type gt_generic) must be evaluated by the organ, calling f->getLength(), and f->getAge()
+ */
+class OrganGrowth
+{
+public:
+
+    enum GrowthTypes { gt_generic = 0, gt_linear = 1, gt_negexp = 2 };
+
+    OrganGrowth() { }
+
+    OrganGrowth(std::shared_ptr<GrowthFunction> f, double r, double k) :f(f), r(r), k(k), rk(r/k), kr(-k/r) {
+        if (f && (typeid(*f)==typeid(LinearGrowth))) {
+            type = gt_linear;
+        } else if (f && (typeid(*f)==typeid(ExponentialGrowth))) {
+            type = gt_negexp;
+        }
+    } ///< resolves the growth function type
+
+    double getLength(double t) const {
+        if (type==gt_linear) {
+            return std::min(k,r*t);
+        } else {
+            return k*(1-exp(-rk*t));
+        }
+    } ///< organ length at age t, @see GrowthFunction::getLength (not for gt_generic)
+
+    double getAge(double l) const {
+        if (type==gt_linear) {
+            return l/r;
+        } else {
+            double age = kr*log(1-l/k);
+            return std::isfinite(age) ? age : 1.e9;
+        }
+    } ///< organ age at length l, @see GrowthFunction::getAge (not for gt_generic)
+
+    void getAges(const double* l, size_t n, double* a) const {
+        if (type==gt_linear) {
+            for (size_t i=0; i<n; i++) {
+                a[i] = l[i]/r;
+            }
+        } else {
+            for (size_t i=0; i<n; i++) {
+                double age = kr*log(1-l[i]/k);
+                a[i] = std::isfinite(age) ? age : 1.e9;
+            }
+        }
+    } ///< organ ages at n lengths (not for gt_generic)
+
+    int type = gt_generic; ///< resolved type of the growth function
+    std::shared_ptr<GrowthFunction> f; ///< the growth function
+    double r = 0.; ///< initial growth rate [cm/day]
+    double k = 0.; ///< maximal organ length [cm]
+
+private:
+
+    double rk = 0.; ///< r/k
+    double kr = 0.; ///< -k/r
+
+};
+
 } // end namespace CPlantBox
 
 #endif
@@ -2,6 +2,7 @@
 #include "leafparameter.h"
 
 #include "Organism.h"
+#include "Checkpoint.h"
 
 #include <cmath>
 #include <iostream>
@@ -36,6 +37,30 @@ std::string LeafSpecificParameter::toString() const
 	return str.str();
 }
 
+/**
+ * @copydoc OrganSpecificParameter::writeCheckpoint()
+ */
+void LeafSpecificParameter::writeCheckpoint(std::ostream& os) const
+{
+	OrganSpecificParameter::writeCheckpoint(os);
+	for (double v : { lb, la, r, theta, rlt }) {
+		Checkpoint::write(os, v);
+	}
+	Checkpoint::write(os, ln);
+}
+
+/**
+ * @copydoc OrganSpecificParameter::readCheckpoint()
+ */
+void LeafSpecificParameter::readCheckpoint(std::istream& is)
+{
+	OrganSpecificParameter::readCheckpoint(is);
+	for (double* v : { &lb, &la, &r, &theta, &rlt }) {
+		Checkpoint::read(is, *v);
+	}
+	Checkpoint::read(is, ln);
+}
+
 
 
 /**
@@ -268,6 +293,28 @@ tinyxml2::XMLElement* LeafRandomParameter::writeXML(tinyxml2::XMLDocument& doc,
 	return element;
 }
 
+/**
+ * @copydoc OrganRandomParameter::writeCheckpoint()
+ *
+ * We need to add the parameters that are not in the hashmaps (i.e. successor, and successorP)
+ */
+void LeafRandomParameter::writeCheckpoint(std::ostream& os) const
+{
+	OrganRandomParameter::writeCheckpoint(os);
+	Checkpoint::write(os, successor);
+	Checkpoint::write(os, successorP);
+}
+
+/**
+ * @copydoc OrganRandomParameter::readCheckpoint()
+ */
+void LeafRandomParameter::readCheckpoint(std::istream& is)
+{
+	OrganRandomParameter::readCheckpoint(is);
+	Checkpoint::read(is, successor);
+	Checkpoint::read(is, successorP);
+}
+
 /**
  * Sets up class introspection by linking parameter names to their class members,
  * additionally adds a description for each parameter, for toString and writeXML
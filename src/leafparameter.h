@@ -38,6 +38,9 @@ public:
 
 	std::string toString() const override;
 
+	void writeCheckpoint(std::ostream& os) const override; ///< writes the parameters into a binary checkpoint
+	void readCheckpoint(std::istream& is) override; ///< reads the parameters from a binary checkpoint
+
 };
 
 
@@ -64,6 +67,8 @@ public:
 
     void readXML(tinyxml2::XMLElement* element) override; ///< reads a single sub type organ parameter set
     tinyxml2::XMLElement* writeXML(tinyxml2::XMLDocument& doc, bool comments = true) const override; ///< writes a organ leaf parameter set
+	void writeCheckpoint(std::ostream& os) const override; ///< writes the parameter set into a binary checkpoint
+	void readCheckpoint(std::istream& is) override; ///< reads the parameter set from a binary checkpoint
 
 	/*
 	 * Parameters per leaf type
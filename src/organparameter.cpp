@@ -2,6 +2,7 @@
 #include "organparameter.h"
 
 #include "Organism.h"
+#include "Checkpoint.h"
 
 #include <limits>
 #include <iostream>
@@ -19,6 +20,24 @@ std::string OrganSpecificParameter::toString() const
     return str.str();
 }
 
+/**
+ * Writes the parameters into a binary checkpoint (@see Organism::saveCheckpoint)
+ */
+void OrganSpecificParameter::writeCheckpoint(std::ostream& os) const
+{
+    Checkpoint::write(os, subType);
+    Checkpoint::write(os, a);
+}
+
+/**
+ * Reads the parameters from a binary checkpoint (@see Organism::loadCheckpoint)
+ */
+void OrganSpecificParameter::readCheckpoint(std::istream& is)
+{
+    Checkpoint::read(is, subType);
+    Checkpoint::read(is, a);
+}
+
 /**
  * Default constructor using default values for the parameters.
  *
@@ -291,6 +310,63 @@ void OrganRandomParameter::writeXML(std::string name) const
     doc.SaveFile(name.c_str());
 }
 
+/**
+ * Writes the parameter set into a binary checkpoint (@see Organism::saveCheckpoint):
+ * the name, and all parameters and deviations of the class introspection by their names.
+ * Call back functions (e.g. tropisms, soil look ups) are not written.
+ *
+ * Overwrite to add parameters that are not in the hashmaps.
+ */
+void OrganRandomParameter::writeCheckpoint(std::ostream& os) const
+{
+    Checkpoint::write(os, name);
+    Checkpoint::write(os, uint64_t(iparam.size()));
+    for (auto& ip : iparam) {
+        Checkpoint::write(os, ip.first);
+        Checkpoint::write(os, *ip.second);
+    }
+    Checkpoint::write(os, uint64_t(dparam.size()));
+    for (auto& dp : dparam) {
+        Checkpoint::write(os, dp.first);
+        Checkpoint::write(os, *dp.second);
+    }
+    Checkpoint::write(os, uint64_t(param_sd.size()));
+    for (auto& sd : param_sd) {
+        Checkpoint::write(os, sd.first);
+        Checkpoint::write(os, *sd.second);
+    }
+}
+
+/**
+ * Reads the parameter set from a binary checkpoint (@see Organism::loadCheckpoint)
+ */
+void OrganRandomParameter::readCheckpoint(std::istream& is)
+{
+    Checkpoint::read(is, name);
+    uint64_t n;
+    std::string key;
+    Checkpoint::read(is, n);
+    for (uint64_t i=0; i<n; i++) {
+        int v;
+        Checkpoint::read(is, key);
+        Checkpoint::read(is, v);
+        if (iparam.count(key)) {
+            *iparam.at(key) = v;
+        }
+    }
+    for (auto m : { &dparam, &param_sd }) {
+        Checkpoint::read(is, n);
+        for (uint64_t i=0; i<n; i++) {
+            double v;
+            Checkpoint::read(is, key);
+            Checkpoint::read(is, v);
+            if (m->count(key)) {
+                *m->at(key) = v;
+            }
+        }
+    }
+}
+
 /**
  * Sets up class introspection by linking parameter names to their class members,
  * additionally adds a description for each parameter, for toString and writeXML
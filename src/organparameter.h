@@ -33,6 +33,9 @@ public:
 
     virtual std::string toString() const; ///< quick info for debugging
 
+    virtual void writeCheckpoint(std::ostream& os) const; ///< writes the parameters into a binary checkpoint
+    virtual void readCheckpoint(std::istream& is); ///< reads the parameters from a binary checkpoint
+
 };
 
 /**
@@ -65,6 +68,9 @@ public:
     virtual tinyxml2::XMLElement* writeXML(tinyxml2::XMLDocument& doc, bool comments = true) const; ///< writes a organ root parameter set
     void writeXML(std::string name) const; ///< writes a organ root parameter set
 
+    virtual void writeCheckpoint(std::ostream& os) const; ///< writes the parameter set into a binary checkpoint
+    virtual void readCheckpoint(std::istream& is); ///< reads the parameter set from a binary checkpoint
+
     virtual void bindParameters(); ///<sets up class introspection
 
     void bindParameter(std::string name, int* i, std::string descr = "", double* dev = nullptr); ///< binds integer to parameter name
@@ -2,6 +2,7 @@
 #include "rootparameter.h"
 
 #include "Organism.h"
+#include "Checkpoint.h"
 
 #include <cmath>
 #include <iostream>
@@ -36,6 +37,30 @@ std::string RootSpecificParameter::toString() const
     return str.str();
 }
 
+/**
+ * @copydoc OrganSpecificParameter::writeCheckpoint()
+ */
+void RootSpecificParameter::writeCheckpoint(std::ostream& os) const
+{
+    OrganSpecificParameter::writeCheckpoint(os);
+    for (double v : { lb, la, r, theta, rlt }) {
+        Checkpoint::write(os, v);
+    }
+    Checkpoint::write(os, ln);
+}
+
+/**
+ * @copydoc OrganSpecificParameter::readCheckpoint()
+ */
+void RootSpecificParameter::readCheckpoint(std::istream& is)
+{
+    OrganSpecificParameter::readCheckpoint(is);
+    for (double* v : { &lb, &la, &r, &theta, &rlt }) {
+        Checkpoint::read(is, *v);
+    }
+    Checkpoint::read(is, ln);
+}
+
 /**
  * Default constructor sets up hashmaps for class introspection
  */
@@ -246,6 +271,28 @@ tinyxml2::XMLElement* RootRandomParameter::writeXML(tinyxml2::XMLDocument& doc,
     return element;
 }
 
+/**
+ * @copydoc OrganRandomParameter::writeCheckpoint()
+ *
+ * We need to add the parameters that are not in the hashmaps (i.e. successor, and successorP)
+ */
+void RootRandomParameter::writeCheckpoint(std::ostream& os) const
+{
+    OrganRandomParameter::writeCheckpoint(os);
+    Checkpoint::write(os, successor);
+    Checkpoint::write(os, successorP);
+}
+
+/**
+ * @copydoc OrganRandomParameter::readCheckpoint()
+ */
+void RootRandomParameter::readCheckpoint(std::istream& is)
+{
+    OrganRandomParameter::readCheckpoint(is);
+    Checkpoint::read(is, successor);
+    Checkpoint::read(is, successorP);
+}
+
 /**
  * CPlantBox parameter reader (DEPRICATED)
  */
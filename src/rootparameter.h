@@ -44,6 +44,9 @@ public:
 
     std::string toString() const override; ///< for debugging
 
+    void writeCheckpoint(std::ostream& os) const override; ///< writes the parameters into a binary checkpoint
+    void readCheckpoint(std::istream& is) override; ///< reads the parameters from a binary checkpoint
+
 };
 
 
@@ -71,6 +74,8 @@ public:
 
     void readXML(tinyxml2::XMLElement* element) override; ///< reads a single sub type organ parameter set
     tinyxml2::XMLElement* writeXML(tinyxml2::XMLDocument& doc, bool comments = true) const override; ///< writes a organ root parameter set RootSpecificParameter::nob()
+    void writeCheckpoint(std::ostream& os) const override; ///< writes the parameter set into a binary checkpoint
+    void readCheckpoint(std::istream& is) override; ///< reads the parameter set from a binary checkpoint
 
     // DEPRICATED
     void read(std::istream & cin); ///< reads a single root parameter set
@@ -1,6 +1,10 @@
 // -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
 #include "sdf.h"
 
+#include <array>
+#include <vector>
+#include <cmath>
+
 namespace CPlantBox {
 
 std::string SignedDistanceFunction::writePVPScript() const
@@ -10,6 +14,20 @@ std::string SignedDistanceFunction::writePVPScript() const
     return str.str();
 }
 
+/**
+ * Signed distances of a batch of points, calls getDist for each point
+ *
+ * @param xyz   coordinates x[0,n), y[0,n), z[0,n) [cm]
+ * @param n     number of points
+ * @param out   signed distances [cm] (on output)
+ */
+void SignedDistanceFunction::getDists(const double* xyz, size_t n, double* out) const
+{
+    for (size_t i=0; i<n; i++) {
+        out[i] = getDist(Vector3d(xyz[i], xyz[n+i], xyz[2*n+i]));
+    }
+}
+
 
 
 /**
@@ -24,6 +42,30 @@ double SDF_PlantBox::getDist(const Vector3d& v) const
     return -std::min(std::min(std::min(std::min(std::min(dim.z+z,dim.z-z),dim.y+v.y),dim.y-v.y),dim.x+v.x),dim.x-v.x);
 }
 
+/**
+ * @see SDF_PlantBox::getDist, for a batch of points
+ */
+void SDF_PlantBox::getDists(const double* xyz, size_t n, double* out) const
+{
+    const double* x = xyz;
+    const double* y = xyz + n;
+    const double* zz = xyz + 2*n;
+    const double dx = dim.x, dy = dim.y, dz = dim.z;
+    for (size_t i=0; i<n; i++) {
+        double z = zz[i]+dz;
+        out[i] = -std::min(std::min(std::min(std::min(std::min(dz+z,dz-z),dy+y[i]),dy-y[i]),dx+x[i]),dx-x[i]);
+    }
+}
+
+/**
+ * The box [-dim.x, -dim.y, -2*dim.z] - [dim.x, dim.y, 0] (bounding box and inner box)
+ */
+void SDF_PlantBox::getBoundingBox(Vector3d& min, Vector3d& max) const
+{
+    min = Vector3d(-dim.x, -dim.y, -2.*dim.z);
+    max = Vector3d(dim.x, dim.y, 0.);
+}
+
 /**
  * Writes a ParaView Phython script explicitly representing the implicit geometry
  *
@@ -62,6 +104,23 @@ double SDF_Cuboid::getDist(const Vector3d& v) const
     return -d;
 }
 
+/**
+ * @see SDF_Cuboid::getDist, for a batch of points
+ */
+void SDF_Cuboid::getDists(const double* xyz, size_t n, double* out) const
+{
+    const double* x = xyz;
+    const double* y = xyz + n;
+    const double* z = xyz + 2*n;
+    const Vector3d a = min, b = max;
+    for (size_t i=0; i<n; i++) {
+        double d =   std::min(   -a.z+z[i],  b.z-z[i]);
+        d = std::min(std::min(d, -a.y+y[i]), b.y-y[i]);
+        d = std::min(std::min(d, -a.x+x[i]), b.x-x[i]);
+        out[i] = -d;
+    }
+}
+
 
 
 /**
@@ -94,6 +153,55 @@ double SDF_PlantContainer::getDist(const Vector3d& v) const
     return std::max(d,-std::min(h+v.z,0.-v.z));
 }
 
+/**
+ * @see SDF_PlantContainer::getDist, for a batch of points
+ */
+void SDF_PlantContainer::getDists(const double* xyz, size_t n, double* out) const
+{
+    const double* x = xyz;
+    const double* y = xyz + n;
+    const double* vz = xyz + 2*n;
+    const double r1_ = r1, r2_ = r2, h_ = h;
+    if (square) { // rectangular pot
+        for (size_t i=0; i<n; i++) {
+            double z = vz[i]/h_; // 0 .. -1
+            double r =  (1+z)*r1_ - z*r2_;
+            double d = std::max(std::abs(x[i]),std::abs(y[i]))-r;
+            out[i] = std::max(d,-std::min(h_+vz[i],0.-vz[i]));
+        }
+    } else { // round pot
+        for (size_t i=0; i<n; i++) {
+            double z = vz[i]/h_;
+            double r =  (1+z)*r1_ - z*r2_;
+            double d = std::sqrt(x[i]*x[i]+y[i]*y[i])-r;
+            out[i] = std::max(d,-std::min(h_+vz[i],0.-vz[i]));
+        }
+    }
+}
+
+/**
+ * Bounding box of the container, using the larger radius
+ */
+void SDF_PlantContainer::getBoundingBox(Vector3d& min, Vector3d& max) const
+{
+    double r = std::max(r1, r2);
+    min = Vector3d(-r, -r, -h);
+    max = Vector3d(r, r, 0.);
+}
+
+/**
+ * Box within the container, using the smaller radius (for round pots the inscribed square)
+ */
+void SDF_PlantContainer::getInnerBox(Vector3d& min, Vector3d& max) const
+{
+    double r = std::min(r1, r2);
+    if (!square) {
+        r /= std::sqrt(2.);
+    }
+    min = Vector3d(-r, -r, -h);
+    max = Vector3d(r, r, 0.);
+}
+
 /**
  * Writes a ParaView Phython script explicitly representing the implicit geometry
  *
@@ -179,6 +287,88 @@ double SDF_RotateTranslate::getDist(const Vector3d& v) const
     return sdf->getDist(p);
 }
 
+/**
+ * Rotates and translates the batch of points, and passes it to the base geometry
+ */
+void SDF_RotateTranslate::getDists(const double* xyz, size_t n, double* out) const
+{
+    std::vector<double> p(3*n);
+    const double* x = xyz;
+    const double* y = xyz + n;
+    const double* z = xyz + 2*n;
+    const Vector3d r0 = A.r0, r1 = A.r1, r2 = A.r2;
+    for (size_t i=0; i<n; i++) { // same operations as Vector3d::minus and Matrix3d::times
+        double wx = x[i]-pos.x, wy = y[i]-pos.y, wz = z[i]-pos.z;
+        p[i] = r0.x*wx + r0.y*wy + r0.z*wz;
+        p[n+i] = r1.x*wx + r1.y*wy + r1.z*wz;
+        p[2*n+i] = r2.x*wx + r2.y*wy + r2.z*wz;
+    }
+    sdf->getDists(p.data(), n, out);
+}
+
+/**
+ * Bounding box of the rotated and translated bounding box of the base geometry (interval arithmetic)
+ */
+void SDF_RotateTranslate::getBoundingBox(Vector3d& min, Vector3d& max) const
+{
+    Vector3d bmin, bmax;
+    sdf->getBoundingBox(bmin, bmax);
+    transformBox(bmin, bmax, false, min, max);
+}
+
+/**
+ * Rotated and translated inner box of the base geometry, if the rotation maps axes onto axes (e.g. multiples of 90 degrees),
+ * otherwise empty
+ */
+void SDF_RotateTranslate::getInnerBox(Vector3d& min, Vector3d& max) const
+{
+    Vector3d bmin, bmax;
+    sdf->getInnerBox(bmin, bmax);
+    bool empty = (bmin.x>bmax.x) || (bmin.y>bmax.y) || (bmin.z>bmax.z);
+    for (const auto& r : { A.r0, A.r1, A.r2 }) {
+        for (double a : { r.x, r.y, r.z }) {
+            empty = empty || ((std::abs(a)>1.e-12) && (std::abs(std::abs(a)-1.)>1.e-12));
+        }
+    }
+    if (empty) {
+        SignedDistanceFunction::getInnerBox(min, max);
+    } else {
+        transformBox(bmin, bmax, true, min, max);
+    }
+}
+
+/**
+ * Axis aligned box containing the box [bmin, bmax] of the base geometry after rotation and translation, i.e. v = pos + A^T p.
+ *
+ * Matrix entries below 1e-12 are treated as zero (e.g. cos(pi/2)), to keep boxes of half planes bounded.
+ *
+ * @param bmin          minimal corner of the box of the base geometry
+ * @param bmax          maximal corner of the box of the base geometry
+ * @param permutation   use only the signs of the matrix entries (if A is a signed permutation up to rounding)
+ * @param min           minimal corner of the resulting box (on output)
+ * @param max           maximal corner of the resulting box (on output)
+ */
+void SDF_RotateTranslate::transformBox(const Vector3d& bmin, const Vector3d& bmax, bool permutation, Vector3d& min, Vector3d& max) const
+{
+    std::array<double,3> pmin = { bmin.x, bmin.y, bmin.z };
+    std::array<double,3> pmax = { bmax.x, bmax.y, bmax.z };
+    std::array<Vector3d,3> rows = { A.r0, A.r1, A.r2 };
+    std::array<double,3> vmin = { pos.x, pos.y, pos.z };
+    std::array<double,3> vmax = vmin;
+    for (int j=0; j<3; j++) {
+        std::array<double,3> a = { rows[j].x, rows[j].y, rows[j].z }; // column j of A^T
+        for (int i=0; i<3; i++) {
+            if (std::abs(a[i])>1.e-12) {
+                double ai = permutation ? (a[i]>0 ? 1. : -1.) : a[i];
+                vmin[i] += std::min(ai*pmin[j], ai*pmax[j]);
+                vmax[i] += std::max(ai*pmin[j], ai*pmax[j]);
+            }
+        }
+    }
+    min = Vector3d(vmin[0], vmin[1], vmin[2]);
+    max = Vector3d(vmax[0], vmax[1], vmax[2]);
+}
+
 /**
  * Writes a ParaView Phython script explicitly representing the implicit geometry
  *
@@ -230,6 +420,49 @@ double SDF_Intersection::getDist(const Vector3d& v) const {
     return d;
 }
 
+/**
+ * @see SDF_Intersection::getDist, for a batch of points (evaluated geometry by geometry)
+ */
+void SDF_Intersection::getDists(const double* xyz, size_t n, double* out) const
+{
+    sdfs[0]->getDists(xyz, n, out);
+    std::vector<double> d(n);
+    for (size_t j=1; j<sdfs.size(); j++) {
+        sdfs[j]->getDists(xyz, n, d.data());
+        for (size_t i=0; i<n; i++) {
+            out[i] = std::max(out[i], d[i]);
+        }
+    }
+}
+
+/**
+ * Intersection of the bounding boxes of the original geometries
+ */
+void SDF_Intersection::getBoundingBox(Vector3d& min, Vector3d& max) const
+{
+    sdfs[0]->getBoundingBox(min, max);
+    for (size_t i=1; i<sdfs.size(); i++) {
+        Vector3d bmin, bmax;
+        sdfs[i]->getBoundingBox(bmin, bmax);
+        min = Vector3d(std::max(min.x, bmin.x), std::max(min.y, bmin.y), std::max(min.z, bmin.z));
+        max = Vector3d(std::min(max.x, bmax.x), std::min(max.y, bmax.y), std::min(max.z, bmax.z));
+    }
+}
+
+/**
+ * Intersection of the inner boxes of the original geometries
+ */
+void SDF_Intersection::getInnerBox(Vector3d& min, Vector3d& max) const
+{
+    sdfs[0]->getInnerBox(min, max);
+    for (size_t i=1; i<sdfs.size(); i++) {
+        Vector3d bmin, bmax;
+        sdfs[i]->getInnerBox(bmin, bmax);
+        min = Vector3d(std::max(min.x, bmin.x), std::max(min.y, bmin.y), std::max(min.z, bmin.z));
+        max = Vector3d(std::min(max.x, bmax.x), std::min(max.y, bmax.y), std::min(max.z, bmax.z));
+    }
+}
+
 /**
  * Writes a ParaView Phython script explicitly representing the implicit geometry
  *
@@ -289,6 +522,56 @@ double SDF_Union::getDist(const Vector3d& v) const
     return d;
 }
 
+/**
+ * @see SDF_Union::getDist, for a batch of points (evaluated geometry by geometry)
+ */
+void SDF_Union::getDists(const double* xyz, size_t n, double* out) const
+{
+    sdfs[0]->getDists(xyz, n, out);
+    std::vector<double> d(n);
+    for (size_t j=1; j<sdfs.size(); j++) {
+        sdfs[j]->getDists(xyz, n, d.data());
+        for (size_t i=0; i<n; i++) {
+            out[i] = std::min(out[i], d[i]);
+        }
+    }
+}
+
+/**
+ * Bounding box of the bounding boxes of the original geometries
+ */
+void SDF_Union::getBoundingBox(Vector3d& min, Vector3d& max) const
+{
+    sdfs[0]->getBoundingBox(min, max);
+    for (size_t i=1; i<sdfs.size(); i++) {
+        Vector3d bmin, bmax;
+        sdfs[i]->getBoundingBox(bmin, bmax);
+        min = Vector3d(std::min(min.x, bmin.x), std::min(min.y, bmin.y), std::min(min.z, bmin.z));
+        max = Vector3d(std::max(max.x, bmax.x), std::max(max.y, bmax.y), std::max(max.z, bmax.z));
+    }
+}
+
+/**
+ * The largest inner box of the original geometries (by volume)
+ */
+void SDF_Union::getInnerBox(Vector3d& min, Vector3d& max) const
+{
+    SignedDistanceFunction::getInnerBox(min, max);
+    double vol = -1.;
+    for (const auto& sdf : sdfs) {
+        Vector3d bmin, bmax;
+        sdf->getInnerBox(bmin, bmax);
+        if ((bmin.x<=bmax.x) && (bmin.y<=bmax.y) && (bmin.z<=bmax.z)) {
+            double v = (bmax.x-bmin.x)*(bmax.y-bmin.y)*(bmax.z-bmin.z);
+            if (v>vol) {
+                vol = v;
+                min = bmin;
+                max = bmax;
+            }
+        }
+    }
+}
+
 
 
 /**
@@ -306,6 +589,34 @@ double SDF_Difference::getDist(const Vector3d& v) const
     return d;
 }
 
+/**
+ * @see SDF_Difference::getDist, for a batch of points (evaluated geometry by geometry)
+ */
+void SDF_Difference::getDists(const double* xyz, size_t n, double* out) const
+{
+    sdfs[0]->getDists(xyz, n, out);
+    std::vector<double> d(n);
+    for (size_t j=1; j<sdfs.size(); j++) {
+        sdfs[j]->getDists(xyz, n, d.data());
+        for (size_t i=0; i<n; i++) {
+            out[i] = std::max(out[i], -d[i]);
+        }
+    }
+}
+
+
+
+/**
+ * @see SDF_Complement::getDist, for a batch of points
+ */
+void SDF_Complement::getDists(const double* xyz, size_t n, double* out) const
+{
+    sdf->getDists(xyz, n, out);
+    for (size_t i=0; i<n; i++) {
+        out[i] = -out[i];
+    }
+}
+
 
 
 /**
@@ -331,6 +642,49 @@ SDF_HalfPlane::SDF_HalfPlane(const Vector3d& o, const Vector3d& p1, const Vector
     //	std::cout << "SDF_HalfPlane normal:"<< n.toString() << "\n" ;
 };
 
+/**
+ * @see SDF_HalfPlane::getDist, for a batch of points
+ */
+void SDF_HalfPlane::getDists(const double* xyz, size_t n_, double* out) const
+{
+    const double* x = xyz;
+    const double* y = xyz + n_;
+    const double* z = xyz + 2*n_;
+    const Vector3d a = n, b = o;
+    for (size_t i=0; i<n_; i++) { // same operations as Vector3d::minus and Vector3d::times
+        out[i] = a.x*(x[i]-b.x) + a.y*(y[i]-b.y) + a.z*(z[i]-b.z);
+    }
+}
+
+/**
+ * The half space n*(v-o)<=0 is bounded in one direction, if the normal is axis aligned, otherwise unbounded
+ * (bounding box and inner box)
+ */
+void SDF_HalfPlane::getBoundingBox(Vector3d& min, Vector3d& max) const
+{
+    SignedDistanceFunction::getBoundingBox(min, max);
+    if ((n.y==0) && (n.z==0)) {
+        if (n.x>0) { max.x = o.x; } else if (n.x<0) { min.x = o.x; }
+    } else if ((n.x==0) && (n.z==0)) {
+        if (n.y>0) { max.y = o.y; } else if (n.y<0) { min.y = o.y; }
+    } else if ((n.x==0) && (n.y==0)) {
+        if (n.z>0) { max.z = o.z; } else if (n.z<0) { min.z = o.z; }
+    }
+}
+
+/**
+ * Same as the bounding box, if the normal is axis aligned, otherwise empty
+ */
+void SDF_HalfPlane::getInnerBox(Vector3d& min, Vector3d& max) const
+{
+    int zeros = (n.x==0) + (n.y==0) + (n.z==0);
+    if (zeros==2) {
+        getBoundingBox(min, max);
+    } else {
+        SignedDistanceFunction::getInnerBox(min, max);
+    }
+}
+
 /**
  * Writes a ParaView Phython script explicitly representing the half plane,
  * the plane is given only by its normal, two orthogonal vectors are randomly chosen
@@ -358,4 +712,67 @@ int SDF_HalfPlane::writePVPScript(std::ostream & cout, int c) const
     return c;
 }
 
+
+
+/**
+ * Constructs the bounds of a geometry
+ *
+ * @param sdf       the geometry
+ */
+SDF_Bounds::SDF_Bounds(const SignedDistanceFunction& sdf)
+{
+    sdf.getBoundingBox(min, max);
+    sdf.getInnerBox(innerMin, innerMax);
+    auto widen = [](double& a, double& b, double s) { // s=1 widens, s=-1 narrows [a,b], infinite bounds are kept (inf-inf is NaN)
+        if (std::isfinite(a)) {
+            a -= s*tol*(1.+std::abs(a));
+        }
+        if (std::isfinite(b)) {
+            b += s*tol*(1.+std::abs(b));
+        }
+    };
+    widen(min.x, max.x, 1.);
+    widen(min.y, max.y, 1.);
+    widen(min.z, max.z, 1.);
+    widen(innerMin.x, innerMax.x, -1.);
+    widen(innerMin.y, innerMax.y, -1.);
+    widen(innerMin.z, innerMax.z, -1.);
+}
+
+/**
+ * Classifies the points by the boxes, and evaluates the signed distance function for the undecided points
+ * as one batch (@see SignedDistanceFunction::getDists)
+ *
+ * @param sdf       the geometry the bounds were created from
+ * @param v         spatial positions [cm]
+ * @param open      tests getDist(v)<0 (true), or getDist(v)<=0 (false)
+ * \return          per point 1 if inside, 0 if outside
+ */
+std::vector<int8_t> SDF_Bounds::isInside(const SignedDistanceFunction& sdf, const std::vector<Vector3d>& v, bool open) const
+{
+    std::vector<int8_t> in(v.size());
+    std::vector<size_t> undecided;
+    for (size_t i=0; i<v.size(); i++) {
+        int c = classify(v[i], open);
+        in[i] = (c<0);
+        if (c==0) {
+            undecided.push_back(i);
+        }
+    }
+    size_t n = undecided.size();
+    std::vector<double> xyz(3*n);
+    std::vector<double> d(n);
+    for (size_t j=0; j<n; j++) {
+        const Vector3d& p = v[undecided[j]];
+        xyz[j] = p.x;
+        xyz[n+j] = p.y;
+        xyz[2*n+j] = p.z;
+    }
+    sdf.getDists(xyz.data(), n, d.data());
+    for (size_t j=0; j<n; j++) {
+        in[undecided[j]] = open ? (d[j]<0) : (d[j]<=0);
+    }
+    return in;
+}
+
 } // end namespace CPlantBox
@@ -8,6 +8,8 @@
 #include <vector>
 #include <stdexcept>
 #include <memory>
+#include <limits>
+#include <cstdint>
 
 namespace CPlantBox {
 
@@ -32,6 +34,43 @@ public:
      */
     virtual double getDist(const Vector3d& v) const { return -1e100; } ///< Returns the signed distance to the next boundary
 
+    /**
+     * Signed distances of a batch of points (the default calls getDist for each point).
+     *
+     * Primitive geometries evaluate the batch in a single loop (which the compiler vectorises),
+     * combinations of geometries pass the batch to their base geometries.
+     *
+     * @param xyz   coordinates in structure of arrays layout, i.e. x[0,n), followed by y[0,n), and z[0,n) [cm]
+     * @param n     number of points
+     * @param out   signed distances [cm] (on output, n values), a minus sign means inside, plus outside
+     */
+    virtual void getDists(const double* xyz, size_t n, double* out) const;
+
+    /**
+     * Conservative axis aligned bounding box, i.e. all points with getDist(v)<=0 lie within the box (default is unbounded)
+     *
+     * @param min   minimal corner [cm] (on output)
+     * @param max   maximal corner [cm] (on output)
+     */
+    virtual void getBoundingBox(Vector3d& min, Vector3d& max) const {
+        double inf = std::numeric_limits<double>::infinity();
+        min = Vector3d(-inf, -inf, -inf);
+        max = Vector3d(inf, inf, inf);
+    } ///< Conservative axis aligned bounding box of the geometry
+
+    /**
+     * Conservative axis aligned inner box, i.e. all points within the box have getDist(v)<=0,
+     * and points of its interior have getDist(v)<0 (default is empty, i.e. min>max)
+     *
+     * @param min   minimal corner [cm] (on output)
+     * @param max   maximal corner [cm] (on output)
+     */
+    virtual void getInnerBox(Vector3d& min, Vector3d& max) const {
+        double inf = std::numeric_limits<double>::infinity();
+        min = Vector3d(inf, inf, inf);
+        max = Vector3d(-inf, -inf, -inf);
+    } ///< Conservative axis aligned box within the geometry
+
     /**
      * Returns a string representation of the object (for debugging)
      */
@@ -85,6 +124,9 @@ public:
     SDF_PlantBox(double x, double y, double z) :dim(x/2.,y/2.,z/2.) { } ///< creates a rectangular box
 
     virtual double getDist(const Vector3d& v) const override; ///< @see SignedDistanceFunction::getDist
+    virtual void getDists(const double* xyz, size_t n, double* out) const override; ///< @see SignedDistanceFunction::getDists
+    virtual void getBoundingBox(Vector3d& min, Vector3d& max) const override; ///< @see SignedDistanceFunction::getBoundingBox
+    virtual void getInnerBox(Vector3d& min, Vector3d& max) const override { getBoundingBox(min, max); } ///< @see SignedDistanceFunction::getInnerBox
 
     virtual std::string toString() const override { return "SDF_PlantBox"; } ///< @see SignedDistanceFunction::toString
 
@@ -106,6 +148,9 @@ public:
     SDF_Cuboid(Vector3d min, Vector3d max) : min(min), max(max) { };
 
     virtual double getDist(const Vector3d& v) const override;  ///< @see SignedDistanceFunction::getDist
+    virtual void getDists(const double* xyz, size_t n, double* out) const override; ///< @see SignedDistanceFunction::getDists
+    virtual void getBoundingBox(Vector3d& min_, Vector3d& max_) const override { min_ = min; max_ = max; } ///< @see SignedDistanceFunction::getBoundingBox
+    virtual void getInnerBox(Vector3d& min_, Vector3d& max_) const override { min_ = min; max_ = max; } ///< @see SignedDistanceFunction::getInnerBox
 
     virtual std::string toString() const override { return "SDF_Cuboid ["+min.toString()+" - "+max.toString()+"]"; } ///< @see SignedDistanceFunction::toString
 
@@ -126,6 +171,9 @@ public:
     SDF_PlantContainer(double r1_, double r2_, double h_, double sq=false); ///< Creates a cylindrical or square container
 
     virtual double getDist(const Vector3d& v) const override; ///< @see SignedDistanceFunction::getDist
+    virtual void getDists(const double* xyz, size_t n, double* out) const override; ///< @see SignedDistanceFunction::getDists
+    virtual void getBoundingBox(Vector3d& min, Vector3d& max) const override; ///< @see SignedDistanceFunction::getBoundingBox
+    virtual void getInnerBox(Vector3d& min, Vector3d& max) const override; ///< @see SignedDistanceFunction::getInnerBox
 
     virtual std::string toString() const override { return "SDF_PlantContainer"; } ///< @see SignedDistanceFunction::toString
 
@@ -153,12 +201,17 @@ public:
     SDF_RotateTranslate(std::shared_ptr<SignedDistanceFunction> sdf, Vector3d pos): SDF_RotateTranslate(sdf, 0., xaxis, pos) { } ///< Translate only
 
     virtual double getDist(const Vector3d& v) const override; ///< @see SignedDistanceFunction::getDist
+    virtual void getDists(const double* xyz, size_t n, double* out) const override; ///< @see SignedDistanceFunction::getDists
+    virtual void getBoundingBox(Vector3d& min, Vector3d& max) const override; ///< @see SignedDistanceFunction::getBoundingBox
+    virtual void getInnerBox(Vector3d& min, Vector3d& max) const override; ///< @see SignedDistanceFunction::getInnerBox
 
     virtual std::string toString() const override { return "SDF_RotateTranslate"; } ///< @see SignedDistanceFunction::toString
 
     virtual int writePVPScript(std::ostream & cout, int c=1)  const override; ///< @see SignedDistanceFunction::writePVPScript
 
 private:
+    void transformBox(const Vector3d& bmin, const Vector3d& bmax, bool permutation, Vector3d& min, Vector3d& max) const; ///< rotated and translated box
+
     std::shared_ptr<SignedDistanceFunction> sdf; // base geometry
     Vector3d pos; // translate origin to this position
     Matrix3d A; // rotation matrix
@@ -181,6 +234,9 @@ public:
     ///< Constructs (sdf1 ∩ sdf2)
 
     virtual double getDist(const Vector3d& v) const override;  ///< @see SignedDistanceFunction::getDist
+    virtual void getDists(const double* xyz, size_t n, double* out) const override; ///< @see SignedDistanceFunction::getDists
+    virtual void getBoundingBox(Vector3d& min, Vector3d& max) const override; ///< @see SignedDistanceFunction::getBoundingBox
+    virtual void getInnerBox(Vector3d& min, Vector3d& max) const override; ///< @see SignedDistanceFunction::getInnerBox
 
     virtual std::string toString() const override { return "SDF_Intersection"; } ///< @see SignedDistanceFunction::toString
 
@@ -203,6 +259,9 @@ public:
     SDF_Union(std::shared_ptr<SignedDistanceFunction> sdf1, std::shared_ptr<SignedDistanceFunction> sdf2): SDF_Intersection(sdf1,sdf2) { } ///< Constructs sdf1 U sdf2
 
     virtual double getDist(const Vector3d& v) const override;  ///< @see SignedDistanceFunction::getDist
+    virtual void getDists(const double* xyz, size_t n, double* out) const override; ///< @see SignedDistanceFunction::getDists
+    virtual void getBoundingBox(Vector3d& min, Vector3d& max) const override; ///< @see SignedDistanceFunction::getBoundingBox
+    virtual void getInnerBox(Vector3d& min, Vector3d& max) const override; ///< @see SignedDistanceFunction::getInnerBox
 
     virtual std::string toString() const override { return "SDF_Union"; } ///< @see SignedDistanceFunction::toString
 };
@@ -219,6 +278,9 @@ public:
     SDF_Difference(std::shared_ptr<SignedDistanceFunction> sdf1, std::shared_ptr<SignedDistanceFunction> sdf2) :SDF_Intersection(sdf1,sdf2) { } ///< Constructs sdf1 \ sdf2
 
     virtual double getDist(const Vector3d& v) const override;  ///< @see SignedDistanceFunction::getDist
+    virtual void getDists(const double* xyz, size_t n, double* out) const override; ///< @see SignedDistanceFunction::getDists
+    virtual void getBoundingBox(Vector3d& min, Vector3d& max) const override { sdfs[0]->getBoundingBox(min, max); } ///< @see SignedDistanceFunction::getBoundingBox
+    virtual void getInnerBox(Vector3d& min, Vector3d& max) const override { SignedDistanceFunction::getInnerBox(min, max); } ///< empty, the inner boxes lie in the subtracted regions
 
     virtual std::string toString() const override { return "SDF_Difference"; } ///< @see SignedDistanceFunction::toString
 };
@@ -235,6 +297,7 @@ public:
     SDF_Complement(std::shared_ptr<SignedDistanceFunction> sdf_) { sdf=sdf_; } ///< Constructs the complement (sdf_)^c
 
     virtual double getDist(const Vector3d& v) const override { return -sdf->getDist(v); } ///< @see SignedDistanceFunction::getDist
+    virtual void getDists(const double* xyz, size_t n, double* out) const override; ///< @see SignedDistanceFunction::getDists
 
     virtual int writePVPScript(std::ostream & cout, int c=1) const override { return sdf->writePVPScript(cout,c); } ///< same as original geometry
 
@@ -256,6 +319,9 @@ public:
     SDF_HalfPlane(const Vector3d& o, const Vector3d& p1, const Vector3d& p2);  ///< half plane by origin and two linear independent vectors
 
     virtual double getDist(const Vector3d& v) const override { return n.times(v.minus(o)); } ///< @see SignedDistanceFunction::getDist
+    virtual void getDists(const double* xyz, size_t n, double* out) const override; ///< @see SignedDistanceFunction::getDists
+    virtual void getBoundingBox(Vector3d& min, Vector3d& max) const override; ///< bounded in one direction for axis aligned normals
+    virtual void getInnerBox(Vector3d& min, Vector3d& max) const override; ///< empty for normals that are not axis aligned
 
     virtual int writePVPScript(std::ostream & cout, int c=1) const override; ///< @see SignedDistanceFunction::writePVPScript
 
@@ -268,6 +334,71 @@ public:
 
 };
 
+
+
+/**
+ * SDF_Bounds classifies points by the conservative boxes of a geometry (SignedDistanceFunction::getBoundingBox, and getInnerBox),
+ * so that most points can be accepted or rejected without evaluating the signed distance function.
+ *
+ * The boxes are determined once on construction, later changes of the geometry are not reflected.
+ * They are widened (bounding box), or narrowed (inner box), by SDF_Bounds::tol relative to the coordinates,
+ * to stay conservative under rounding errors of the signed distance functions.
+ */
+class SDF_Bounds
+{
+public:
+
+    SDF_Bounds(): SDF_Bounds(SignedDistanceFunction()) { } ///< decides nothing
+    SDF_Bounds(const SignedDistanceFunction& sdf); ///< boxes of the geometry
+
+    /**
+     * Classifies a point by the boxes
+     *
+     * @param v         spatial position [cm]
+     * @param open      classify for getDist(v)<0 (true), or for getDist(v)<=0 (false)
+     * \return          -1 if the point is inside, 1 if the point is outside, 0 if the signed distance function must decide
+     */
+    int classify(const Vector3d& v, bool open = false) const {
+        if (open) {
+            if ((v.x>innerMin.x) && (v.x<innerMax.x) && (v.y>innerMin.y) && (v.y<innerMax.y) && (v.z>innerMin.z) && (v.z<innerMax.z)) {
+                return -1;
+            }
+            if ((v.x<=min.x) || (v.x>=max.x) || (v.y<=min.y) || (v.y>=max.y) || (v.z<=min.z) || (v.z>=max.z)) {
+                return 1;
+            }
+        } else {
+            if ((v.x>=innerMin.x) && (v.x<=innerMax.x) && (v.y>=innerMin.y) && (v.y<=innerMax.y) && (v.z>=innerMin.z) && (v.z<=innerMax.z)) {
+                return -1;
+            }
+            if ((v.x<min.x) || (v.x>max.x) || (v.y<min.y) || (v.y>max.y) || (v.z<min.z) || (v.z>max.z)) {
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+    bool isInside(const SignedDistanceFunction& sdf, const Vector3d& v) const {
+        int c = classify(v);
+        return (c!=0) ? (c<0) : (sdf.getDist(v)<=0);
+    } ///< same as sdf.getDist(v)<=0, for the geometry the bounds were created from
+
+    bool isInterior(const SignedDistanceFunction& sdf, const Vector3d& v) const {
+        int c = classify(v, true);
+        return (c!=0) ? (c<0) : (sdf.getDist(v)<0);
+    } ///< same as sdf.getDist(v)<0, for the geometry the bounds were created from
+
+    std::vector<int8_t> isInside(const SignedDistanceFunction& sdf, const std::vector<Vector3d>& v, bool open = false) const;
+    ///< same as sdf.getDist(v[i])<=0 (or <0 if open) per point, undecided points are evaluated as one batch
+
+    Vector3d min; ///< minimal corner of the bounding box [cm]
+    Vector3d max; ///< maximal corner of the bounding box [cm]
+    Vector3d innerMin; ///< minimal corner of the inner box [cm]
+    Vector3d innerMax; ///< maximal corner of the inner box [cm]
+
+    static constexpr double tol = 1.e-9; ///< relative safety margin of the boxes
+
+};
+
 } // end namespace CPlantBox
 
 #endif
@@ -2,6 +2,7 @@
 #include "seedparameter.h"
 
 #include "Organism.h"
+#include "Checkpoint.h"
 
 #include <cmath>
 #include <iostream>
@@ -23,6 +24,36 @@ std::string SeedSpecificParameter::toString() const
     return str.str();
 }
 
+/**
+ * @copydoc OrganSpecificParameter::writeCheckpoint()
+ */
+void SeedSpecificParameter::writeCheckpoint(std::ostream& os) const
+{
+    OrganSpecificParameter::writeCheckpoint(os);
+    Checkpoint::write(os, seedPos);
+    for (double v : { firstB, delayB, firstSB, delaySB, delayRC, nz, simtime }) {
+        Checkpoint::write(os, v);
+    }
+    for (int v : { maxB, nC, maxTil }) {
+        Checkpoint::write(os, v);
+    }
+}
+
+/**
+ * @copydoc OrganSpecificParameter::readCheckpoint()
+ */
+void SeedSpecificParameter::readCheckpoint(std::istream& is)
+{
+    OrganSpecificParameter::readCheckpoint(is);
+    Checkpoint::read(is, seedPos);
+    for (double* v : { &firstB, &delayB, &firstSB, &delaySB, &delayRC, &nz, &simtime }) {
+        Checkpoint::read(is, *v);
+    }
+    for (int* v : { &maxB, &nC, &maxTil }) {
+        Checkpoint::read(is, *v);
+    }
+}
+
 
 
 /**
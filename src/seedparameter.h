@@ -51,6 +51,9 @@ public:
     double simtime;     ///< recommended final simulation time
 
     std::string toString() const override; ///< for debugging
+
+    void writeCheckpoint(std::ostream& os) const override; ///< writes the parameters into a binary checkpoint
+    void readCheckpoint(std::istream& is) override; ///< reads the parameters from a binary checkpoint
 };
 
 
@@ -2,6 +2,7 @@
 #include "stemparameter.h"
 
 #include "Organism.h"
+#include "Checkpoint.h"
 
 #include <cmath>
 #include <iostream>
@@ -36,6 +37,30 @@ std::string StemSpecificParameter::toString() const
     return str.str();
 }
 
+/**
+ * @copydoc OrganSpecificParameter::writeCheckpoint()
+ */
+void StemSpecificParameter::writeCheckpoint(std::ostream& os) const
+{
+    OrganSpecificParameter::writeCheckpoint(os);
+    for (double v : { lb, la, r, theta, rlt }) {
+        Checkpoint::write(os, v);
+    }
+    Checkpoint::write(os, ln);
+}
+
+/**
+ * @copydoc OrganSpecificParameter::readCheckpoint()
+ */
+void StemSpecificParameter::readCheckpoint(std::istream& is)
+{
+    OrganSpecificParameter::readCheckpoint(is);
+    for (double* v : { &lb, &la, &r, &theta, &rlt }) {
+        Checkpoint::read(is, *v);
+    }
+    Checkpoint::read(is, ln);
+}
+
 
 
 /**
@@ -263,6 +288,28 @@ tinyxml2::XMLElement* StemRandomParameter::writeXML(tinyxml2::XMLDocument& doc,
     return element;
 }
 
+/**
+ * @copydoc OrganRandomParameter::writeCheckpoint()
+ *
+ * We need to add the parameters that are not in the hashmaps (i.e. successor, and successorP)
+ */
+void StemRandomParameter::writeCheckpoint(std::ostream& os) const
+{
+    OrganRandomParameter::writeCheckpoint(os);
+    Checkpoint::write(os, successor);
+    Checkpoint::write(os, successorP);
+}
+
+/**
+ * @copydoc OrganRandomParameter::readCheckpoint()
+ */
+void StemRandomParameter::readCheckpoint(std::istream& is)
+{
+    OrganRandomParameter::readCheckpoint(is);
+    Checkpoint::read(is, successor);
+    Checkpoint::read(is, successorP);
+}
+
 /**
  * Sets up class introspection by linking parameter names to their class members,
  * additionally adds a description for each parameter, for toString and writeXML
@@ -35,9 +35,32 @@ Vector3d Tropism::getPosition(const Vector3d& pos, const Matrix3d& old, double a
     return pos.plus((old.times(Vector3d::rotAB(a,b))).times(dx));
 }
 
+/**
+ * Evaluates the objective function for n pairs of angles, @see Tropism::tropismObjective
+ *
+ * @param pos          root tip position
+ * @param old          rotation matrix, heading is old(:,1)
+ * @param a            n angles alpha
+ * @param b            n angles beta
+ * @param n            number of angle pairs
+ * @param dx           distance to look ahead
+ * @param o            the organ that called getHeading()
+ * @param v            n resulting values of the objective function
+ */
+void Tropism::tropismObjectives(const Vector3d& pos, const Matrix3d& old, const double* a, const double* b, size_t n, double dx,
+    const std::shared_ptr<Organ>& o, double* v)
+{
+    for (size_t i=0; i<n; i++) {
+        v[i] = this->tropismObjective(pos,old,a[i],b[i],dx,o);
+    }
+}
+
 /**
  * Dices N times picking angles alpha and beta, takes the optimal direction according to the objective function
  *
+ * All candidates are drawn first (in the order of the random numbers of a one by one evaluation),
+ * and the objective function is evaluated for all of them at once (@see Tropism::tropismObjectives).
+ *
  * @param pos          root tip position
  * @param old          rotation matrix, heading is old(:,1)
  * @param dx           distance to look ahead (e.g in case of hydrotropism)
@@ -50,7 +73,6 @@ Vector2d Tropism::getUCHeading(const Vector3d& pos, const Matrix3d& old, double
     auto p = plant.lock();
     double a = sigma*p->randn()*sqrt(dx);
     double b = p->rand()*2*M_PI;
-    double v;
 
     double n_=n*sqrt(dx);
     if (n_>0) {
@@ -60,21 +82,23 @@ Vector2d Tropism::getUCHeading(const Vector3d& pos, const Matrix3d& old, double
         } else {
             n_ = floor(n_);
         }
-        double bestA = a;
-        double bestB = b;
-        double bestV = this->tropismObjective(pos,old,a,b,dx,o);
-        for (int i=0; i<n_; i++) {
-            b = p->rand()*2*M_PI;
-            a = sigma*p->randn()*sqrt(dx);
-            v = this->tropismObjective(pos,old,a,b,dx,o);
-            if (v<bestV) {
-                bestV=v;
-                bestA=a;
-                bestB=b;
+        size_t m = size_t(n_)+1; // number of candidates
+        std::vector<double> as(m), bs(m), vs(m);
+        as[0] = a;
+        bs[0] = b;
+        for (size_t i=1; i<m; i++) {
+            bs[i] = p->rand()*2*M_PI;
+            as[i] = sigma*p->randn()*sqrt(dx);
+        }
+        this->tropismObjectives(pos,old,as.data(),bs.data(),m,dx,o,vs.data());
+        size_t best = 0;
+        for (size_t i=1; i<m; i++) {
+            if (vs[i]<vs[best]) {
+                best = i;
             }
         }
-        a = bestA;
-        b = bestB;
+        a = as[best];
+        b = bs[best];
     }
 
     return Vector2d(a,b);
@@ -99,7 +123,9 @@ Vector2d Tropism::getHeading(const Vector3d& pos, const Matrix3d& old, double dx
     double b = h.y;
 
     if (!geometry.expired()) {
-        double d = geometry.lock()->getDist(this->getPosition(pos,old,a,b,dx));
+        auto g = geometry.lock();
+        auto p = plant.lock();
+        double d = dist(g, this->getPosition(pos,old,a,b,dx));
         double dmin = d;
 
         double bestA = a;
@@ -112,8 +138,8 @@ Vector2d Tropism::getHeading(const Vector3d& pos, const Matrix3d& old, double dx
             j=0;
             while ((d>0) && j<betaN) { // change beta
 
-                b = 2*M_PI*plant.lock()->rand(); // dice
-                d = geometry.lock()->getDist(this->getPosition(pos,old,a,b,dx));
+                b = 2*M_PI*p->rand(); // dice
+                d = dist(g, this->getPosition(pos,old,a,b,dx));
                 if (d<dmin) {
                     dmin = d;
                     bestA = a;
@@ -154,6 +180,25 @@ double Exotropism::tropismObjective(const Vector3d& pos, const Matrix3d& old, do
 
 
 
+/**
+ * Batched Exotropism::tropismObjective, @see Tropism::tropismObjectives
+ */
+void Exotropism::tropismObjectives(const Vector3d& pos, const Matrix3d& old, const double* a, const double* b, size_t n, double dx,
+    const std::shared_ptr<Organ>& o, double* v)
+{
+    Vector3d iheading =o->iHeading;
+    double il = 1./iheading.length();
+    double ol = 1./old.column(0).length();
+    for (size_t i=0; i<n; i++) {
+        double s = iheading.times(old.times(Vector3d::rotAB(a[i],b[i])));
+        s*=il;
+        s*=ol;
+        v[i] = acos(s)/M_PI;
+    }
+}
+
+
+
 /**
  * getHeading() minimizes this function, @see TropismFunction::tropismObjectiveMatrix3d
  */
@@ -201,4 +246,23 @@ double CombinedTropism::tropismObjective(const Vector3d& pos, const Matrix3d& ol
     return v;
 }
 
+/**
+ * Batched CombinedTropism::tropismObjective, @see Tropism::tropismObjectives
+ */
+void CombinedTropism::tropismObjectives(const Vector3d& pos, const Matrix3d& old, const double* a, const double* b, size_t n, double dx,
+    const std::shared_ptr<Organ>& o, double* v)
+{
+    std::vector<double> vi(n);
+    tropisms[0]->tropismObjectives(pos,old,a,b,n,dx,o,v);
+    for (size_t k=0; k<n; k++) {
+        v[k] *= weights[0];
+    }
+    for (size_t i = 1; i< tropisms.size(); i++) {
+        tropisms[i]->tropismObjectives(pos,old,a,b,n,dx,o,vi.data());
+        for (size_t k=0; k<n; k++) {
+            v[k] += vi[k]*weights[i];
+        }
+    }
+}
+
 } // end namespace CPlantBox
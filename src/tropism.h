@@ -3,6 +3,7 @@
 #define TROPISM_H
 
 #include "mymath.h"
+#include "sdf.h"
 
 #include <memory>
 #include <chrono>
@@ -12,7 +13,6 @@
 namespace CPlantBox {
 
 class SoilLookUp;
-class SignedDistanceFunction;
 class Organ;
 class Organism;
 
@@ -40,7 +40,10 @@ public:
 	virtual std::shared_ptr<Tropism> copy(std::shared_ptr<Organism> plant); ///< copy object, factory method
 
 	/* parameters */
-	void setGeometry(std::shared_ptr<SignedDistanceFunction> geom) { geometry = geom; } ///< sets a confining geometry
+	void setGeometry(std::shared_ptr<SignedDistanceFunction> geom) {
+		geometry = geom;
+		bounds = geom ? SDF_Bounds(*geom) : SDF_Bounds();
+	} ///< sets a confining geometry (set again, if the geometry is changed)
 	void setTropismParameter(double n_,double sigma_) { n=n_; sigma=sigma_; } ///< sets the tropism parameters
 
 	virtual Vector2d getHeading(const Vector3d& pos, const Matrix3d& old,  double dx, const std::shared_ptr<Organ> o = nullptr);
@@ -63,17 +66,25 @@ public:
 	virtual double tropismObjective(const Vector3d& pos, const Matrix3d& old, double a, double b, double dx, const std::shared_ptr<Organ> o = nullptr)
 	    { std::cout << "TropismFunction::tropismObjective() not overwritten\n"; return 0; } ///< The objective function of the random optimization of getHeading().
 
+	virtual void tropismObjectives(const Vector3d& pos, const Matrix3d& old, const double* a, const double* b, size_t n, double dx,
+	    const std::shared_ptr<Organ>& o, double* v);
+	///< The objective function for n pairs of angles (a[i], b[i]) at once, overwrite for a faster evaluation (the default calls tropismObjective())
+
 	static Vector3d getPosition(const Vector3d& pos, const Matrix3d& old, double a, double b, double dx);
 	///< Auxiliary function: Applies angles a and b and goes dx [cm] into the new direction
 
 protected:
 
+	double dist(const std::shared_ptr<SignedDistanceFunction>& g, const Vector3d& p) const
+	    { return (bounds.classify(p)<0) ? 0. : g->getDist(p); } ///< signed distance, or 0 within the inner box of the geometry (i.e. valid)
+
 	std::weak_ptr<Organism> plant;
 
 	double n; ///< Number of trials
 	double sigma; ///< Standard deviation
 
 	std::weak_ptr<SignedDistanceFunction> geometry; ///< confining geometry todo
+	SDF_Bounds bounds; ///< boxes of the confining geometry, points within the inner box need no signed distance
 	const int alphaN = 20;
 	const int betaN = 5;
 
@@ -100,6 +111,13 @@ public:
 		return 0.5*(old.times(Vector3d::rotAB(a,b)).z+1.); // negative values point downwards, transformed to 0..1
 	} ///< TropismFunction::getHeading minimizes this function, @see TropismFunction::getHeading and @see TropismFunction::tropismObjective
 
+	void tropismObjectives(const Vector3d& pos, const Matrix3d& old, const double* a, const double* b, size_t n, double dx,
+	    const std::shared_ptr<Organ>& o, double* v) override {
+		for (size_t i=0; i<n; i++) {
+			v[i] = 0.5*(old.times(Vector3d::rotAB(a[i],b[i])).z+1.);
+		}
+	} ///< closed form objective for n pairs of angles, @see Tropism::tropismObjectives
+
 };
 
 
@@ -123,6 +141,13 @@ public:
 		return std::abs(old.times(Vector3d::rotAB(a,b)).z); // 0..1
 	} ///< getHeading() minimizes this function, @see TropismFunction
 
+	void tropismObjectives(const Vector3d& pos, const Matrix3d& old, const double* a, const double* b, size_t n, double dx,
+	    const std::shared_ptr<Organ>& o, double* v) override {
+		for (size_t i=0; i<n; i++) {
+			v[i] = std::abs(old.times(Vector3d::rotAB(a[i],b[i])).z);
+		}
+	} ///< closed form objective for n pairs of angles, @see Tropism::tropismObjectives
+
 };
 
 
@@ -144,6 +169,9 @@ public:
 
 	double tropismObjective(const Vector3d& pos, const Matrix3d& old, double a, double b, double dx, const std::shared_ptr<Organ> o = nullptr) override;
 	///< getHeading() minimizes this function, @see TropismFunction
+	void tropismObjectives(const Vector3d& pos, const Matrix3d& old, const double* a, const double* b, size_t n, double dx,
+	    const std::shared_ptr<Organ>& o, double* v) override;
+	///< closed form objective for n pairs of angles, @see Tropism::tropismObjectives
 
 };
 
@@ -203,6 +231,9 @@ public:
 
 	double tropismObjective(const Vector3d& pos, const Matrix3d& old, double a, double b, double dx, const std::shared_ptr<Organ> o = nullptr) override;
 	///< getHeading() minimizes this function, @see TropismFunction
+	void tropismObjectives(const Vector3d& pos, const Matrix3d& old, const double* a, const double* b, size_t n, double dx,
+	    const std::shared_ptr<Organ>& o, double* v) override;
+	///< linear combination of the batched objective functions, @see Tropism::tropismObjectives
 
 private:
 
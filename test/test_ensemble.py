@@ -0,0 +1,49 @@
+import unittest
+import sys
+sys.path.append("..")
+import plantbox as pb
+
+
+class TestEnsemble(unittest.TestCase):
+
+    def ensemble(self, n, threads):
+        """ n maize root systems in a row, simulated for 10 days """
+        rs = pb.RootSystem()
+        rs.readParameters("../modelparameter/rootsystem/Zea_mays_1_Leitner_2010.xml")
+        e = pb.Ensemble(rs, n, 1)
+        e.setNumberOfThreads(threads)
+        e.setSeedPositions([pb.Vector3d(10. * i, 0., -3.) for i in range(0, n)])
+        e.initialize(False)
+        e.simulate(10)
+        return e
+
+    def test_plants(self):
+        """ checks if the ensemble plants equal individually simulated plants """
+        e = self.ensemble(3, 1)
+        rs = pb.RootSystem()
+        rs.readParameters("../modelparameter/rootsystem/Zea_mays_1_Leitner_2010.xml")
+        rs.setSeed(2)  # seed of the second plant
+        rs.getRootSystemParameter().seedPos = pb.Vector3d(10., 0., -3.)
+        rs.initialize(False)
+        rs.simulate(10)
+        self.assertEqual(e.getSummed("length")[1], rs.getSummed("length"), "plants: second plant differs from a single simulation")
+        self.assertEqual(e.getNumberOfPlants(), 3, "plants: wrong number of plants")
+
+    def test_stacked(self):
+        """ checks the stacked results and their independence of the number of threads """
+        e1 = self.ensemble(4, 1)
+        e4 = self.ensemble(4, 4)
+        self.assertEqual(e1.getSummed("length"), e4.getSummed("length"), "stacked: results depend on the number of threads")
+        nodes, segs = e4.getNodes(), e4.getSegments()
+        nids, sids = e4.getNodePlantIds(), e4.getSegmentPlantIds()
+        self.assertEqual(len(nodes), len(nids), "stacked: one plant id per node expected")
+        self.assertEqual(len(segs), len(sids), "stacked: one plant id per segment expected")
+        for s, i in zip(segs, sids):
+            self.assertEqual(nids[s.x], i, "stacked: segment and node plant ids differ")
+            self.assertEqual(nids[s.y], i, "stacked: segment and node plant ids differ")
+        a = e4.getSegmentAnalyser()
+        self.assertAlmostEqual(a.getSummed("length"), sum(e4.getSummed("length")), 3, "stacked: analyser length differs")
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,76 @@
+import unittest
+import sys
+sys.path.append("..")
+import plantbox as pb
+import numpy as np
+
+
+class TestExudation(unittest.TestCase):
+
+    def model(self, typ = pb.IntegrationType.mps):
+        """ exudation model of a small root system (10 days), on a coarse grid """
+        self.rs = pb.RootSystem()  # the model needs the root system
+        rs = self.rs
+        rs.readParameters("../modelparameter/rootsystem/Anagallis_femina_Leitner_2010.xml")
+        for p in rs.getRootRandomParameter():
+            p.gf = 2  # linear growth function
+        rs.setSeed(3)
+        rs.initialize(False)
+        rs.simulate(10, False)
+        model = pb.ExudationModel(10., 10., 20., 10, 10, 16, rs)
+        model.Q = 4  # µg/d/tip
+        model.Dl = 2.43e-6 * 3600 * 24  # cm2/d
+        model.k = 2.60e-6 * 3600 * 24  # d-1
+        model.type = typ
+        model.n0 = 2
+        return model
+
+    def test_tiles(self):
+        """ checks that the result does not depend on the number of threads and the tile size """
+        for typ in [pb.IntegrationType.mps_straight, pb.IntegrationType.mps, pb.IntegrationType.mls]:
+            model = self.model(typ)
+            model.numberOfThreads = 0  # sequential
+            model.tileSize = 100
+            c1 = np.array(model.calculate(10.))
+            model.numberOfThreads = 3
+            model.tileSize = 3
+            c3 = np.array(model.calculate(10.))
+            self.assertTrue(np.array_equal(c1, c3), "tiles: result depends on threads or tiles")
+            self.assertGreater(np.max(c1), 0., "tiles: no exudates")
+            self.assertGreaterEqual(np.min(c1), 0., "tiles: negative concentration")
+
+    def test_eqn13(self):
+        """ checks the separable convolution of Eqn 13 against the direct integration """
+        for typ in [pb.IntegrationType.mps_straight, pb.IntegrationType.mps]:
+            model = self.model(typ)
+            model.calc13 = False
+            c0 = np.array(model.calculate(12.))
+            model.calc13 = True
+            model.type13 = pb.Integration13Type.direct13
+            c1 = np.array(model.calculate(12.))
+            model.type13 = pb.Integration13Type.separable13
+            c2 = np.array(model.calculate(12.))
+            self.assertGreater(np.max(c1 - c0), 0., "eqn13: no contribution of stopped roots")
+            self.assertTrue(np.allclose(c1, c2, rtol = 1.e-10, atol = 0.), "eqn13: separable convolution differs from direct integration")
+
+    def test_incremental(self):
+        """ checks a time series in incremental mode against the full evaluation """
+        for typ in [pb.IntegrationType.mps, pb.IntegrationType.mls]:
+            model = self.model(typ)
+            model.incremental = True
+            c1 = [np.array(model.calculate(t)) for t in [4., 7., 10., 12., 12.]]
+            model.incremental = False
+            c2 = [np.array(model.calculate(t)) for t in [4., 7., 10., 12., 12.]]
+            for i in range(0, len(c1)):
+                self.assertTrue(np.array_equal(c1[i], c2[i]), "incremental: results differ at step " + str(i))
+            model.Q = 8
+            c3 = np.array(model.calculate(12.))
+            model.Q = 4
+            model.incremental = True
+            model.calculate(12.)
+            model.Q = 8  # changed parameter drops the cache
+            self.assertTrue(np.array_equal(np.array(model.calculate(12.)), c3), "incremental: cache not updated")
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,161 @@
+import unittest
+import sys
+sys.path.append("..")
+import plantbox as pb
+import numpy as np
+
+
+class TestMappedOrganism(unittest.TestCase):
+
+    def grid(self):
+        """ a rectangular soil grid with 1 cm cells """
+        return pb.Vector3d(-10., -10., -30.), pb.Vector3d(10., 10., 0.), pb.Vector3d(20, 20, 30)
+
+    def rs_example(self, cut = True):
+        """ a mapped root system, with segments cut at the grid before and during the simulation """
+        rs = pb.MappedRootSystem()
+        rs.readParameters("../modelparameter/rootsystem/Anagallis_femina_Leitner_2010.xml")
+        rs.setSeed(1)
+        rs.initialize(False)
+        min_, max_, res_ = self.grid()
+        rs.setRectangularGrid(min_, max_, res_, cut)
+        return rs
+
+    def seg2cell(self, rs):
+        """ cell index per segment, -1 if the segment is not mapped """
+        s2c = rs.seg2cell
+        return np.array([s2c.get(i, -1) for i in range(0, len(rs.segments))])
+
+    def mids(self, rs):
+        """ segment mid points """
+        nodes = np.array([[n.x, n.y, n.z] for n in rs.nodes])
+        segs = np.array([[s.x, s.y] for s in rs.segments], dtype = int)
+        return (nodes[segs[:, 0]] + nodes[segs[:, 1]]) / 2
+
+    def check_cut(self, rs):
+        """ each segment is within a single cell, and is mapped to it """
+        s2c = self.seg2cell(rs)
+        nodes = np.array([[n.x, n.y, n.z] for n in rs.nodes])
+        segs = np.array([[s.x, s.y] for s in rs.segments])
+        self.assertEqual(len(nodes), len(segs) + 1, "cut: number of nodes and segments disagree")
+        self.assertTrue(np.array_equal(segs[:, 1], np.arange(1, len(nodes))), "cut: segments are not sorted")
+        for i, s in enumerate(segs):
+            x, y = nodes[s[0]], nodes[s[1]]
+            cells = [rs.soil_index(*(x + t * (y - x))) for t in [1.e-3, 0.5, 1 - 1.e-3]]
+            self.assertEqual(cells[0], cells[1], "cut: segment " + str(i) + " is not within a cell")
+            self.assertEqual(cells[2], cells[1], "cut: segment " + str(i) + " is not within a cell")
+            self.assertEqual(s2c[i], cells[1], "cut: segment " + str(i) + " is mapped to the wrong cell")
+
+    def test_cut_grid(self):
+        """ cutting points of a single segment """
+        ms = pb.MappedSegments()
+        min_, max_, res_ = self.grid()
+        ms.setRectangularGrid(min_, max_, res_, False)
+        t, cells = ms.cutGrid(pb.Vector3d(0.5, 0.5, -0.5), pb.Vector3d(2.5, 0.5, -1.5))
+        self.assertTrue(np.allclose(t, [0.25, 0.5, 0.75]), "cut grid: wrong cutting points")
+        self.assertEqual(cells, [11810, 11811, 11411, 11412], "cut grid: wrong cells")
+        t, cells = ms.cutGrid(pb.Vector3d(0.5, 0.5, -0.5), pb.Vector3d(0.7, 0.6, -0.6))
+        self.assertEqual(len(t), 0, "cut grid: segment within a cell is cut")
+        t, cells = ms.cutGrid(pb.Vector3d(0.5, 0.5, -0.5), pb.Vector3d(0.5, 0.5, 3.5))  # leaves the domain at z = 0
+        self.assertTrue(np.allclose(t, [0.125]), "cut grid: segment is cut outside of the domain")
+        self.assertEqual(cells, [11810, -1], "cut grid: wrong cells")
+        t, cells = ms.cutGrid(pb.Vector3d(10.5, 0.5, -0.5), pb.Vector3d(12.5, 3.5, -3.5))  # outside
+        self.assertEqual(len(t), 0, "cut grid: segment is cut outside of the domain")
+        self.assertEqual(cells, [-1], "cut grid: wrong cells")
+
+    def test_incremental_cut(self):
+        """ segments created during the simulation are cut, node and segment indices stay stable """
+        rs = self.rs_example()
+        for i in range(0, 10):
+            nodes0 = [[n.x, n.y, n.z] for n in rs.nodes]
+            segs0 = [[s.x, s.y] for s in rs.segments]
+            rs.simulate(1., False)
+            nodes = [[n.x, n.y, n.z] for n in rs.nodes]
+            segs = [[s.x, s.y] for s in rs.segments]
+            self.assertEqual(rs.firstNewNode, len(nodes0), "incremental cut: wrong index of the first new node")
+            changed = set(rs.changedSegments)
+            for j in range(0, len(segs0)):  # unchanged segments keep their nodes
+                if j not in changed:
+                    self.assertEqual(segs[j], segs0[j], "incremental cut: segment " + str(j) + " changed")
+                    self.assertEqual(nodes[segs[j][1]], nodes0[segs0[j][1]], "incremental cut: node " + str(segs[j][1]) + " changed")
+            self.check_cut(rs)
+        rs2 = self.rs_example(False)
+        for i in range(0, 10):
+            rs2.simulate(1., False)
+        length = lambda r: np.sum([r.nodes[s.y].minus(r.nodes[s.x]).length() for s in r.segments])
+        self.assertAlmostEqual(length(rs), length(rs2), 10, "incremental cut: total length changed")
+        om = rs.nodeMap
+        organism = rs.getNodes()
+        self.assertEqual(len(om), len(organism), "incremental cut: node map has wrong size")
+        for i in range(0, len(om)):
+            self.assertEqual(organism[i].x, rs.nodes[om[i]].x, "incremental cut: node map is wrong")
+
+    def test_soil_indices(self):
+        """ the default mapper, a call back per point, and a batch call back yield the same mapping """
+        rs = self.rs_example(False)
+        rs.simulate(10., False)
+        min_, max_, res_ = self.grid()
+        lo, hi, r = np.array([min_.x, min_.y, min_.z]), np.array([max_.x, max_.y, max_.z]), np.array([res_.x, res_.y, res_.z])
+
+        def indices(p):
+            i = (p - lo) / (hi - lo) * r
+            out = np.any((i < 0) | (i >= r), axis = 1)
+            i = np.floor(i)
+            return np.where(out, -1, i[:, 2] * r[0] * r[1] + i[:, 1] * r[0] + i[:, 0]).astype(int)
+
+        c0 = self.seg2cell(rs)
+        rs.setSoilGrid(lambda x, y, z: int(indices(np.array([[x, y, z]]))[0]))
+        c1 = self.seg2cell(rs)
+        rs.setSoilIndices(indices)
+        c2 = self.seg2cell(rs)
+        self.assertTrue(np.array_equal(c0, c1), "soil indices: call back per point differs from default mapper")
+        self.assertTrue(np.array_equal(c0, c2), "soil indices: batch call back differs from default mapper")
+        rs.simulate(1., False)  # newly created segments are mapped by the batch call back
+        mids = self.mids(rs)
+        self.assertTrue(np.array_equal(self.seg2cell(rs), indices(mids)), "soil indices: new segments")
+
+        calls = [0]
+        def counted(p):
+            calls[0] += 1
+            return indices(p)
+
+        rs = pb.MappedRootSystem()  # only the batch call back, without grid
+        rs.readParameters("../modelparameter/rootsystem/Anagallis_femina_Leitner_2010.xml")
+        rs.setSeed(1)
+        rs.setSoilIndices(counted)
+        rs.initialize(False)
+        moved = 0
+        for i in range(0, 10):
+            rs.simulate(1., False)
+            moved += len(rs.getUpdatedNodeIndices())
+            mids = self.mids(rs)
+            self.assertTrue(np.array_equal(self.seg2cell(rs), indices(mids)), "soil indices: moved segments")
+        self.assertGreater(moved, 0, "soil indices: no nodes were moved")
+        self.assertLessEqual(calls[0], 2 + 2 * 10, "soil indices: call back is not batched")  # set up and initialize, then new and moved segments per step
+
+    def test_mappers(self):
+        """ seg2cell and cell2seg are hash maps, segments out of the domain are no keys """
+        rs = self.rs_example(False)
+        rs.setRectangularGrid(pb.Vector3d(-10., -10., -30.), pb.Vector3d(10., 10., -5.), pb.Vector3d(20, 20, 25), False)
+        rs.simulate(10, False)
+        s2c, c2s = rs.seg2cell, rs.cell2seg
+        unmapped = np.nonzero(self.mids(rs)[:, 2] >= -5.)[0]  # mid above the domain
+        self.assertGreater(len(unmapped), 0, "mappers: all segments are within the domain")
+        self.assertEqual(len(s2c) + len(unmapped), len(rs.segments), "mappers: wrong number of mapped segments")
+        for i in unmapped:
+            with self.assertRaises(KeyError):
+                s2c[i]
+        self.assertEqual(sum([len(segs) for segs in c2s.values()]), len(s2c), "mappers: cell2seg disagrees with seg2cell")
+        for c, segs in c2s.items():
+            self.assertTrue(all([s2c[si] == c for si in segs]), "mappers: cell2seg disagrees with seg2cell")
+        start, segs = rs.cell2segStart, rs.cell2segs
+        for c in range(0, len(start) - 1):
+            self.assertEqual(segs[start[c]:start[c + 1]], c2s.get(c, []), "mappers: cell2segStart and cell2segs disagree with cell2seg")
+        rs.seg2cell = {0: 5, 2: 7}
+        self.assertEqual(rs.seg2cell, {0: 5, 2: 7}, "mappers: seg2cell was not set")
+        self.assertEqual(rs.cell2seg, {5: [0], 7: [2]}, "mappers: cell2seg was not updated")
+        self.assertEqual(rs.getCellSegments(7), [2], "mappers: cell segments were not updated")
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -1,5 +1,7 @@
 import unittest
 import sys
+import os
+import tempfile
 sys.path.append("..")
 import plantbox as pb
 import matplotlib.pyplot as plt
@@ -115,6 +117,31 @@ class TestOrganism(unittest.TestCase):
         segs = np.array((list(map(np.array, self.human1.getSegments()))))
         self.assertEqual(np.sum(np.sum(segs.flat != np.array([[0, 1], [1, 2], [2, 3], [2, 4], [3, 5]]).flat)), 0, "geometry: segments ids are unexcpected")
 
+    def test_organ_cache(self):
+        """ tests if the cached organ list follows changes of the organ tree """
+        self.hand_example()
+        self.add_nodes()
+        self.assertEqual(len(self.human1.getOrgans()), 3, "organ cache: unexpected number of organs")
+        ring_finger = pb.Organ(self.human1, self.hand, 0, 0, 2, pb.Vector3d(0., 0., 1.), 0., 0)
+        ring_finger.addNode(pb.Vector3d(0, 0, 1.5), self.hand.getNodeId(1), 2)
+        ring_finger.addNode(pb.Vector3d(0, 0.5, 2.5), 2)
+        self.assertEqual(len(self.human1.getOrgans()), 3, "organ cache: organ is not part of the organ tree yet")
+        self.hand.addChild(ring_finger)
+        organs = self.human1.getOrgans()
+        self.assertEqual(len(organs), 4, "organ cache: added organ is missing")
+        self.assertEqual(organs[3].getId(), ring_finger.getId(), "organ cache: unexpected order")
+
+    def test_node_store(self):
+        """ tests the node store, which is maintained during growth """
+        self.hand_example()
+        self.add_nodes()
+        store = self.human1.getNodeStore()
+        self.assertEqual(store.size(), 6, "node store: number of nodes unexpected")
+        self.assertEqual(list(store.prev), [-1, 0, 1, 2, 2, 3], "node store: segments are unexpected")
+        self.assertEqual(list(store.organId), [0, 0, 0, 0, 1, 2], "node store: organ ids are unexpected")
+        self.assertEqual(list(store.z), [n.z for n in self.human1.getNodes()], "node store: nodes are unexpected")
+        self.assertEqual(list(store.cts), [0, 0, 0, 0, 4, 3], "node store: creation times are unexpected")
+
     def test_parameter(self):
         """ test if getParameter works """
         self.hand_example()
@@ -137,6 +164,98 @@ class TestOrganism(unittest.TestCase):
         self.assertEqual(pl, pl2, "rsml: polylines are not equal")
         self.assertEqual(props["age"], [0, -4, -3] , "rsml: polylines are not equal")
 
+    def test_checkpoint(self):
+        """ a simulation restarted from a checkpoint continues exactly like the original simulation """
+        def example(organism, name):
+            o = organism()
+            o.readParameters(name)
+            o.setSeed(1)
+            o.initialize(False)
+            return o
+
+        tmp = tempfile.TemporaryDirectory()
+        self.addCleanup(tmp.cleanup)
+        chk = os.path.join(tmp.name, "organism.chk")
+
+        def state(o):
+            return ([[n.x, n.y, n.z] for n in o.getNodes()], [[s.x, s.y] for s in o.getSegments()],
+                    o.getParameter("age"), o.getParameter("subType"))
+
+        examples = [(pb.RootSystem, "../modelparameter/rootsystem/Anagallis_femina_Leitner_2010.xml"),
+                    (pb.Plant, "../modelparameter/plant/Heliantus_Pagès_2013.xml")]
+        for organism, name in examples:
+            o = example(organism, name)
+            o.simulate(10, False)
+            o.saveCheckpoint(chk)
+            o.simulate(10, False)
+            o2 = organism()
+            o2.loadCheckpoint(chk)
+            self.assertEqual(o2.getSimTime(), 10, "checkpoint: wrong simulation time")
+            o2.simulate(10, False)
+            s, s2 = state(o), state(o2)
+            self.assertEqual(s[0], s2[0], "checkpoint: nodes differ after restart")
+            self.assertEqual(s[1], s2[1], "checkpoint: segments differ after restart")
+            self.assertEqual(list(s[2]), list(s2[2]), "checkpoint: organ ages differ after restart")
+            self.assertEqual(list(s[3]), list(s2[3]), "checkpoint: organ sub types differ after restart")
+        rs = pb.MappedRootSystem()  # mapped segments are restored
+        rs.readParameters(examples[0][1])
+        rs.setSeed(1)
+        rs.initialize(False)
+        rs.setRectangularGrid(pb.Vector3d(-20., -20., -40.), pb.Vector3d(20., 20., 0.), pb.Vector3d(40, 40, 40), True)
+        rs.simulate(10, False)
+        rs.saveCheckpoint(chk)
+        rs.simulate(10, False)
+        rs2 = pb.MappedRootSystem()
+        rs2.loadCheckpoint(chk)
+        rs2.simulate(10, False)
+        self.assertEqual([[n.x, n.y, n.z] for n in rs.nodes], [[n.x, n.y, n.z] for n in rs2.nodes], "checkpoint: mapped nodes differ")
+        self.assertEqual(rs.seg2cell, rs2.seg2cell, "checkpoint: segment mapping differs")
+        with self.assertRaises(ValueError):  # checkpoint of another class
+            pb.Plant().loadCheckpoint(chk)
+
+    def test_fork(self):
+        """ forks develop like copies, and do not change the original organism """
+        def nodes(o):
+            return [[n.x, n.y, n.z] for n in o.getNodes()], [[[r.getNode(i).x, r.getNode(i).y, r.getNode(i).z] for i in range(0, r.getNumberOfNodes())] for r in o.getOrgans()]
+
+        examples = [(pb.RootSystem, "../modelparameter/rootsystem/Anagallis_femina_Leitner_2010.xml"),
+                    (pb.Plant, "../modelparameter/plant/Heliantus_Pagès_2013.xml")]
+        for organism, name in examples:
+            o = organism()
+            o.readParameters(name)
+            o.setSeed(1)
+            o.initialize(False)
+            o.simulate(10, False)
+            n0 = nodes(o)
+            c = o.copy()
+            forks = [o.fork() for i in range(0, 10)]
+            for f in forks[:5]:
+                f.simulate(5, False)
+                self.assertEqual(nodes(o), n0, "fork: original organism changed by growing fork")
+                self.assertEqual(f.getSimTime(), 15, "fork: wrong simulation time")
+            c.simulate(5, False)
+            self.assertEqual(nodes(forks[0]), nodes(c), "fork: fork differs from copy")
+            self.assertEqual(nodes(forks[9]), n0, "fork: fork changed by other forks")
+            store = forks[9].getNodeStore()
+            self.assertEqual(list(store.z), [n[2] for n in n0[0]], "fork: node store changed by other forks")
+            o.simulate(5, False)
+            self.assertEqual(nodes(o), nodes(c), "fork: original differs from copy")
+        rs = pb.RootSystem()  # the seed is forked without its children, which are only the initial organs
+        rs.readParameters(examples[0][1])
+        rs.setSeed(1)
+        rs.initialize(False)
+        rs.simulate(10, False)
+        f = rs.fork()
+        with tempfile.TemporaryDirectory() as tmp:
+            rs.saveCheckpoint(os.path.join(tmp, "rs.chk"))
+            f.saveCheckpoint(os.path.join(tmp, "fork.chk"))
+            self.assertLess(os.path.getsize(os.path.join(tmp, "fork.chk")), os.path.getsize(os.path.join(tmp, "rs.chk")), "fork: seed children are forked")
+            f2 = pb.RootSystem()
+            f2.loadCheckpoint(os.path.join(tmp, "fork.chk"))
+        f2.simulate(5, False)
+        rs.simulate(5, False)
+        self.assertEqual(nodes(f2), nodes(rs), "fork: restarted fork differs from original")
+
 
 if __name__ == '__main__':
     # todo test XML ?
@@ -3,6 +3,9 @@ import sys
 sys.path.append("..")
 import plantbox as pb
 from rsml import *
+import struct
+import base64
+import zlib
 
 
 def rootAge(l, r, k):  # root age at a certain length
@@ -150,6 +153,83 @@ class TestRootSystem(unittest.TestCase):
         rs3.simulate(10)
         self.assertEqual(rs3.rand(), n2, "copy: simulation is not deterministic")
 
+    def test_threads(self):
+        """ checks if the parallel simulation is independent of the number of threads """
+        name = "Zea_mays_1_Leitner_2010"
+        nodes, segs = [], []
+        for n in [1, 4]:
+            rs = pb.RootSystem()
+            rs.readParameters("../modelparameter/rootsystem/" + name + ".xml")
+            rs.setSeed(3)
+            rs.setNumberOfThreads(n)
+            rs.initialize(False)
+            rs.simulate(20)
+            nodes.append([[n.x, n.y, n.z] for n in rs.getNodes()])
+            segs.append([[s.x, s.y] for s in rs.getSegments()])
+        self.assertEqual(nodes[0], nodes[1], "threads: nodes differ for different number of threads")
+        self.assertEqual(segs[0], segs[1], "threads: segments differ for different number of threads")
+
+    def test_random_keys(self):
+        """ checks if counter based random numbers only depend on seed, key, index, purpose, and draw """
+        rs = pb.RootSystem()
+        rs.readParameters("../modelparameter/rootsystem/Anagallis_femina_Leitner_2010.xml")
+        rs.setSeed(1)
+        rs.setNumberOfThreads(1)
+        rs.initialize(False)
+        rs.simulate(10)
+        keys = [o.getRandomKey() for o in rs.getOrgans()]
+        self.assertEqual(len(set(keys)), len(keys), "random keys: organ keys are not unique")
+        n1 = rs.rand(keys[0], 3, pb.RandomPurposes.tropism, 0)
+        rs.simulate(1)
+        self.assertEqual(rs.rand(keys[0], 3, pb.RandomPurposes.tropism, 0), n1, "random keys: number depends on the generator state")
+        self.assertNotEqual(rs.rand(keys[0], 3, pb.RandomPurposes.tropism, 1), n1, "random keys: draws are equal")
+
+    def test_tropism_batch(self):
+        """ checks the batched objective of gravitropism against the one by one evaluation (by a Python tropism) """
+
+        class PyGravitropism(pb.Tropism):
+
+            def tropismObjective(self, pos, old, a, b, dx, o):
+                return 0.5 * (old.times(pb.Vector3d.rotAB(a, b)).z + 1.)
+
+        rs1, rs2 = pb.RootSystem(), pb.RootSystem()
+        rs1.setSeed(5)
+        rs2.setSeed(5)
+        t1 = pb.Gravitropism(rs1, 4.5, 0.3)
+        t2 = PyGravitropism(rs2, 4.5, 0.3)
+        pos, old = pb.Vector3d(), pb.Matrix3d()
+        for i in range(0, 100):
+            h1 = t1.getUCHeading(pos, old, 0.7, None)
+            h2 = t2.getUCHeading(pos, old, 0.7, None)
+            self.assertEqual([h1.x, h1.y], [h2.x, h2.y], "tropism batch: headings differ")
+
+    def test_limited_growth(self):
+        """ checks the growth limited by the cheap model against the binary search """
+        name = "Anagallis_femina_Leitner_2010"
+        incs = []
+        for limited in [False, True]:
+            rs = pb.RootSystem()
+            rs.readParameters("../modelparameter/rootsystem/" + name + ".xml")
+            se = pb.ProportionalElongation()
+            for p in rs.getRootRandomParameter():
+                p.f_se = se
+            rs.setSeed(1)
+            rs.initialize(False)
+            inc = []
+            for maxinc in [100., 100., 1., 5., 5., 100.]:
+                ol = rs.getSummed("length")
+                if limited:
+                    rs.simulateLimited(1., maxinc, se)
+                else:
+                    rs.simulate(1., maxinc, se, False)
+                inc.append(rs.getSummed("length") - ol)
+            incs.append(inc)
+        self.assertEqual(incs[0][:2], incs[1][:2], "limited growth: unlimited growth differs")
+        for i, maxinc in enumerate([1., 5., 5.]):
+            self.assertAlmostEqual(incs[0][i + 2], maxinc, delta = 1.e-3, msg = "limited growth: binary search exceeds accuracy")
+            self.assertAlmostEqual(incs[1][i + 2], maxinc, delta = 1.e-3, msg = "limited growth: increase exceeds accuracy")
+        self.assertLess(incs[1][5], 100., "limited growth: unlimited growth is limited")
+
     def test_polylines(self):
         """checks if the polylines have the right tips and bases """
         name = "Brassica_napus_a_Leitner_2010"
@@ -261,6 +341,65 @@ class TestRootSystem(unittest.TestCase):
         floats = [int(item) for item in check_str.split()]
         self.assertEqual(floats, [0, 10, 13, 16, 19, 22, 25, 28, 31, 34, 37, 40, 43, 46, 49, 52, 55, 58], "creation times are unexpected")
 
+    def read_vtp_coordinates(self, name):
+        """ reads the point coordinates of a VTP file with ascii, or appended (raw or base64, optionally zlib compressed) data """
+        with open(name, "rb") as file:
+            content = file.read()
+        head, _, appended = content.partition(b"<AppendedData")
+        i = head.index(b'Name="Coordinates"')
+        element = head[i:head.index(b">", i)].decode()
+        if 'format="ascii"' in element:
+            j = head.index(b">", i) + 1
+            return np.array([float(x) for x in head[j:head.index(b"</DataArray>", j)].split()])
+        offset = int(element.split('offset="')[1].split('"')[0])
+        encoding = appended[:appended.index(b">")].decode()
+        data = appended[appended.index(b"_") + 1:]
+        compressed = b"vtkZLibDataCompressor" in head
+        if 'encoding="raw"' in encoding:
+            data = data[offset:]
+            if compressed:
+                nb = struct.unpack("<I", data[:4])[0]
+                sizes = struct.unpack("<%dI" % (3 + nb), data[:4 * (3 + nb)])[3:]
+                data = data[4 * (3 + nb):]
+                raw = b""
+                for s in sizes:
+                    raw += zlib.decompress(data[:s])
+                    data = data[s:]
+                return np.frombuffer(raw, dtype = "<f4")
+            n = struct.unpack("<I", data[:4])[0]
+            return np.frombuffer(data[4:4 + n], dtype = "<f4")
+        data = data[offset:]  # base64, header and data are encoded separately
+        if compressed:
+            nb = struct.unpack("<I", base64.b64decode(data[:8])[:4])[0]
+            hl = 4 * ((4 * (3 + nb) + 2) // 3)
+            sizes = struct.unpack("<%dI" % (3 + nb), base64.b64decode(data[:hl]))[3:]
+            dl = 4 * ((sum(sizes) + 2) // 3)
+            raw, block = b"", base64.b64decode(data[hl:hl + dl])
+            for s in sizes:
+                raw += zlib.decompress(block[:s])
+                block = block[s:]
+            return np.frombuffer(raw, dtype = "<f4")
+        n = struct.unpack("<I", base64.b64decode(data[:8]))[0]
+        return np.frombuffer(base64.b64decode(data[8:8 + 4 * ((n + 2) // 3)]), dtype = "<f4")
+
+    def test_vtp_binary(self):
+        """ checks the binary (raw, base64, and zlib compressed) vtp output against the ascii output """
+        self.rs_example_rtp()
+        self.rs.initialize(False)
+        self.rs.simulate(60)
+        name = "test_rootsystem_binary.vtp"
+        self.rs.write(name)
+        ascii = self.read_vtp_coordinates(name)
+        self.assertEqual(ascii.shape[0], 3 * sum([len(p) for p in self.rs.getPolylines()]), "vtp binary: unexpected number of coordinates")
+        for f in [pb.VTKFormats.raw, pb.VTKFormats.base64]:
+            for compress in [False, True]:
+                self.rs.write(name, int(f), compress)
+                x = self.read_vtp_coordinates(name)
+                self.assertTrue(np.allclose(x, ascii, atol = 1.e-4), "vtp binary: coordinates differ from ascii for format {} (compressed {})".format(f, compress))
+        ana = pb.SegmentAnalyser(self.rs)
+        ana.write(name, format = int(pb.VTKFormats.base64), compress = True)
+        self.assertEqual(self.read_vtp_coordinates(name).shape[0], 3 * len(ana.nodes), "vtp binary: unexpected number of segment analyser coordinates")
+
     def test_stack(self):
         """ checks if push and pop are working """
         pass
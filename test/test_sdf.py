@@ -0,0 +1,71 @@
+import unittest
+import sys
+sys.path.append("..")
+import plantbox as pb
+import numpy as np
+
+
+class TestSDF(unittest.TestCase):
+
+    def geometries(self):
+        """ primitive geometries, and combinations of them """
+        box = pb.SDF_PlantBox(4., 6., 8.)
+        pot = pb.SDF_PlantContainer(2., 3., 10., False)
+        square = pb.SDF_PlantContainer(2., 3., 10., True)
+        plane = pb.SDF_HalfPlane(pb.Vector3d(0., 0., -2.), pb.Vector3d(1., 1., 1.))
+        rot = pb.SDF_RotateTranslate(square, 30., pb.SDF_Axis.yaxis, pb.Vector3d(1., -1., -2.))
+        u = pb.SDF_Union([box, rot])
+        i = pb.SDF_Intersection([pot, plane])
+        d = pb.SDF_Difference(box, pot)
+        c = pb.SDF_Complement(u)
+        return [box, pot, square, plane, rot, u, i, d, c]
+
+    def test_dists(self):
+        """ checks the batch evaluation against the evaluation point by point """
+        rng = np.random.default_rng(1)
+        points = [pb.Vector3d(*p) for p in rng.uniform([-6., -6., -14.], [6., 6., 2.], (200, 3))]
+        for g in self.geometries():
+            d = g.getDists(points)
+            self.assertEqual(d, [g.getDist(p) for p in points], "dists: batch differs for " + str(g))
+        self.assertEqual(self.geometries()[0].getDists([]), [], "dists: empty batch")
+
+    def test_boxes(self):
+        """ points within the inner box are inside, points outside of the bounding box are outside """
+        rng = np.random.default_rng(2)
+        points = [pb.Vector3d(*p) for p in rng.uniform([-6., -6., -14.], [6., 6., 2.], (2000, 3))]
+        points.append(pb.Vector3d(0., 0., -1.))  # within the hole of the difference
+        for g in self.geometries():
+            imin, imax = g.getInnerBox()
+            bmin, bmax = g.getBoundingBox()
+            for p in points:
+                d = g.getDist(p)
+                if imin.x <= p.x <= imax.x and imin.y <= p.y <= imax.y and imin.z <= p.z <= imax.z:
+                    self.assertLessEqual(d, 1.e-9, "boxes: point " + str(p) + " in the inner box is outside of " + str(g))
+                if not (bmin.x <= p.x <= bmax.x and bmin.y <= p.y <= bmax.y and bmin.z <= p.z <= bmax.z):
+                    self.assertGreaterEqual(d, -1.e-9, "boxes: point " + str(p) + " outside of the bounding box is inside of " + str(g))
+        d = self.geometries()[7]
+        self.assertGreater(d.getDist(pb.Vector3d(0., 0., -1.)), 0., "boxes: point in the hole is inside")
+        ana = pb.SegmentAnalyser([pb.Vector3d(0., 0., -1.), pb.Vector3d(0., 0., -2.)], [pb.Vector2i(0, 1)], [0.], [0.1])
+        ana.crop(d)
+        self.assertEqual(len(ana.segments), 0, "boxes: segment in the hole is not cropped")
+
+    def test_bounds(self):
+        """ SDF_Bounds decides points clearly inside or outside, also for unbounded boxes """
+        trench = pb.SDF_HalfPlane(pb.Vector3d(0., 0., -5.), pb.Vector3d(0., 0., 1.))  # axis aligned, inner box is unbounded
+        b = pb.SDF_Bounds(trench)
+        for v in [b.innerMin, b.innerMax, b.min, b.max]:
+            self.assertFalse(np.isnan([v.x, v.y, v.z]).any(), "bounds: box is NaN")
+        self.assertEqual(b.classify(pb.Vector3d(1., 2., -10.)), -1, "bounds: point inside the half plane is not decided")
+        self.assertEqual(b.classify(pb.Vector3d(1., 2., -10.), True), -1, "bounds: point inside the half plane is not decided")
+        self.assertEqual(b.classify(pb.Vector3d(1., 2., 0.)), 1, "bounds: point outside of the half plane is not decided")
+        for g in self.geometries():
+            b = pb.SDF_Bounds(g)
+            for v in [b.innerMin, b.innerMax, b.min, b.max]:
+                self.assertFalse(np.isnan([v.x, v.y, v.z]).any(), "bounds: box is NaN for " + str(g))
+        box = pb.SDF_PlantBox(4., 6., 8.)
+        u = pb.SDF_Union([box, trench])  # unbounded union
+        self.assertEqual(pb.SDF_Bounds(u).classify(pb.Vector3d(10., 10., -20.)), -1, "bounds: point inside the union is not decided")
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,99 @@
+import unittest
+import sys
+sys.path.append("..")
+import plantbox as pb
+import numpy as np
+
+
+class TestSegmentAnalyser(unittest.TestCase):
+
+    def analyser(self):
+        """ a small test analyser: one straight line crossing the grid cells diagonally, and one vertical line """
+        nodes = [pb.Vector3d(-4., -4., 0.), pb.Vector3d(4., 4., -8.), pb.Vector3d(1., 1., -0.5), pb.Vector3d(1., 1., -3.)]
+        segs = [pb.Vector2i(0, 1), pb.Vector2i(2, 3)]
+        return pb.SegmentAnalyser(nodes, segs, [0., 1.], [0.1, 0.2])
+
+    def test_distribution(self):
+        """ checks the exact and mid point distributions """
+        a = self.analyser()
+        l = np.sqrt(3 * 64.)  # length of the diagonal segment
+        d = a.distribution("length", 0., -8., 4, True)
+        self.assertTrue(np.allclose(d, [l / 4 + 1.5, l / 4 + 1., l / 4, l / 4]), "distribution: unexpected exact length distribution")
+        d = a.distribution("radius", 0., -8., 4, True)
+        self.assertTrue(np.allclose(d, [0.3, 0.3, 0.1, 0.1]), "distribution: unexpected exact parameter distribution (summed per intersected layer)")
+        d = a.distribution("length", 0., -8., 4, False)
+        self.assertTrue(np.allclose(d, [2.5, 0., 0., 0.]), "distribution: unexpected mid point length distribution")  # diagonal mid point is on a layer boundary
+        d = a.distribution2("length", 0., -8., -4., 4., 4, 4, True)
+        self.assertTrue(np.allclose(np.diag(d), [l / 4] * 4), "distribution2: unexpected length along the diagonal")
+        self.assertAlmostEqual(np.sum(d), l + 2.5, 10, "distribution2: summed length differs from total length")
+
+    def test_distribution3(self):
+        """ checks the 3d distribution against the 2d distribution, and against the cropped analysers """
+        a = self.analyser()
+        d3 = np.array(a.distribution3("length", 0., -8., -4., 4., -4., 4., 4, 4, 2, True))
+        d2 = np.array(a.distribution2("length", 0., -8., -4., 4., 4, 4, True))
+        self.assertEqual(d3.shape, (4, 4, 2), "distribution3: unexpected shape")
+        self.assertTrue(np.allclose(np.sum(d3, axis = 2), d2), "distribution3: summed over y differs from distribution2")
+        a3 = a.distribution3(0., -8., -4., 4., -4., 4., 4, 4, 2)
+        l3 = np.array([[[c.getSummed("length") for c in row] for row in layer] for layer in a3])
+        self.assertTrue(np.allclose(l3, d3), "distribution3: cropped analysers differ from the parameter distribution")
+
+    def test_data(self):
+        """ checks the user data columns after filtering and cropping """
+        a = self.analyser()
+        a.addData("x", [1., 2.])
+        self.assertEqual(a.getDataNames(), ["creationTime", "radius", "x"], "data: unexpected data names")
+        self.assertEqual(a.getDataId("x"), 2, "data: unexpected column id")
+        a.filter("x", 1.5, 3.)
+        self.assertEqual(list(a.getData("x")), [2.], "data: filter did not compact the user data")
+        self.assertEqual(a.data["radius"], [0.2], "data: filter did not compact the data")
+        a.crop(pb.SDF_PlantBox(10., 10., 2.))  # [-5, -5, -2] - [5, 5, 0]
+        self.assertAlmostEqual(a.getSummed("length"), 1.5, 5, "data: unexpected length after crop")
+        self.assertEqual(list(a.getData("creationTime")), [1.], "data: crop did not keep the data")
+        a.data = {"y": [3.]}
+        self.assertFalse(a.hasData("x"), "data: data were not replaced")
+        self.assertEqual(list(a.getData("y")), [3.], "data: data were not replaced")
+
+    def test_query(self):
+        """ checks the fused query against the same steps on a copy of the analyser """
+        a = self.analyser()
+        a.addData("x", [1., 2.])
+        box = pb.SDF_PlantBox(6., 6., 6.)  # [-3, -3, -6] - [3, 3, 0]
+        b = pb.SegmentAnalyser(a)
+        b.mapPeriodic(4., 4.)
+        b.crop(box)
+        b.filter("length", 0.5, 10.)
+        b.pack()
+        q = pb.SegmentQuery(a).mapPeriodic(4., 4.).crop(box).filter("length", 0.5, 10.)
+        c = q.analyser()
+        self.assertEqual(q.getNumberOfSegments(), len(b.segments), "query: unexpected number of segments")
+        self.assertEqual([str(n) for n in c.nodes], [str(n) for n in b.nodes], "query: nodes differ")
+        self.assertEqual(c.data, b.data, "query: data differ")
+        self.assertAlmostEqual(q.getSummed("length"), b.getSummed("length"), 12, "query: summed length differs")
+        self.assertEqual(q.distribution("x", 0., -6., 3, True), b.distribution("x", 0., -6., 3, True), "query: distribution differs")
+        self.assertEqual(len(a.segments), 2, "query: the analyser was changed")
+
+    def test_crop_bounds(self):
+        """ checks the boxes of composite geometries, and cropping with them against the signed distance """
+        pots = [pb.SDF_RotateTranslate(pb.SDF_PlantContainer(1., 2., 4., i % 2 == 0), pb.Vector3d(3. * i, 0., 0.)) for i in range(0, 3)]
+        u = pb.SDF_Union(pots)
+        mi, ma = u.getBoundingBox()
+        self.assertEqual([mi.x, mi.y, mi.z, ma.x, ma.y, ma.z], [-2., -2., -4., 8., 2., 0.], "bounds: unexpected bounding box of the union")
+        mi, ma = pb.SDF_RotateTranslate(pb.SDF_PlantBox(2., 4., 6.), 90., pb.SDF_Axis.xaxis, pb.Vector3d(1., 0., 0.)).getInnerBox()
+        self.assertTrue(np.allclose([mi.x, mi.y, mi.z, ma.x, ma.y, ma.z], [0., 0., -2., 2., 6., 2.]), "bounds: unexpected inner box of the rotated box")
+        mi, ma = pb.SDF_Complement(u).getInnerBox()
+        self.assertGreater(mi.x, ma.x, "bounds: inner box of the complement should be empty")
+        nodes = [pb.Vector3d(x, y, -z) for x in np.linspace(-3., 9., 13) for y in [0., 0.5, 1.9] for z in [0., 1., 3.9]]
+        segs = [pb.Vector2i(i, i + 1) for i in range(0, len(nodes) - 1)]
+        a = pb.SegmentAnalyser(nodes, segs, [0.] * len(segs), [0.1] * len(segs))
+        inside = [i for i, s in enumerate(segs) if u.getDist(nodes[s.x]) <= 0 or u.getDist(nodes[s.y]) <= 0]
+        a.crop(u)
+        self.assertEqual(len(a.segments), len(inside), "bounds: unexpected number of cropped segments")
+        for s in a.segments:
+            self.assertLessEqual(u.getDist(a.nodes[s.x]), 1.e-6, "bounds: cropped node is outside")
+            self.assertLessEqual(u.getDist(a.nodes[s.y]), 1.e-6, "bounds: cropped node is outside")
+
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,169 @@
+import unittest
+import sys
+sys.path.append("..")
+import plantbox as pb
+import numpy as np
+
+
+class TestXylemFlux(unittest.TestCase):
+
+    def single_root(self, n = 100, length = 50., a = 0.2):
+        """ a straight vertical root with n segments """
+        nodes = [pb.Vector3d(0, 0, -i * length / n) for i in range(0, n + 1)]
+        segs = [pb.Vector2i(i, i + 1) for i in range(0, n)]
+        return pb.MappedSegments(nodes, [0.] * (n + 1), segs, [a] * n, [0] * n)
+
+    def rs_example(self):
+        """ a mapped root system with age and type dependent conductivities """
+        rs = pb.MappedRootSystem()
+        rs.readParameters("../modelparameter/rootsystem/Anagallis_femina_Leitner_2010.xml")
+        rs.setSeed(1)
+        rs.initialize(False)
+        rs.setRectangularGrid(pb.Vector3d(-20., -20., -30.), pb.Vector3d(20., 20., 0.), pb.Vector3d(40, 40, 30), True)
+        rs.simulate(10, False)
+        xf = pb.XylemFlux(rs)
+        self.set_conductivities(xf)
+        return rs, xf
+
+    def set_conductivities(self, xf):
+        """ age and type dependent conductivities """
+        xf.setKrTables([[1.e-3, 4.e-4], [2.e-3, 1.e-3, 1.e-4], [1.8e-3, 1.e-4], [1.8e-3, 1.e-4], [1.8e-3]],
+                       [[0., 5.], [0., 2., 8.], [0., 3.], [0., 3.], [0.]])
+        xf.setKxTables([[0.1, 0.3], [4.e-3, 1.e-2, 2.e-2], [1.e-3, 4.e-3], [1.e-3, 4.e-3], [1.e-3]],
+                       [[0., 10.], [0., 3., 7.], [0., 5.], [0., 5.], [0.]])
+
+    def reference(self, xf, simTime, sx, cells, bcType, value):
+        """ solves the system assembled by XylemFlux::linearSystem with a dense solver """
+        xf.linearSystem(simTime, sx, cells)
+        n = len(xf.aB)
+        Q = np.zeros((n, n))
+        np.add.at(Q, (np.array(xf.aI), np.array(xf.aJ)), np.array(xf.aV))
+        b = np.array(xf.aB)
+        if bcType == pb.BCType.dirichlet:
+            Q[0, :] = 0.
+            Q[0, 0] = 1.
+            b[0] = value
+        else:
+            b[0] += value
+        return np.linalg.solve(Q, b)
+
+    def interp1(self, age, x, y):
+        """ the piecewise linear interpolation of the former conductivity callbacks (XylemFlux::interp1) """
+        if age > x[-1]:
+            return y[-1]
+        if age < x[0]:
+            return y[0]
+        i = np.searchsorted(x, age, side = "left")
+        if i == 0:
+            return y[0]
+        t = (age - x[i - 1]) / (x[i] - x[i - 1])
+        return y[i - 1] * (1. - t) + y[i] * t
+
+    def analytic(self, s, length, a, kr, kx, p_s, p0):
+        """ matric potential along a straight vertical root with constant conductivities (collar potential p0, no flux at the tip) """
+        c = np.sqrt(2 * np.pi * a * kr / kx)
+        A = p0 - p_s
+        B = (1. / c - A * np.sinh(c * length)) / np.cosh(c * length)
+        return p_s + A * np.cosh(c * s) + B * np.sinh(c * s)
+
+    def test_single_root(self):
+        """ solve is exact for a single root with constant conductivities """
+        n, length, a, kr, kx, p_s = 100, 50., 0.2, 1.8e-4, 0.1, -200.
+        xf = pb.XylemFlux(self.single_root(n, length, a))
+        xf.setKr([kr])
+        xf.setKx([kx])
+        sx = [p_s] * n
+        s = np.linspace(0., length, n + 1)
+        for p0 in [-500., -15000.]:
+            x = np.array(xf.solve(0., sx, False, pb.BCType.dirichlet, p0))
+            self.assertTrue(np.allclose(x, self.analytic(s, length, a, kr, kx, p_s, p0)), "single root: dirichlet disagrees with analytic solution")
+            self.assertTrue(np.allclose(x, self.reference(xf, 0., sx, False, pb.BCType.dirichlet, p0)), "single root: dirichlet disagrees with linear system")
+        for q in [-0.1, -2.]:
+            x = np.array(xf.solve(0., sx, False, pb.BCType.neumann, q))
+            self.assertTrue(np.allclose(x, self.reference(xf, 0., sx, False, pb.BCType.neumann, q)), "single root: neumann disagrees with linear system")
+            self.assertTrue(np.allclose(x, self.analytic(s, length, a, kr, kx, p_s, x[0])), "single root: neumann disagrees with analytic solution")
+            self.assertLess(x[0], p_s, "single root: neumann uptake needs a collar potential below the soil potential")
+
+    def test_conductivities(self):
+        """ the conductivity tables agree with the former callbacks (kr_const, kr_perType, kr_table, kr_tablePerType) """
+        n, length, simTime = 60, 30., 20.
+        ms = self.single_root(n, length)
+        ms.nodeCTs = list(np.linspace(0., 25., n + 1))  # ages from 20 to -5 days
+        ms.types = [i % 3 for i in range(0, n)]
+        ms.radii = [0.1 + 0.002 * i for i in range(0, n)]
+        xf = pb.XylemFlux(ms)
+        tables = [[1.e-3, 4.e-4], [2.e-3, 1.e-3, 1.e-4], [1.8e-3, 1.e-3, 5.e-4, 1.e-4]]
+        ages = [[0., 5.], [0., 2., 8.], [1., 4., 7., 10.]]  # irregular and equidistant
+        old = [
+            (lambda: xf.setKr([1.8e-4]), lambda: xf.setKx([0.1]), lambda a, t: 1.8e-4, lambda a, t: 0.1),
+            (lambda: xf.setKr([1.e-3, 2.e-3, 3.e-3]), lambda: xf.setKx([0.1, 0.01, 0.001]),
+             lambda a, t: [1.e-3, 2.e-3, 3.e-3][t], lambda a, t: [0.1, 0.01, 0.001][t]),
+            (lambda: xf.setKr(tables[1], ages[1]), lambda: xf.setKx(tables[2], ages[2]),
+             lambda a, t: self.interp1(a, ages[1], tables[1]), lambda a, t: self.interp1(a, ages[2], tables[2])),
+            (lambda: xf.setKrTables(tables, ages), lambda: xf.setKxTables([[10 * v for v in tab] for tab in tables[::-1]], ages[::-1]),
+             lambda a, t: self.interp1(a, ages[t], tables[t]), lambda a, t: self.interp1(a, ages[::-1][t], [10 * v for v in tables[::-1][t]])),
+            ]
+        for setKr, setKx, kr_old, kx_old in old:
+            setKr()
+            setKx()
+            for t in range(0, 3):
+                for a in np.linspace(-1., 12., 131):
+                    self.assertAlmostEqual(xf.kr_f(a, t), kr_old(a, t), 15, "conductivities: kr disagrees at age " + str(a) + " type " + str(t))
+                    self.assertAlmostEqual(xf.kx_f(a, t), kx_old(a, t), 15, "conductivities: kx disagrees at age " + str(a) + " type " + str(t))
+            xf.linearSystem(simTime, [-200.] * n, False)  # matrix entries from the batch evaluation
+            for si in range(0, n):
+                age, t, a = simTime - ms.nodeCTs[si + 1], ms.types[si], ms.radii[si]
+                kr, kx = kr_old(age, t), kx_old(age, t)
+                tau = np.sqrt(2 * a * np.pi * kr / kx)
+                l = length / n
+                cii = -kx * tau * (np.exp(-tau * l) + np.exp(tau * l)) / (np.exp(-tau * l) - np.exp(tau * l))
+                self.assertAlmostEqual(xf.aV[4 * si] / cii, 1., 12, "conductivities: matrix entry of segment " + str(si) + " disagrees")
+
+    def test_root_system(self):
+        """ solve agrees with the linear system for a branched root system and soil matric potential per cell """
+        rs, xf = self.rs_example()
+        simTime = 10.
+        sx = [-600. + 10. * (i // 1600) for i in range(0, 40 * 40 * 30)]  # drier with depth (1600 cells per layer, starting at the bottom)
+        for bcType, value in [(pb.BCType.dirichlet, -500.), (pb.BCType.dirichlet, -15000.), (pb.BCType.neumann, -0.05), (pb.BCType.neumann, 0.)]:
+            x = np.array(xf.solve(simTime, sx, True, bcType, value))
+            x_ref = self.reference(xf, simTime, sx, True, bcType, value)
+            self.assertTrue(np.allclose(x, x_ref), "root system: solve disagrees with linear system for " + str(bcType))
+        x = np.array(xf.solve(simTime, sx, True, pb.BCType.neumann, -0.05))
+        x_d = np.array(xf.solve(simTime, sx, True, pb.BCType.dirichlet, x[0]))
+        self.assertTrue(np.allclose(x, x_d), "root system: neumann and dirichlet solutions with the same collar potential disagree")
+
+    def test_incremental(self):
+        """ incremental assembly after each simulation step agrees with a full re-assembly, for segments cut and moved by the mapping """
+        rs, xf = self.rs_example()
+        xf_full = pb.XylemFlux(rs)
+        self.set_conductivities(xf_full)
+        xf.incremental = True
+        sx = [-600. + 10. * (i // 1600) for i in range(0, 40 * 40 * 30)]
+        simTime, moved, cut = 10., 0, 0
+        for i in range(0, 10):
+            nodes = np.array([[n.x, n.y, n.z] for n in rs.nodes])
+            xf.solve(simTime, sx, True, pb.BCType.dirichlet, -500.)  # fills the cache before the step
+            rs.simulate(1, False)
+            simTime += 1
+            new_nodes = np.array([[n.x, n.y, n.z] for n in rs.nodes])
+            moved += np.sum(np.any(new_nodes[0:len(nodes)] != nodes, axis = 1))
+            cut = max(cut, len(rs.nodes) - rs.getNumberOfNodes())
+            for bcType, value in [(pb.BCType.dirichlet, -500.), (pb.BCType.neumann, -0.05)]:
+                x = np.array(xf.solve(simTime, sx, True, bcType, value))
+                x_full = np.array(xf_full.solve(simTime, sx, True, bcType, value))
+                self.assertTrue(np.allclose(x, x_full, rtol = 1.e-12, atol = 0.), "incremental: solution differs from full re-assembly at step " + str(i))
+            xf.linearSystem(simTime, sx, True)
+            xf_full.linearSystem(simTime, sx, True)
+            n = len(xf_full.aB)
+            self.assertEqual(len(xf.aB), n, "incremental: system size differs from full re-assembly at step " + str(i))
+            Q, Q_full = np.zeros((n, n)), np.zeros((n, n))
+            np.add.at(Q, (np.array(xf.aI), np.array(xf.aJ)), np.array(xf.aV))
+            np.add.at(Q_full, (np.array(xf_full.aI), np.array(xf_full.aJ)), np.array(xf_full.aV))
+            self.assertTrue(np.array_equal(Q, Q_full), "incremental: matrix differs from full re-assembly at step " + str(i))
+            self.assertTrue(np.array_equal(np.array(xf.aB), np.array(xf_full.aB)), "incremental: load differs from full re-assembly at step " + str(i))
+        self.assertGreater(moved, 0, "incremental: no segments were moved")
+        self.assertGreater(cut, 0, "incremental: no segments were cut")
+
+
+if __name__ == '__main__':
+    unittest.main()
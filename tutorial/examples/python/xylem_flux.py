@@ -29,16 +29,8 @@ class XylemFluxPython(XylemFlux):
             @param sim_time [day]     needed for age dependent conductivities (age = sim_time - segment creation time)
             @param value [cm3 day-1]  tranpirational flux is negative 
          """
-        if len(soil_k) > 0:
-            self.linearSystem(sim_time, sxx, cells, soil_k)  # C++
-        else:
-            self.linearSystem(sim_time, sxx, cells)  # C++
-        Q = sparse.coo_matrix((np.array(self.aV), (np.array(self.aI), np.array(self.aJ))))
-        Q = sparse.csr_matrix(Q)
-        Q, b = self.bc_neumann(Q, self.aB, [0], [value])  # cm3 day-1
-        x = LA.spsolve(Q, b, use_umfpack = True)  # direct
-        # print ("linear system assembled and solved in", timeit.default_timer() - start, " s")
-        return x
+        x = super().solve(sim_time, sxx, cells, pb.neumann, value, soil_k)  # C++ (assembles and solves)
+        return np.array(x)
 
     def solve_dirichlet(self, sim_time :float, value :float, sxc :float, sxx, cells :bool, soil_k = []):
         """ solves the flux equations, with a dirichlet boundary condtion,
@@ -46,16 +38,8 @@ class XylemFluxPython(XylemFlux):
             @param value [cm]         root collar pressure head 
             @param sx [cm]            soil pressure head around root collar segment 
          """
-        if len(soil_k) > 0:
-            self.linearSystem(sim_time, sxx, cells, soil_k)  # C++
-        else:
-            self.linearSystem(sim_time, sxx, cells)
-        self.linearSystem(sim_time, sxx, cells)  # C++
-        Q = sparse.coo_matrix((np.array(self.aV), (np.array(self.aI), np.array(self.aJ))))
-        Q = sparse.csr_matrix(Q)
-        Q, b = self.bc_dirichlet(Q, self.aB, [0], [float(value)])
-        x = LA.spsolve(Q, b, use_umfpack = True)
-        return x
+        x = super().solve(sim_time, sxx, cells, pb.dirichlet, float(value), soil_k)  # C++ (assembles and solves)
+        return np.array(x)
 
     def solve(self, sim_time :float, trans :float, sx :float, sxx, cells :bool, wilting_point :float, soil_k = []):
         """ solves the flux equations using neumann and switching to dirichlet 
@@ -77,16 +61,7 @@ class XylemFluxPython(XylemFlux):
             x = self.solve_neumann(sim_time, trans, sxx, cells, soil_k)
 
             if x[0] <= wilting_point:
-                Q = sparse.coo_matrix((np.array(self.aV), (np.array(self.aI), np.array(self.aJ))))
-                Q = sparse.csr_matrix(Q)
-                Q, b = self.bc_dirichlet(Q, self.aB, [0], [float(wilting_point)])
-                try:
-                    x = LA.spsolve(Q, b, use_umfpack = True)
-                except:
-                    print("Exeption solving Dirichlet")
-                    print("Dirichlet at ", trans - sx, "cm")
-                    print("b", b)
-                    raise
+                x = self.solve_dirichlet(sim_time, wilting_point, sx, sxx, cells, soil_k)
         else:
             print()
             print("solve_wp used Dirichlet because collar cell soil matric potential is below wilting point", sx)